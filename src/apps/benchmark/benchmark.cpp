@@ -0,0 +1,206 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Alejandro García Montoro        (alejandro.garciamontoro@gmail.com)
+//					  Alejandra López de Aberasturi Gómez (aloaberasturi@ugr.es)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+// Iterations needed to reach a target error with each kind of starting poles.
+// The error is the RMS deviation relative to the RMS of the samples.
+// Usage: benchmark [samples file] [target error] [max iterations] [order]
+// The order applies to the samples file, resonances are fitted with 16.
+// The samples file holds one line per frequency with s and the four entries
+// of a 2x2 matrix, as real and imaginary parts.
+// A second table compares the time of the exact solver, multi-resolution
+// relocation and the sketched least squares solver for fixed iterations,
+// with many samples.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+
+#include "Driver.h"
+#include "Generator.h"
+#include "SpaceGenerator.h"
+
+using namespace VectorFitting;
+using namespace std;
+
+namespace {
+
+vector<Driver::Sample> readSamples(const string& filename) {
+    ifstream file(filename.c_str());
+    vector<Driver::Sample> samples;
+    double sReal, sImag;
+    while (file >> sReal >> sImag) {
+        MatrixXcd z(2,2);
+        for (size_t i = 0; i < 4; ++i) {
+            double auxReal, auxImag;
+            file >> auxReal >> auxImag;
+            z(i) = {auxReal, auxImag};
+        }
+        samples.push_back({Complex(sReal, sImag), z});
+    }
+    return samples;
+}
+
+// Lightly damped resonances spread over four decades.
+vector<Driver::Sample> buildResonances() {
+    const vector<Complex> poles = {
+            Complex(-3e2, 6e4), Complex(-1e3, 2e5), Complex(-2e3, 8e5),
+            Complex(-5e3, 2e6), Complex(-1e4, 7e6), Complex(-4e4, 2e7),
+            Complex(-2e5, 5e7), Complex(-1e6, 1.5e8)};
+    vector<Driver::Sample> samples;
+    vector<Real> w = logspace(make_pair(4.0, 8.5), 5000);
+    for (size_t i = 0; i < w.size(); ++i) {
+        const Complex s(0.0, w[i]);
+        MatrixXcd z = MatrixXcd::Constant(2,2, 0.1);
+        z(0,0) += 1.0;
+        z(1,1) += 2.0;
+        for (size_t k = 0; k < poles.size(); ++k) {
+            const Complex r = 1e-2 * std::abs(poles[k]);
+            const Complex h = r / (s - poles[k]) + r / (s - conj(poles[k]));
+            z(0,0) += h;
+            z(1,1) += (k % 2 == 0 ? 0.5 : 2.0) * h;
+            z(0,1) += 0.2 * h;
+            z(1,0) += 0.2 * h;
+        }
+        samples.push_back({s, z});
+    }
+    return samples;
+}
+
+Real relativeError(const Driver& driver) {
+    const vector<Driver::Sample> samples = driver.getSamples();
+    const vector<Driver::Sample> fitted = driver.getFittedSamples();
+    Real error = 0.0, norm = 0.0;
+    for (size_t i = 0; i < samples.size(); ++i) {
+        error += (samples[i].second - fitted[i].second).squaredNorm();
+        norm += samples[i].second.squaredNorm();
+    }
+    return sqrt(error / norm);
+}
+
+void run(const string& name,
+         const vector<Driver::Sample>& samples,
+         const Real target,
+         const size_t maxIterations,
+         const size_t order) {
+    const pair<string, Options::PolesType> types[] = {
+            {"lincmplx", Options::PolesType::lincmplx},
+            {"logcmplx", Options::PolesType::logcmplx},
+            {"peaks",    Options::PolesType::peaks},
+            {"loewner",  Options::PolesType::loewner}};
+
+    for (size_t t = 0; t < 4; ++t) {
+        Options opts;
+        opts.setN(order);
+        opts.setPolesType(types[t].second);
+        opts.setIterations({0,1});
+
+        const auto start = chrono::steady_clock::now();
+        vector<Complex> poles;
+        size_t iterations = 0;
+        Real error = numeric_limits<Real>::infinity();
+        try {
+            poles = Driver::buildPoles(samples, opts);
+            while (iterations < maxIterations && !(error <= target)) {
+                Driver driver(samples, opts, poles);
+                poles = driver.ss2pr().first;
+                error = relativeError(driver);
+                iterations++;
+            }
+        } catch (const exception& e) {
+            printf("%-12s %-9s failed: %s\n",
+                   name.c_str(), types[t].first.c_str(), e.what());
+            continue;
+        }
+        const double seconds = chrono::duration<double>(
+                chrono::steady_clock::now() - start).count();
+        printf("%-12s %-9s %10s %12.4e %10.3f\n",
+               name.c_str(), types[t].first.c_str(),
+               (error <= target) ? to_string(iterations).c_str() : "-",
+               error, seconds);
+    }
+}
+
+void runSolvers(const string& name,
+                const vector<Driver::Sample>& samples,
+                const size_t iterations,
+                const size_t order) {
+    const string solvers[] = {"exact", "multires", "sketched"};
+    for (size_t t = 0; t < 3; ++t) {
+        Options opts;
+        opts.setN(order);
+        opts.setPolesType(Options::PolesType::logcmplx);
+        opts.setIterations({0, iterations});
+        opts.setMultiResolution(t == 1);
+        opts.setSketching(t == 2);
+
+        const auto start = chrono::steady_clock::now();
+        try {
+            Driver driver(samples, opts);
+            const double seconds = chrono::duration<double>(
+                    chrono::steady_clock::now() - start).count();
+            printf("%-12s %-9s %10zu %12.4e %10.3f\n",
+                   name.c_str(), solvers[t].c_str(),
+                   samples.size(), relativeError(driver), seconds);
+        } catch (const exception& e) {
+            printf("%-12s %-9s failed: %s\n",
+                   name.c_str(), solvers[t].c_str(), e.what());
+        }
+    }
+}
+
+}
+
+int main(int argc, char** argv) {
+    const string filename = (argc > 1) ?
+            argv[1] : "testData/multilayer_1_original_samples.txt";
+    const Real target = (argc > 2) ? atof(argv[2]) : 1e-5;
+    const size_t maxIterations = (argc > 3) ? atoi(argv[3]) : 10;
+    const size_t order = (argc > 4) ? atoi(argv[4]) : 8;
+
+    printf("%-12s %-9s %10s %12s %10s\n",
+           "dataset", "poles", "iterations", "error", "seconds");
+
+    const vector<Driver::Sample> samples = readSamples(filename);
+    if (samples.empty()) {
+        fprintf(stderr, "Could not read samples from %s\n", filename.c_str());
+    } else {
+        run("file", samples, target, maxIterations, order);
+    }
+    run("resonances", buildResonances(), target, maxIterations, 16);
+
+    printf("\n%-12s %-9s %10s %12s %10s\n",
+           "dataset", "solver", "samples", "error", "seconds");
+    if (!samples.empty()) {
+        runSolvers("file", samples, maxIterations, order);
+    }
+    Generator generator;
+    generator.setOrder(16);
+    generator.setNumberOfPorts(2);
+    generator.setNumberOfSamples(20000);
+    generator.setNoise(1e-6);
+    generator.generate();
+    runSolvers("generated", generator.getSamples(), maxIterations, 16);
+
+    return 0;
+}
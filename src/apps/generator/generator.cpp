@@ -0,0 +1,79 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Alejandro García Montoro        (alejandro.garciamontoro@gmail.com)
+//					  Alejandra López de Aberasturi Gómez (aloaberasturi@ugr.es)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+// Writes samples of a random stable and symmetric model, see Generator.
+// Usage: generator <samples file> [samples] [order] [ports] [noise] [seed]
+//                  [linear|log] [min frequency] [max frequency]
+// The poles and residues of the model are written to the standard output.
+
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+
+#include "Generator.h"
+
+using namespace VectorFitting;
+using namespace std;
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        fprintf(stderr, "Usage: %s <samples file> [samples] [order] [ports] "
+                "[noise] [seed] [linear|log] [min frequency] "
+                "[max frequency]\n", argv[0]);
+        return 1;
+    }
+
+    Generator generator;
+    if (argc > 2) generator.setNumberOfSamples(atol(argv[2]));
+    if (argc > 3) generator.setOrder(atol(argv[3]));
+    if (argc > 4) generator.setNumberOfPorts(atol(argv[4]));
+    if (argc > 5) generator.setNoise(atof(argv[5]));
+    if (argc > 6) generator.setSeed(strtoul(argv[6], nullptr, 10));
+    if (argc > 7) {
+        generator.setSpacing(string(argv[7]) == "linear" ?
+                Generator::Spacing::linear : Generator::Spacing::logarithmic);
+    }
+    if (argc > 9) {
+        generator.setRange(make_pair(atof(argv[8]), atof(argv[9])));
+    }
+
+    try {
+        generator.generate();
+        generator.write(string(argv[1]));
+    } catch (const exception& e) {
+        fprintf(stderr, "%s\n", e.what());
+        return 1;
+    }
+
+    printf("# pole (real imag), residue elements column by column\n");
+    for (size_t m = 0; m < generator.getPoles().size(); ++m) {
+        const Complex& p = generator.getPoles()[m];
+        printf("%.17g %.17g", p.real(), p.imag());
+        const MatrixXcd& r = generator.getResidues()[m];
+        for (MatrixXcd::Index i = 0; i < r.size(); ++i) {
+            printf(" %.17g %.17g", r(i).real(), r(i).imag());
+        }
+        printf("\n");
+    }
+    return 0;
+}
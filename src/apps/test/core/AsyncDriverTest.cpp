@@ -0,0 +1,102 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Alejandro García Montoro        (alejandro.garciamontoro@gmail.com)
+//					  Alejandra López de Aberasturi Gómez (aloaberasturi@ugr.es)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+#include "gtest/gtest.h"
+
+#include "AsyncDriver.h"
+#include "GeneratedSamples.h"
+
+using namespace VectorFitting;
+using namespace std;
+
+class AsyncDriverTest : public ::testing::Test {
+protected:
+    static Options buildOptions() {
+        Options opts;
+        opts.setN(4);
+        opts.setIterations({3,3});
+        return opts;
+    }
+};
+
+TEST_F(AsyncDriverTest, sameResultAsDriver) {
+    vector<Driver::Sample> samples = buildSamples(4, 2, 200);
+    Options opts = buildOptions();
+
+    vector<Control::Progress> progress;
+    shared_ptr<Control> control = make_shared<Control>();
+    control->setProgressCallback([&progress](const Control::Progress& p) {
+        progress.push_back(p);
+    });
+
+    AsyncDriver async(samples, opts, control);
+    Driver driver = async.get();
+    EXPECT_TRUE(async.isReady());
+
+    Driver reference(samples, opts);
+    EXPECT_EQ(reference.getA(), driver.getA());
+    EXPECT_EQ(reference.getC(), driver.getC());
+    EXPECT_EQ(reference.getD(), driver.getD());
+
+    ASSERT_EQ(7, progress.size());
+    EXPECT_EQ(Control::Stage::relocationOfSum, progress[0].stage);
+    EXPECT_EQ(1, progress[0].iteration);
+    EXPECT_EQ(3, progress[0].iterations);
+    EXPECT_EQ(Control::Stage::relocation, progress[5].stage);
+    EXPECT_EQ(3, progress[5].iteration);
+    EXPECT_EQ(Control::Stage::finished, progress[6].stage);
+}
+
+TEST_F(AsyncDriverTest, cancel) {
+    shared_ptr<Control> control = make_shared<Control>();
+    Control* ctrl = control.get();
+    control->setProgressCallback([ctrl](const Control::Progress&) {
+        ctrl->cancel();
+    });
+
+    AsyncDriver async(buildSamples(4, 2, 200), buildOptions(), control);
+    EXPECT_THROW(async.get(), Control::Interrupted);
+}
+
+TEST_F(AsyncDriverTest, deadline) {
+    vector<Driver::Sample> samples = buildSamples(4, 2, 200);
+
+    shared_ptr<Control> control = make_shared<Control>();
+    control->setDeadline(Control::Clock::now());
+
+    AsyncDriver async(samples, buildOptions(), control);
+    EXPECT_TRUE(async.waitFor(std::chrono::seconds(60)));
+    Driver driver = async.get();
+
+    // Residues are identified with the initial poles.
+    Options opts = buildOptions();
+    std::vector<Complex> initial = Driver::buildPoles(
+            make_pair(samples.front().first.imag(),
+                      samples.back().first.imag()), opts);
+    std::vector<Complex> poles = driver.ss2pr().first;
+    ASSERT_EQ(initial.size(), poles.size());
+    for (size_t i = 0; i < poles.size(); ++i) {
+        EXPECT_EQ(initial[i], poles[i]);
+    }
+    EXPECT_NE(0.0, driver.getC().norm());
+    EXPECT_TRUE(std::isfinite(driver.getRMSE()));
+}
@@ -0,0 +1,57 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Alejandro García Montoro        (alejandro.garciamontoro@gmail.com)
+//					  Alejandra López de Aberasturi Gómez (aloaberasturi@ugr.es)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+/*
+ * Calls the C interface from C, so that CInterface.h is compiled as C.
+ */
+
+#include "CInterface.h"
+
+#include <stdlib.h>
+
+int fitFromC(size_t Ns, size_t Nr,
+             const double* frequencies,
+             const double* responses,
+             double* rmse) {
+    vf_options options;
+    double* poles;
+    double* residues;
+    int res;
+
+    options.size = sizeof(vf_options);
+    res = vf_default_options(&options);
+    if (res != VF_OK) {
+        return res;
+    }
+    options.order = 6;
+    options.polesType = VF_POLES_LOGCMPLX;
+    options.asymptoticTrend = VF_TREND_LINEAR;
+
+    poles = (double*) malloc(2 * options.order * sizeof(double));
+    residues = (double*) malloc(2 * Nr * options.order * sizeof(double));
+    res = vf_fit(&options, Ns, Nr, frequencies, 1,
+                 responses, 1, (ptrdiff_t) Ns, NULL, 0, 0,
+                 poles, residues, NULL, NULL, rmse);
+    free(residues);
+    free(poles);
+    return res;
+}
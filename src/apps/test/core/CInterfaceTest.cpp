@@ -0,0 +1,248 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Alejandro García Montoro        (alejandro.garciamontoro@gmail.com)
+//					  Alejandra López de Aberasturi Gómez (aloaberasturi@ugr.es)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+#include "gtest/gtest.h"
+
+#include "CInterface.h"
+#include "GeneratedSamples.h"
+
+using namespace VectorFitting;
+using namespace std;
+
+// Defined in CInterfaceCTest.c, which includes CInterface.h as C.
+extern "C" int fitFromC(size_t Ns, size_t Nr,
+                        const double* frequencies,
+                        const double* responses,
+                        double* rmse);
+
+class CInterfaceTest : public ::testing::Test {
+protected:
+    void SetUp() {
+        generator_ = buildGenerator(6, 2, 200, 0, make_pair(1e3, 1e6));
+
+        // Column-major Ns x Nr arrays, as kept by a Fortran caller.
+        const vector<Driver::Sample> samples = generator_.getSamples();
+        Ns_ = samples.size();
+        Nr_ = 3;
+        w_.resize(Ns_);
+        f_.resize(2 * Ns_ * Nr_);
+        for (size_t i = 0; i < Ns_; ++i) {
+            w_[i] = samples[i].first.imag();
+            const VectorXcd packed = Driver::pack(samples[i].second);
+            for (size_t n = 0; n < Nr_; ++n) {
+                f_[2*(i + n*Ns_)    ] = packed(n).real();
+                f_[2*(i + n*Ns_) + 1] = packed(n).imag();
+            }
+        }
+    }
+
+    Generator generator_;
+    size_t Ns_, Nr_;
+    vector<double> w_, f_;
+};
+
+TEST_F(CInterfaceTest, fit) {
+    vf_options options;
+    options.size = sizeof(vf_options);
+    ASSERT_EQ(VF_OK, vf_default_options(&options));
+    options.order = 6;
+    options.polesType = VF_POLES_LOGCMPLX;
+    options.asymptoticTrend = VF_TREND_LINEAR;
+
+    vector<double> poles(2*6), residues(2*Nr_*6), D(2*Nr_), E(2*Nr_);
+    double rmse;
+    ASSERT_EQ(VF_OK, vf_fit(&options, Ns_, Nr_, w_.data(), 1,
+                            f_.data(), 1, Ns_, nullptr, 0, 0,
+                            poles.data(), residues.data(),
+                            D.data(), E.data(), &rmse));
+    EXPECT_STREQ("", vf_last_error());
+    EXPECT_LT(rmse, 1e-8);
+
+    for (const Complex& p : generator_.getPoles()) {
+        Real closest = numeric_limits<Real>::infinity();
+        for (size_t k = 0; k < 6; ++k) {
+            closest = min(closest, abs(p - Complex(poles[2*k], poles[2*k+1])));
+        }
+        EXPECT_LT(closest, 1e-6 * abs(p));
+    }
+
+    // Fewer samples in the early relocations.
+    options.multiResolution = 1;
+    vector<double> coarsePoles(poles.size()), coarseResidues(residues.size());
+    double coarseRmse;
+    ASSERT_EQ(VF_OK, vf_fit(&options, Ns_, Nr_, w_.data(), 1,
+                            f_.data(), 1, Ns_, nullptr, 0, 0,
+                            coarsePoles.data(), coarseResidues.data(),
+                            nullptr, nullptr, &coarseRmse));
+    EXPECT_LT(coarseRmse, 1e-8);
+    options.multiResolution = 0;
+
+    // Same data, stored row-major and weighted with ones.
+    vector<double> transposed(f_.size()), weights(Ns_ * Nr_, 1.0);
+    for (size_t i = 0; i < Ns_; ++i) {
+        for (size_t n = 0; n < Nr_; ++n) {
+            transposed[2*(n + i*Nr_)    ] = f_[2*(i + n*Ns_)    ];
+            transposed[2*(n + i*Nr_) + 1] = f_[2*(i + n*Ns_) + 1];
+        }
+    }
+    vector<double> otherPoles(poles.size()), otherResidues(residues.size());
+    ASSERT_EQ(VF_OK, vf_fit(&options, Ns_, Nr_, w_.data(), 1,
+                            transposed.data(), Nr_, 1,
+                            weights.data(), Nr_, 1,
+                            otherPoles.data(), otherResidues.data(),
+                            nullptr, nullptr, nullptr));
+    for (size_t k = 0; k < poles.size(); ++k) {
+        EXPECT_NEAR(poles[k], otherPoles[k], 1e-8 * abs(poles[k]));
+    }
+    for (size_t k = 0; k < residues.size(); ++k) {
+        EXPECT_NEAR(residues[k], otherResidues[k], 1e-8 * abs(residues[k]));
+    }
+}
+
+TEST_F(CInterfaceTest, weighting) {
+    vf_options options;
+    options.size = sizeof(vf_options);
+    ASSERT_EQ(VF_OK, vf_default_options(&options));
+    options.order = 6;
+    options.polesType = VF_POLES_LOGCMPLX;
+    options.weighting = VF_WEIGHTING_ONE_OVER_ABS;
+
+    vector<double> poles(2*6), residues(2*Nr_*6);
+    ASSERT_EQ(VF_OK, vf_fit(&options, Ns_, Nr_, w_.data(), 1,
+                            f_.data(), 1, Ns_, nullptr, 0, 0,
+                            poles.data(), residues.data(),
+                            nullptr, nullptr, nullptr));
+
+    // Same weights given by the caller.
+    vector<double> weights(Ns_ * Nr_);
+    for (size_t k = 0; k < weights.size(); ++k) {
+        weights[k] = 1.0 / abs(Complex(f_[2*k], f_[2*k+1]));
+    }
+    vector<double> otherPoles(poles.size()), otherResidues(residues.size());
+    ASSERT_EQ(VF_OK, vf_fit(&options, Ns_, Nr_, w_.data(), 1,
+                            f_.data(), 1, Ns_, weights.data(), 1, Ns_,
+                            otherPoles.data(), otherResidues.data(),
+                            nullptr, nullptr, nullptr));
+    for (size_t k = 0; k < residues.size(); ++k) {
+        EXPECT_NEAR(residues[k], otherResidues[k], 1e-6 * abs(residues[k]));
+    }
+}
+
+TEST_F(CInterfaceTest, negativeStrides) {
+    vf_options options;
+    options.size = sizeof(vf_options);
+    ASSERT_EQ(VF_OK, vf_default_options(&options));
+    options.order = 6;
+    options.polesType = VF_POLES_LOGCMPLX;
+
+    // Same data stored backwards, read from its last element.
+    const ptrdiff_t Ns = Ns_;
+    const vector<double> wBack(w_.rbegin(), w_.rend());
+    vector<double> fBack(f_.size()), weightsBack(Ns_ * Nr_);
+    for (size_t k = 0; k < Ns_ * Nr_; ++k) {
+        const size_t back = Ns_ * Nr_ - 1 - k;
+        fBack[2*back    ] = f_[2*k    ];
+        fBack[2*back + 1] = f_[2*k + 1];
+        weightsBack[back] = 1.0 / abs(Complex(f_[2*k], f_[2*k+1]));
+    }
+
+    vector<double> poles(2*6), residues(2*Nr_*6);
+    vector<double> otherPoles(poles.size()), otherResidues(residues.size());
+    for (const int weighting : {VF_WEIGHTING_ONE_OVER_NORM,
+                                VF_WEIGHTING_ONE_OVER_ABS}) {
+        options.weighting = weighting;
+        ASSERT_EQ(VF_OK, vf_fit(&options, Ns_, Nr_, w_.data(), 1,
+                                f_.data(), 1, Ns_, nullptr, 0, 0,
+                                poles.data(), residues.data(),
+                                nullptr, nullptr, nullptr));
+        ASSERT_EQ(VF_OK, vf_fit(&options, Ns_, Nr_, &wBack.back(), -1,
+                                &fBack[fBack.size() - 2], -1, -Ns,
+                                nullptr, 0, 0,
+                                otherPoles.data(), otherResidues.data(),
+                                nullptr, nullptr, nullptr));
+        for (size_t k = 0; k < residues.size(); ++k) {
+            EXPECT_NEAR(residues[k], otherResidues[k],
+                        1e-8 * abs(residues[k]));
+        }
+    }
+
+    // Weights given by the caller, also stored backwards.
+    ASSERT_EQ(VF_OK, vf_fit(&options, Ns_, Nr_, &wBack.back(), -1,
+                            &fBack[fBack.size() - 2], -1, -Ns,
+                            &weightsBack.back(), -1, -Ns,
+                            otherPoles.data(), otherResidues.data(),
+                            nullptr, nullptr, nullptr));
+    for (size_t k = 0; k < residues.size(); ++k) {
+        EXPECT_NEAR(residues[k], otherResidues[k], 1e-6 * abs(residues[k]));
+    }
+}
+
+TEST_F(CInterfaceTest, errors) {
+    vf_options options;
+    options.size = sizeof(vf_options);
+    ASSERT_EQ(VF_OK, vf_default_options(&options));
+    vector<double> poles(2*options.order), residues(2*Nr_*options.order);
+
+    options.polesType = 7;
+    EXPECT_EQ(VF_INVALID_INPUT, vf_fit(&options, Ns_, Nr_, w_.data(), 1,
+                                       f_.data(), 1, Ns_, nullptr, 0, 0,
+                                       poles.data(), residues.data(),
+                                       nullptr, nullptr, nullptr));
+    EXPECT_STRNE("", vf_last_error());
+
+    // Decreasing frequencies.
+    vf_default_options(&options);
+    EXPECT_EQ(VF_INVALID_INPUT, vf_fit(&options, Ns_, Nr_,
+                                       &w_.back(), -1,
+                                       f_.data(), 1, Ns_, nullptr, 0, 0,
+                                       poles.data(), residues.data(),
+                                       nullptr, nullptr, nullptr));
+
+    EXPECT_EQ(VF_INVALID_INPUT, vf_fit(&options, Ns_, Nr_, w_.data(), 1,
+                                       nullptr, 1, Ns_, nullptr, 0, 0,
+                                       poles.data(), residues.data(),
+                                       nullptr, nullptr, nullptr));
+}
+
+TEST_F(CInterfaceTest, optionsSize) {
+    vf_options options;
+    options.size = sizeof(vf_options);
+    ASSERT_EQ(VF_OK, vf_default_options(&options));
+    EXPECT_EQ(sizeof(vf_options), options.size);
+
+    // Options of a later version, or not sized at all.
+    vector<double> poles(2*options.order), residues(2*Nr_*options.order);
+    for (const size_t size : {sizeof(vf_options) + 8, (size_t) 0}) {
+        options.size = size;
+        EXPECT_EQ(VF_INVALID_INPUT, vf_default_options(&options));
+        EXPECT_EQ(VF_INVALID_INPUT, vf_fit(&options, Ns_, Nr_, w_.data(), 1,
+                                           f_.data(), 1, Ns_, nullptr, 0, 0,
+                                           poles.data(), residues.data(),
+                                           nullptr, nullptr, nullptr));
+    }
+}
+
+TEST_F(CInterfaceTest, fitFromC) {
+    double rmse;
+    ASSERT_EQ(VF_OK, fitFromC(Ns_, Nr_, w_.data(), f_.data(), &rmse));
+    EXPECT_LT(rmse, 1e-8);
+}
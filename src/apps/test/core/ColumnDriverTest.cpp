@@ -0,0 +1,204 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Alejandro García Montoro        (alejandro.garciamontoro@gmail.com)
+//					  Alejandra López de Aberasturi Gómez (aloaberasturi@ugr.es)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+#include <algorithm>
+#include <mutex>
+
+#include "gtest/gtest.h"
+
+#include "ColumnDriver.h"
+#include "GeneratedSamples.h"
+
+using namespace VectorFitting;
+using namespace std;
+
+class ColumnDriverTest : public ::testing::Test {
+protected:
+    // Column j is taken from a model of order 2 of its own, resonating
+    // within a decade of 10^(2+j).
+    void SetUp() {
+        for (size_t j = 0; j < 3; ++j) {
+            generators_.push_back(buildGenerator(2, 3, 200, j,
+                    make_pair(pow(10.0, 1.5 + (Real) j),
+                              pow(10.0, 2.5 + (Real) j))));
+        }
+    }
+
+    vector<Driver::Sample> buildSamples(const size_t Nc) const {
+        vector<Driver::Sample> samples;
+        for (const Real w : logspace(make_pair(1.0, 6.0), 200)) {
+            const Complex s(0.0, w);
+            MatrixXcd Y(Nc, Nc);
+            for (size_t j = 0; j < Nc; ++j) {
+                Y.col(j) = generators_[j].evaluate(s).col(j).head(Nc);
+            }
+            samples.push_back(Driver::Sample(s, Y));
+        }
+        return samples;
+    }
+
+    vector<Generator> generators_;
+};
+
+TEST_F(ColumnDriverTest, independentPoles) {
+    const size_t Nc = 3;
+    Options opts;
+    opts.setN(2);
+    opts.setPolesType(Options::PolesType::logcmplx);
+    opts.setIterations({3, 3});
+
+    ColumnDriver driver(buildSamples(Nc), opts, {}, 2);
+    EXPECT_EQ(Nc, driver.getNumberOfPorts());
+    EXPECT_EQ(2, driver.getNumberOfThreads());
+
+    for (size_t j = 0; j < Nc; ++j) {
+        ASSERT_EQ(2, driver.getPoles(j).size());
+        for (const Complex& p : driver.getPoles(j)) {
+            Real closest = numeric_limits<Real>::infinity();
+            for (const Complex& q : generators_[j].getPoles()) {
+                closest = min(closest, abs(p - q));
+            }
+            EXPECT_LT(closest, 1e-6 * abs(p));
+        }
+        EXPECT_EQ(Nc, driver.getResidues(j).rows());
+        EXPECT_NEAR(0.0, abs(generators_[j].getD()(0,j) - driver.getD()(0,j)),
+                    1e-6);
+    }
+    EXPECT_LT(driver.getMaxDeviation(), 1e-6);
+}
+
+TEST_F(ColumnDriverTest, ordersPerColumn) {
+    Options opts;
+    opts.setN(2);
+    opts.setIterations({2, 2});
+
+    ColumnDriver driver(buildSamples(2), opts, {2, 4});
+    EXPECT_EQ(2, driver.getPoles(0).size());
+    EXPECT_EQ(4, driver.getPoles(1).size());
+    EXPECT_EQ(4, driver.getResidues(1).cols());
+    EXPECT_EQ(make_pair((size_t) 2, (size_t) 2),
+              driver.getPerformedIterations(1));
+
+    EXPECT_THROW(ColumnDriver(buildSamples(2), opts, {2}), runtime_error);
+}
+
+TEST_F(ColumnDriverTest, stateSpace) {
+    Options opts;
+    opts.setN(2);
+    opts.setIterations({2, 2});
+
+    ColumnDriver driver(buildSamples(2), opts, {2, 4});
+    const MatrixXcd A = driver.getA();
+    const MatrixXcd B = driver.getB().cast<Complex>();
+    const MatrixXcd C = driver.getC();
+    ASSERT_EQ(6, A.rows());
+    ASSERT_EQ(6, A.cols());
+    ASSERT_EQ(6, B.rows());
+    ASSERT_EQ(2, B.cols());
+    ASSERT_EQ(2, C.rows());
+    EXPECT_EQ(driver.getPoles(1)[3], A(5,5));
+    EXPECT_EQ(Complex(1.0, 0.0), B(2,1));
+    EXPECT_EQ(Complex(0.0, 0.0), B(2,0));
+    EXPECT_EQ(driver.getResidues(1).col(0), C.col(2));
+
+    const MatrixXcd I = MatrixXcd::Identity(A.rows(), A.cols());
+    for (const Complex s : {Complex(0.0, 1e2), Complex(0.0, 3e4)}) {
+        const MatrixXcd H = C * (s*I - A).inverse() * B
+                          + driver.getD() + s * driver.getE();
+        EXPECT_NEAR(0.0, (H - driver.evaluate(s)).norm(),
+                    1e-12 * driver.evaluate(s).norm());
+    }
+}
+
+TEST_F(ColumnDriverTest, convergence) {
+    Options opts;
+    opts.setN(2);
+    opts.setPolesType(Options::PolesType::logcmplx);
+    opts.setIterations({10, 10});
+    opts.setPoleTolerance(1e-8);
+
+    ColumnDriver driver(buildSamples(2), opts);
+    for (size_t j = 0; j < 2; ++j) {
+        const pair<size_t, size_t> performed =
+                driver.getPerformedIterations(j);
+        EXPECT_LT(performed.first, 10);
+        EXPECT_GE(performed.second, 1);
+        EXPECT_LT(performed.second, 10);
+    }
+    EXPECT_LT(driver.getMaxDeviation(), 1e-6);
+}
+
+TEST_F(ColumnDriverTest, progress) {
+    const size_t Nc = 3;
+    Options opts;
+    opts.setN(2);
+    opts.setIterations({2, 2});
+
+    mutex lock;
+    vector<Control::Progress> progress;
+    Control control;
+    control.setProgressCallback([&](const Control::Progress& p) {
+        lock_guard<mutex> guard(lock);
+        progress.push_back(p);
+    });
+    ColumnDriver driver(buildSamples(Nc), opts, {}, Nc, &control);
+
+    // Each column is reported once, then the end of the fit.
+    ASSERT_EQ(Nc + 1, progress.size());
+    vector<size_t> fitted;
+    for (size_t i = 0; i < Nc; ++i) {
+        EXPECT_EQ(Control::Stage::relocation, progress[i].stage);
+        EXPECT_EQ(Nc, progress[i].iterations);
+        fitted.push_back(progress[i].iteration);
+    }
+    sort(fitted.begin(), fitted.end());
+    EXPECT_EQ(vector<size_t>({1, 2, 3}), fitted);
+    EXPECT_EQ(Control::Stage::finished, progress.back().stage);
+}
+
+TEST_F(ColumnDriverTest, deadline) {
+    const vector<Driver::Sample> samples = buildSamples(2);
+    Options opts;
+    opts.setN(2);
+    opts.setIterations({3, 3});
+
+    Control control;
+    control.setDeadline(Control::Clock::now());
+    ColumnDriver driver(samples, opts, {}, 0, &control);
+
+    // Residues are identified with the initial poles.
+    const vector<Complex> initial = Driver::buildPoles(
+            make_pair(samples.front().first.imag(),
+                      samples.back().first.imag()), opts);
+    for (size_t j = 0; j < 2; ++j) {
+        EXPECT_EQ(initial, driver.getPoles(j));
+        EXPECT_EQ(make_pair((size_t) 0, (size_t) 0),
+                  driver.getPerformedIterations(j));
+        EXPECT_NE(0.0, driver.getResidues(j).norm());
+    }
+    EXPECT_TRUE(isfinite(driver.getRMSE()));
+
+    Control cancelled;
+    cancelled.cancel();
+    EXPECT_THROW(ColumnDriver(samples, opts, {}, 0, &cancelled),
+                 Control::Interrupted);
+}
@@ -21,10 +21,15 @@
 // along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
 
 #include <fstream>
+#include <map>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
 
 #include "gtest/gtest.h"
 
 #include "Driver.h"
+#include "GeneratedSamples.h"
 #include "SpaceGenerator.h"
 
 
@@ -67,6 +72,66 @@ TEST_F(DriverTest, initial_poles_lincmplx) {
     EXPECT_FLOAT_EQ(+6.283185307179586e3, poles[3].imag());
 }
 
+TEST_F(DriverTest, initial_poles_logcmplx) {
+    std::pair<Real,Real> range(2*M_PI*1.0, 2*M_PI*1000.0);
+    Options opts;
+    opts.setN(7);
+    opts.setPolesType(Options::PolesType::logcmplx);
+
+    std::vector<Complex> poles = Driver::buildPoles(range, opts);
+    ASSERT_EQ(7, poles.size());
+
+    // Pairs at 1, 10, 100 and 1000 Hz. Extra real pole at the geometric mean.
+    for (size_t i = 0; i < 3; ++i) {
+        const Real w = 2*M_PI*pow(10.0, 1.5*i);
+        EXPECT_FLOAT_EQ(-w, poles[2*i].imag());
+        EXPECT_FLOAT_EQ(+w, poles[2*i+1].imag());
+        EXPECT_FLOAT_EQ(-w*opts.getNu(), poles[2*i].real());
+        EXPECT_EQ(conj(poles[2*i]), poles[2*i+1]);
+    }
+    EXPECT_FLOAT_EQ(-2*M_PI*sqrt(1000.0), poles[6].real());
+    EXPECT_EQ(0.0, poles[6].imag());
+
+    EXPECT_THROW(Driver::buildPoles(make_pair(0.0, 1.0), opts),
+                 std::runtime_error);
+}
+
+TEST_F(DriverTest, initial_poles_peaks) {
+    // Resonances at 1e2 and 1e4 rad/s, with different dampings.
+    std::vector<Driver::Sample> samples;
+    std::vector<Real> w = logspace(std::make_pair(1.0, 5.0), 2000);
+    for (size_t i = 0; i < w.size(); ++i) {
+        const Complex s(0.0, w[i]);
+        const Complex p1(-2.0, 1e2), p2(-5e2, 1e4);
+        MatrixXcd data(1,1);
+        data(0,0) = 1.0 + 1e1/(s-p1) + 1e1/(s-conj(p1))
+                        + 1e3/(s-p2) + 1e3/(s-conj(p2));
+        samples.push_back({s, data});
+    }
+    Options opts;
+    opts.setN(6);
+    opts.setPolesType(Options::PolesType::peaks);
+
+    std::vector<Complex> poles = Driver::buildPoles(samples, opts);
+    ASSERT_EQ(6, poles.size());
+
+    // Sharpest peak first.
+    EXPECT_NEAR(-1e2, poles[0].imag(), 1.0);
+    EXPECT_NEAR(-2.0, poles[0].real(), 1.0);
+    EXPECT_EQ(conj(poles[0]), poles[1]);
+    EXPECT_NEAR(-1e4, poles[2].imag(), 1e2);
+    EXPECT_NEAR(-5e2, poles[2].real(), 1e2);
+    EXPECT_EQ(conj(poles[2]), poles[3]);
+
+    // The remaining pair is placed as with logcmplx, a single pair goes to
+    // the highest frequency.
+    EXPECT_FLOAT_EQ(-1e5, poles[4].imag());
+
+    opts.setIterations({2,2});
+    Driver driver(samples, opts);
+    EXPECT_LT(driver.getRMSE(), 1e-8);
+}
+
 TEST_F(DriverTest, constant){
     size_t Ns = 20;
     size_t N = 4;
@@ -357,6 +422,65 @@ TEST_F(DriverTest, multilayer1) {
 
 }
 
+TEST_F(DriverTest, decimate) {
+    std::vector<Fitting::Sample> f;
+    std::vector<Real> freq = linspace(std::make_pair(0.0, 1e4), 1000);
+    for (size_t i = 0; i < freq.size(); ++i) {
+        Complex s(0.0, freq[i]);
+        VectorXcd response(1);
+        response(0) = 1.0 / (s - Complex(-10.0, -5e3))
+                    + 1.0 / (s - Complex(-10.0, +5e3));
+        f.push_back({s, response});
+    }
+
+    std::vector<size_t> indices = Driver::decimate(f, 100);
+    EXPECT_GE(100, indices.size());
+    EXPECT_LE(50, indices.size());
+    EXPECT_EQ(0, indices.front());
+    EXPECT_EQ(f.size()-1, indices.back());
+    EXPECT_TRUE(std::is_sorted(indices.begin(), indices.end()));
+
+    // The resonance at 5e3 rad/s must be kept.
+    EXPECT_NE(indices.end(),
+              std::find(indices.begin(), indices.end(), (size_t) 500));
+
+    EXPECT_EQ(f.size(), Driver::decimate(f, f.size()).size());
+}
+
+TEST_F(DriverTest, multiResolution) {
+    ifstream file("testData/multilayer_1_original_samples.txt");
+    EXPECT_TRUE(file.is_open());
+
+    std::vector<Driver::Sample> samples;
+    while (!file.eof()) {
+        double sReal, sImag;
+        file >> sReal >> sImag;
+        MatrixXcd z(2,2);
+        for (size_t i = 0; i < 4; ++i) {
+            double auxReal, auxImag;
+            file >> auxReal >> auxImag;
+            z(i) = {auxReal, auxImag};
+        }
+        samples.push_back({Complex(sReal, sImag), z});
+    }
+
+    Options opts;
+    opts.setIterations({4,10});
+    opts.setN(2);
+    Driver full(samples, opts);
+
+    opts.setMultiResolution(true);
+    Driver driver(samples, opts);
+
+    // Only the final pass uses all the samples, the error must be the same.
+    EXPECT_NEAR(full.getRMSE(), driver.getRMSE(), 1e-2*full.getRMSE());
+
+    std::vector<Complex> poles = driver.ss2pr().first;
+    EXPECT_EQ(2, poles.size());
+    EXPECT_NEAR(-1.440702837082726E9, poles[0].real(), 1e-3*1.44E9);
+    EXPECT_NEAR(-0.007688357841860E9, poles[1].real(), 1e-3*7.69E6);
+}
+
 TEST_F(DriverTest, ss2pr) {
     MatrixXcd A(8,8);
     A(0,0) = Complex(-5.394842153248248E9, 0.0);
@@ -405,3 +529,123 @@ TEST_F(DriverTest, ss2pr) {
         }
     }
 }
+
+TEST_F(DriverTest, views) {
+    vector<Driver::Sample> samples;
+    for (const Real f : linspace(std::make_pair(1.0, 10.0), 10)) {
+        samples.push_back(Driver::Sample(Complex(0.0, f),
+                                         MatrixXcd::Identity(2,2)));
+    }
+    const vector<Complex> poles = {Complex(-1.0, -3.0), Complex(-1.0, 3.0)};
+    const vector<MatrixXcd> residues(2, MatrixXcd::Ones(2,2));
+    Driver driver(samples, poles, residues,
+                  MatrixXcd::Identity(2,2), MatrixXcd::Zero(2,2));
+
+    // The model is kept packed and getters refer to it, no copies are made.
+    const MatrixXcd& packed = driver.getPackedResidues();
+    const vector<Driver::Sample>& stored = driver.getSamples();
+    EXPECT_EQ(2, driver.getNumberOfPorts());
+    EXPECT_EQ(3, packed.rows());
+    EXPECT_EQ(2, packed.cols());
+    EXPECT_EQ(samples.size(), stored.size());
+
+    // Full matrices are expanded on request.
+    EXPECT_EQ(MatrixXcd::Identity(2,2), driver.getD());
+    EXPECT_EQ(driver.getPackedD(), Driver::pack(driver.getD()));
+    EXPECT_EQ(driver.getPackedE(), Driver::pack(driver.getE()));
+    EXPECT_EQ(Complex(-1.0, -3.0), driver.getA()(0,0));
+    EXPECT_EQ(Complex(-1.0, -3.0), driver.getA()(2,2));
+    EXPECT_EQ(residues[0], driver.ss2pr().second[0]);
+    const Complex s(0.0, 2.0);
+    MatrixXcd expected = MatrixXcd::Identity(2,2);
+    for (size_t k = 0; k < poles.size(); ++k) {
+        expected += residues[k] / (s - poles[k]);
+    }
+    EXPECT_NEAR(0.0, (expected - driver.evaluate(s)).norm(), 1e-14);
+    EXPECT_EQ(driver.evaluate(s), Driver::unpack(driver.evaluatePacked(s), 2));
+
+    // Expanding them leaves the views pointing to the stored model.
+    EXPECT_EQ(&packed, &driver.getPackedResidues());
+    EXPECT_EQ(packed.data(), driver.getPackedResidues().data());
+    EXPECT_EQ(&stored, &driver.getSamples());
+}
+
+TEST_F(DriverTest, realStateSpace) {
+    vector<Driver::Sample> samples;
+    for (const Real f : linspace(std::make_pair(1.0, 10.0), 10)) {
+        samples.push_back(Driver::Sample(Complex(0.0, f),
+                                         MatrixXcd::Identity(2,2)));
+    }
+    const vector<Complex> poles = {
+            Complex(-2.0, 0.0), Complex(-1.0, -3.0), Complex(-1.0, 3.0)};
+    MatrixXcd R(2,2);
+    R << Complex(1.0, 2.0), Complex(0.5, -1.0),
+         Complex(0.5, -1.0), Complex(3.0, 0.5);
+    const vector<MatrixXcd> residues = {
+            MatrixXcd::Constant(2,2, 4.0), R, R.conjugate()};
+    const MatrixXcd D = MatrixXcd::Identity(2,2);
+    const MatrixXcd E = 1e-3 * MatrixXcd::Ones(2,2);
+
+    const Complex s(0.0, 2.0);
+    for (const bool complexSpaceState : {true, false}) {
+        Driver driver(samples, poles, residues, D, E, complexSpaceState);
+        const MatrixXcd A = driver.getA();
+        const MatrixXcd B = driver.getB().cast<Complex>();
+        const MatrixXcd C = driver.getC();
+        EXPECT_EQ(complexSpaceState, A.imag().isZero() == false);
+        EXPECT_EQ(complexSpaceState, C.imag().isZero() == false);
+
+        const MatrixXcd I = MatrixXcd::Identity(A.rows(), A.cols());
+        const MatrixXcd H = C * (s*I - A).inverse() * B
+                          + driver.getD() + s * driver.getE();
+        EXPECT_NEAR(0.0, (H - driver.evaluate(s)).norm(), 1e-12);
+    }
+
+    Driver real(samples, poles, residues, D, E, false);
+    EXPECT_EQ(Complex(-1.0, 0.0), real.getA()(1,1));
+    EXPECT_EQ(Complex(-3.0, 0.0), real.getA()(1,2));
+    EXPECT_EQ(Complex( 3.0, 0.0), real.getA()(2,1));
+    EXPECT_EQ(2, real.getB()(1,0));
+    EXPECT_EQ(0, real.getB()(2,0));
+    EXPECT_EQ(Complex(1.0, 0.0), real.getC()(0,1));
+    EXPECT_EQ(Complex(2.0, 0.0), real.getC()(0,2));
+}
+
+#ifdef __GLIBC__
+TEST_F(DriverTest, singlePrecisionFootprint) {
+    // Heap in use while relocating, besides the samples held by the driver,
+    // is mostly the squeezed responses held by the fittings.
+    const auto inUse = []() {
+        const struct mallinfo2 info = mallinfo2();
+        return (Real) (info.uordblks + info.hblkhd);
+    };
+    const vector<Driver::Sample> samples = buildSamples(4, 24, 200);
+    const size_t ports = samples.front().second.rows();
+    const Real samplesBytes =
+            (Real) (samples.size() * ports * ports * sizeof(Complex));
+    const Real squeezedBytes =
+            (Real) (samples.size() * ports * (ports+1)/2 * sizeof(Complex));
+
+    map<bool, Real> held;
+    for (const bool single : {false, true}) {
+        Options opts;
+        opts.setN(4);
+        opts.setIterations({2,2});
+        opts.setSinglePrecision(single);
+        const Real before = inUse();
+        held[single] = 0.0;
+        Control control;
+        control.setProgressCallback([&](const Control::Progress& p) {
+            if (p.stage == Control::Stage::relocation) {
+                held[single] = max(held[single],
+                                   inUse() - before - samplesBytes);
+            }
+        });
+        Driver driver(samples, opts, {}, {}, &control);
+    }
+
+    // One copy of the squeezed responses, halved in single precision.
+    EXPECT_LT(held[false], 1.25 * squeezedBytes);
+    EXPECT_LT(held[true],  0.75 * squeezedBytes);
+}
+#endif
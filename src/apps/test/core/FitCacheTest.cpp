@@ -0,0 +1,179 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Alejandro García Montoro        (alejandro.garciamontoro@gmail.com)
+//					  Alejandra López de Aberasturi Gómez (aloaberasturi@ugr.es)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+#include "gtest/gtest.h"
+
+#include "FitCache.h"
+#include "GeneratedSamples.h"
+
+#include <algorithm>
+#include <fstream>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace VectorFitting;
+using namespace std;
+
+class FitCacheTest : public ::testing::Test {
+protected:
+    FitCacheTest() : directory("FitCacheTest.cache") {
+        opts.setN(4);
+    }
+
+    ~FitCacheTest() {
+        FitCache(directory).clear();
+        unlink((directory + "/lock").c_str());
+        rmdir(directory.c_str());
+    }
+
+    static vector<Driver::Sample> scaledSamples(const Real scale) {
+        vector<Driver::Sample> samples = buildSamples(4, 2, 200);
+        for (size_t i = 0; i < samples.size(); ++i) {
+            samples[i].second *= scale;
+        }
+        return samples;
+    }
+
+    string directory;
+    Options opts;
+};
+
+TEST_F(FitCacheTest, hit) {
+    vector<Driver::Sample> samples = scaledSamples(1.0);
+    FitCache cache(directory);
+    EXPECT_FALSE(cache.contains(samples, opts));
+
+    Driver first = cache.fit(samples, opts);
+    EXPECT_TRUE(cache.contains(samples, opts));
+    EXPECT_EQ(0, cache.getHits());
+    EXPECT_EQ(1, cache.getMisses());
+
+    Driver second = cache.fit(samples, opts);
+    EXPECT_EQ(1, cache.getHits());
+    EXPECT_EQ(first.getA(), second.getA());
+    EXPECT_EQ(first.getB(), second.getB());
+    EXPECT_EQ(first.getC(), second.getC());
+    EXPECT_EQ(first.getD(), second.getD());
+    EXPECT_EQ(first.getE(), second.getE());
+    EXPECT_EQ(first.getRMSE(), second.getRMSE());
+
+    Options other = opts;
+    other.setRelax(false);
+    EXPECT_FALSE(cache.contains(samples, other));
+    EXPECT_NE(FitCache::hash(samples, opts, {}, {}),
+              FitCache::hash(samples, other, {}, {}));
+}
+
+TEST_F(FitCacheTest, reordered) {
+    vector<Driver::Sample> samples = scaledSamples(1.0);
+    vector<MatrixXd> weights;
+    for (size_t i = 0; i < samples.size(); ++i) {
+        weights.push_back(MatrixXd::Constant(2, 2, 1.0 + (Real) i));
+    }
+    FitCache cache(directory);
+    Driver first = cache.fit(samples, opts, {}, weights);
+
+    // Same dataset with the samples, and their weights, in reverse order.
+    vector<Driver::Sample> reversed(samples.rbegin(), samples.rend());
+    vector<MatrixXd> reversedWeights(weights.rbegin(), weights.rend());
+    EXPECT_EQ(FitCache::hashGrid(samples, opts),
+              FitCache::hashGrid(reversed, opts));
+    EXPECT_EQ(FitCache::hash(samples, opts, {}, weights),
+              FitCache::hash(reversed, opts, {}, reversedWeights));
+    EXPECT_NE(FitCache::hash(samples, opts, {}, weights),
+              FitCache::hash(reversed, opts, {}, weights));
+
+    Driver second = cache.fit(reversed, opts, {}, reversedWeights);
+    EXPECT_EQ(1, cache.getHits());
+    EXPECT_EQ(first.getC(), second.getC());
+
+    // Near misses are found in any order too.
+    vector<Driver::Sample> perturbed = scaledSamples(1.01);
+    reverse(perturbed.begin(), perturbed.end());
+    EXPECT_EQ(first.ss2pr().first, cache.warmStart(perturbed, opts));
+}
+
+TEST_F(FitCacheTest, optionsInKey) {
+    vector<Driver::Sample> samples = scaledSamples(1.0);
+    const uint64_t key = FitCache::hash(samples, opts, {}, {});
+
+    vector<Options> others(1, opts);
+    others[0].setPoleTolerance(1e-6);
+    others.push_back(opts);
+    others.back().setSinglePrecision(true);
+    others.push_back(opts);
+    others.back().setBasis(Options::Basis::orthonormal);
+    others.push_back(opts);
+    others.back().setSketching(true);
+    for (size_t i = 0; i < others.size(); ++i) {
+        EXPECT_NE(key, FitCache::hash(samples, others[i], {}, {}));
+    }
+}
+
+TEST_F(FitCacheTest, warmStart) {
+    FitCache cache(directory);
+    EXPECT_TRUE(cache.warmStart(scaledSamples(1.0), opts).empty());
+
+    Driver driver = cache.fit(scaledSamples(1.0), opts);
+
+    vector<Driver::Sample> perturbed = scaledSamples(1.01);
+    EXPECT_FALSE(cache.contains(perturbed, opts));
+    EXPECT_EQ(driver.ss2pr().first, cache.warmStart(perturbed, opts));
+    EXPECT_TRUE(cache.warmStart(scaledSamples(2.0), opts).empty());
+
+    Options higherOrder = opts;
+    higherOrder.setN(6);
+    EXPECT_TRUE(cache.warmStart(perturbed, higherOrder).empty());
+}
+
+TEST_F(FitCacheTest, eviction) {
+    // Room for a single model.
+    FitCache cache(directory, 1024);
+    cache.fit(scaledSamples(1.0), opts);
+    cache.fit(scaledSamples(2.0), opts);
+    EXPECT_FALSE(cache.contains(scaledSamples(1.0), opts));
+    EXPECT_TRUE(cache.contains(scaledSamples(2.0), opts));
+}
+
+TEST_F(FitCacheTest, temporaries) {
+    vector<Driver::Sample> samples = scaledSamples(1.0);
+    FitCache cache(directory, 1 << 20);
+    cache.fit(samples, opts);
+
+    const pid_t child = fork();
+    if (child == 0) {
+        _exit(0);
+    }
+    waitpid(child, nullptr, 0);
+    const string stale = directory + "/a.vfm.tmp." + to_string(child) + ".0";
+    const string live = directory + "/b.vfm.tmp." + to_string(getpid()) + ".0";
+    ofstream(stale.c_str()) << "partial";
+    ofstream(live.c_str()) << string(1 << 20, ' ');
+
+    cache.evict();
+    EXPECT_NE(0, access(stale.c_str(), F_OK));
+    EXPECT_EQ(0, access(live.c_str(), F_OK));
+    // The file being written counts towards the bound.
+    EXPECT_FALSE(cache.contains(samples, opts));
+    unlink(live.c_str());
+}
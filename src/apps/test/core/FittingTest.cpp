@@ -22,6 +22,7 @@
 
 
 #include <fstream>
+#include <random>
 
 #include "gtest/gtest.h"
 
@@ -693,3 +694,222 @@ TEST_F(FittingTest, polesWithSqueezedSum) {
 
 
 }
+
+TEST_F(FittingTest, unsortedSamples) {
+    const size_t Ns = 50;
+    const Complex p(-1e2, 1e3), r(3e2, -1e2);
+
+    std::vector<Fitting::Sample> samples;
+    std::vector<VectorXd> weights;
+    for (const Real f : logspace(std::make_pair(1.0, 4.0), Ns)) {
+        const Complex s(0.0, f);
+        VectorXcd response(2);
+        response(0) = r/(s-p) + std::conj(r)/(s-std::conj(p)) + 1.0;
+        response(1) = 2.0 * response(0);
+        samples.push_back(Fitting::Sample(s, response));
+        weights.push_back(VectorXd::Constant(1, 1.0 + f));
+    }
+    EXPECT_TRUE(Fitting::sortSamples(samples).empty());
+
+    std::vector<Fitting::Sample> reversed(samples.rbegin(), samples.rend());
+    std::vector<VectorXd> reversedWeights(weights.rbegin(), weights.rend());
+
+    Options opts;
+    opts.setSkipResidueIdentification(false);
+    const std::vector<Complex> poles = {Complex(-1e1, -1e2), Complex(-1e1, 1e2)};
+
+    Fitting sorted(samples, opts, poles, weights);
+    Fitting moved(std::move(reversed), opts, poles, reversedWeights);
+
+    ASSERT_EQ(Ns, moved.getSamplesSize());
+    for (size_t i = 0; i < Ns; ++i) {
+        EXPECT_EQ(samples[i].first, moved.getSamples()[i].first);
+        EXPECT_EQ(weights[i](0), moved.getWeights()(i, 0));
+    }
+
+    for (size_t i = 0; i < 3; ++i) {
+        sorted.fit();
+        moved.fit();
+    }
+    for (size_t k = 0; k < poles.size(); ++k) {
+        EXPECT_NEAR(0.0, std::abs(sorted.getPoles()[k] - moved.getPoles()[k]),
+                    1e-8 * std::abs(sorted.getPoles()[k]));
+    }
+    EXPECT_NEAR(sorted.getRMSE(), moved.getRMSE(), 1e-12);
+}
+
+TEST_F(FittingTest, treeReduction) {
+    const size_t Nc = 20;
+    std::vector<Fitting::Sample> samples;
+    for (const Real f : logspace(std::make_pair(1.0, 4.0), 60)) {
+        const Complex s(0.0, f);
+        VectorXcd response(Nc);
+        for (size_t n = 0; n < Nc; ++n) {
+            const Complex r(1e2 * (1.0 + n), 10.0);
+            const Complex p(-1e2, 1e3);
+            response(n) = r/(s-p) + std::conj(r)/(s-std::conj(p)) + 0.1*n;
+        }
+        samples.push_back(Fitting::Sample(s, response));
+    }
+    const std::vector<Complex> poles = {Complex(-1e1, -1e2), Complex(-1e1, 1e2)};
+    Fitting fitting(samples, Options(), poles);
+
+    // Reductions have the size of a single block, whatever the responses.
+    const Fitting::Reduction all = fitting.reduce(0, Nc);
+    EXPECT_EQ(3, all.A.rows());
+    EXPECT_EQ(3, all.A.cols());
+
+    // Any split of the responses gives the same solution.
+    const Fitting::Reduction merged = Fitting::merge({
+            fitting.reduce(0, 3), fitting.reduce(3, 11), fitting.reduce(11, Nc)});
+    EXPECT_NEAR(all.magnitude, merged.magnitude, 1e-12 * all.magnitude);
+    const VectorXd x = fitting.solveSigma(all);
+    const VectorXd y = fitting.solveSigma(merged);
+    EXPECT_NEAR(0.0, (x - y).norm(), 1e-10 * x.norm());
+    for (MatrixXd::Index j = 0; j < all.A.cols(); ++j) {
+        EXPECT_NEAR(all.A.col(j).norm(), merged.A.col(j).norm(),
+                    1e-10 * all.A.col(j).norm());
+    }
+}
+
+TEST_F(FittingTest, singlePrecision) {
+    const size_t Nc = 4;
+    std::vector<Fitting::Sample> samples;
+    for (const Real f : logspace(std::make_pair(1.0, 5.0), 200)) {
+        const Complex s(0.0, f);
+        VectorXcd response(Nc);
+        for (size_t n = 0; n < Nc; ++n) {
+            const Complex r1(1e2 * (1.0 + n), 10.0), p1(-1e2, 1e3);
+            const Complex r2(3e3, 1e3 * n),          p2(-2e3, 3e4);
+            response(n) = r1/(s-p1) + std::conj(r1)/(s-std::conj(p1))
+                        + r2/(s-p2) + std::conj(r2)/(s-std::conj(p2))
+                        + 0.1*n;
+        }
+        samples.push_back(Fitting::Sample(s, response));
+    }
+    const std::vector<Complex> poles = {
+            Complex(-1e1, -1e2), Complex(-1e1, 1e2),
+            Complex(-1e3, -1e4), Complex(-1e3, 1e4)};
+
+    Options opts;
+    Options singleOpts;
+    singleOpts.setSinglePrecision(true);
+    const Weights weights =
+            Weights::build(samples, Options::Weighting::oneOverSqrtAbs);
+    Fitting fitting(samples, opts, poles, weights);
+    Fitting single(samples, singleOpts, poles, weights);
+    EXPECT_TRUE(single.getSamples().front().second.size() == 0);
+    EXPECT_EQ(Nc, single.getResponseSize());
+    const Complex stored = Complex(std::complex<float>(samples[7].second(2)));
+    EXPECT_NEAR(0.0, std::abs(stored - single.getResponse(7, 2)),
+                1e-7 * std::abs(stored));
+    EXPECT_EQ(single.getResponse(7, 2), single.getResponseColumn(2)(7));
+    for (size_t i = 0; i < 5; ++i) {
+        fitting.fit();
+        single.fit();
+    }
+
+    // Storage rounds the data to about 1e-7, the model follows it.
+    for (size_t i = 0; i < poles.size(); ++i) {
+        EXPECT_NEAR(0.0, std::abs(fitting.getPoles()[i] - single.getPoles()[i]),
+                    1e-5 * std::abs(fitting.getPoles()[i]));
+    }
+    Real norm = 0.0;
+    for (const Fitting::Sample& sample : samples) {
+        norm += sample.second.squaredNorm();
+    }
+    norm = std::sqrt(norm / (Real) samples.size());
+    EXPECT_LT(fitting.getRMSE(), 1e-10 * norm);
+    EXPECT_LT(single.getRMSE(), 1e-6 * norm);
+    EXPECT_GT(single.getRMSE(), fitting.getRMSE());
+}
+
+TEST_F(FittingTest, orthonormalBasis) {
+    // Clustered poles give nearly dependent partial fractions.
+    std::vector<Complex> clustered;
+    for (const Real w : linspace(std::make_pair(9e2, 1.2e3), 16)) {
+        clustered.push_back(Complex(-w/100.0, -w));
+        clustered.push_back(Complex(-w/100.0,  w));
+    }
+    // Responses without structure, so that sigma is fully determined.
+    std::mt19937 engine(0);
+    std::normal_distribution<Real> normal;
+    std::vector<Fitting::Sample> samples;
+    for (const Real f : logspace(std::make_pair(1.0, 4.0), 1000)) {
+        samples.push_back(Fitting::Sample(Complex(0.0, f),
+                VectorXcd::Constant(1,
+                        Complex(normal(engine), normal(engine)))));
+    }
+    Options orthoOpts;
+    orthoOpts.setBasis(Options::Basis::orthonormal);
+    const Fitting partial(samples, Options(), clustered);
+    const Fitting ortho(samples, orthoOpts, clustered);
+
+    // Both give sigma as partial fractions.
+    Real partialCondition, orthoCondition;
+    const VectorXd x = partial.solveSigma(partial.reduce(0, 1), 0.0,
+                                          &partialCondition);
+    const VectorXd y = ortho.solveSigma(ortho.reduce(0, 1), 0.0,
+                                        &orthoCondition);
+    EXPECT_NEAR(0.0, (x - y).norm(), 1e-10 * x.norm());
+
+    // The orthonormal functions are better conditioned.
+    EXPECT_LT(orthoCondition, partialCondition);
+}
+
+TEST_F(FittingTest, orthonormalFit) {
+    const size_t Nc = 2;
+    const std::vector<Complex> truth = {
+            Complex(-2e1, 1.00e3), Complex(-3e1, 1.05e3),
+            Complex(-4e1, 1.10e3), Complex(-5e2, 2.0e4)};
+    std::vector<Fitting::Sample> samples;
+    for (const Real f : logspace(std::make_pair(2.0, 5.0), 400)) {
+        const Complex s(0.0, f);
+        VectorXcd response = VectorXcd::Constant(Nc, 0.5);
+        for (size_t k = 0; k < truth.size(); ++k) {
+            for (size_t n = 0; n < Nc; ++n) {
+                const Complex r(1e1 * (1.0 + n + k), 5.0 * k);
+                response(n) += r/(s-truth[k]) + std::conj(r)/(s-std::conj(truth[k]));
+            }
+        }
+        samples.push_back(Fitting::Sample(s, response));
+    }
+    std::vector<Complex> poles;
+    for (const Real w : logspace(std::make_pair(2.0, 5.0), 4)) {
+        poles.push_back(Complex(-w/100.0, -w));
+        poles.push_back(Complex(-w/100.0,  w));
+    }
+
+    Options opts;
+    Options orthoOpts;
+    orthoOpts.setBasis(Options::Basis::orthonormal);
+    Fitting fitting(samples, opts, poles);
+    Fitting ortho(samples, orthoOpts, poles);
+
+    // Sigma is returned as partial fractions in both cases.
+    const VectorXd x = fitting.solveSigma(fitting.reduce(0, Nc));
+    const VectorXd y = ortho.solveSigma(ortho.reduce(0, Nc));
+    EXPECT_NEAR(0.0, (x - y).norm(), 1e-8 * x.norm());
+
+    for (size_t i = 0; i < 3; ++i) {
+        fitting.fit();
+        ortho.fit();
+    }
+    EXPECT_LT(ortho.getRMSE(), 1e-10);
+    EXPECT_NEAR(fitting.getRMSE(), ortho.getRMSE(), 1e-10);
+    for (const Complex& p : truth) {
+        Real closest = std::numeric_limits<Real>::infinity();
+        for (const Complex& q : ortho.getPoles()) {
+            closest = std::min(closest, std::abs(p - q));
+        }
+        EXPECT_LT(closest, 1e-8 * std::abs(p));
+    }
+
+    // Also with responses stored in single precision.
+    orthoOpts.setSinglePrecision(true);
+    Fitting single(samples, orthoOpts, poles);
+    for (size_t i = 0; i < 3; ++i) {
+        single.fit();
+    }
+    EXPECT_LT(single.getRMSE(), 1e-5);
+}
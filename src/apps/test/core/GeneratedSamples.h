@@ -0,0 +1,88 @@
+// OpenSEMBAPtions
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Alejandro García Montoro        (alejandro.garciamontoro@gmail.com)
+//					  Alejandra López de Aberasturi Gómez (aloaberasturi@ugr.es)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef VECTOR_FITTING_TEST_GENERATED_SAMPLES_H_
+#define VECTOR_FITTING_TEST_GENERATED_SAMPLES_H_
+
+#include <cmath>
+#include <utility>
+#include <vector>
+
+#include "Generator.h"
+
+namespace VectorFitting {
+
+/**
+ * Generated model with the given order, ports and number of samples, see
+ * Generator. Range is in angular frequency, from 1 Hz to 1 kHz by default.
+ */
+inline Generator buildGenerator(
+        const std::size_t order,
+        const std::size_t ports,
+        const std::size_t samples,
+        const unsigned long seed = 0,
+        const std::pair<Real, Real>& range =
+                std::make_pair(2*M_PI*1.0, 2*M_PI*1e3),
+        const Real noise = 0.0) {
+    Generator generator;
+    generator.setOrder(order);
+    generator.setNumberOfPorts(ports);
+    generator.setNumberOfSamples(samples);
+    generator.setRange(range);
+    generator.setSeed(seed);
+    generator.setNoise(noise);
+    generator.generate();
+    return generator;
+}
+
+/**
+ * Samples of the model above.
+ */
+inline std::vector<Driver::Sample> buildSamples(
+        const std::size_t order,
+        const std::size_t ports,
+        const std::size_t samples,
+        const unsigned long seed = 0,
+        const std::pair<Real, Real>& range =
+                std::make_pair(2*M_PI*1.0, 2*M_PI*1e3),
+        const Real noise = 0.0) {
+    return buildGenerator(order, ports, samples, seed, range, noise)
+            .getSamples();
+}
+
+/**
+ * Lower triangles of the samples, as fitted by Driver.
+ */
+inline std::vector<Fitting::Sample> packSamples(
+        const std::vector<Driver::Sample>& samples) {
+    std::vector<Fitting::Sample> res;
+    res.reserve(samples.size());
+    for (const Driver::Sample& sample : samples) {
+        res.push_back(Fitting::Sample(sample.first,
+                                      Driver::pack(sample.second)));
+    }
+    return res;
+}
+
+} /* namespace VectorFitting */
+
+#endif // VECTOR_FITTING_TEST_GENERATED_SAMPLES_H_
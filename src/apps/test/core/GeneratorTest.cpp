@@ -0,0 +1,125 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Alejandro García Montoro        (alejandro.garciamontoro@gmail.com)
+//					  Alejandra López de Aberasturi Gómez (aloaberasturi@ugr.es)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+#include "gtest/gtest.h"
+
+#include "Generator.h"
+
+#include <sstream>
+
+using namespace VectorFitting;
+using namespace std;
+
+class GeneratorTest : public ::testing::Test {
+};
+
+TEST_F(GeneratorTest, groundTruth) {
+    Generator generator;
+    generator.setOrder(7);
+    generator.setNumberOfPorts(3);
+    generator.setNumberOfSamples(50);
+    generator.setAsymptoticTrend(Options::AsymptoticTrend::linear);
+    generator.generate();
+
+    ASSERT_EQ(7, generator.getPoles().size());
+    ASSERT_EQ(7, generator.getResidues().size());
+    for (size_t m = 0; m < 7; ++m) {
+        EXPECT_LT(generator.getPoles()[m].real(), 0.0);
+        EXPECT_TRUE(generator.getResidues()[m].isApprox(
+                generator.getResidues()[m].transpose()));
+    }
+    // Real pole first, then conjugated pairs.
+    EXPECT_EQ(0.0, generator.getPoles()[0].imag());
+    for (size_t m = 1; m < 7; m += 2) {
+        EXPECT_EQ(conj(generator.getPoles()[m]), generator.getPoles()[m+1]);
+    }
+
+    const vector<Driver::Sample> samples = generator.getSamples();
+    ASSERT_EQ(50, samples.size());
+    EXPECT_DOUBLE_EQ(1e3, samples.front().first.imag());
+    EXPECT_DOUBLE_EQ(1e9, samples.back().first.imag());
+    for (const Driver::Sample& sample : samples) {
+        EXPECT_TRUE(sample.second.isApprox(sample.second.transpose()));
+        EXPECT_TRUE(sample.second.isApprox(generator.evaluate(sample.first)));
+    }
+}
+
+TEST_F(GeneratorTest, deterministic) {
+    Generator generator;
+    generator.setNumberOfSamples(20);
+    generator.setSpacing(Generator::Spacing::linear);
+    generator.setNoise(1e-2);
+    generator.setSeed(7);
+    generator.generate();
+    const vector<Driver::Sample> samples = generator.getSamples();
+
+    Generator other;
+    other.setNumberOfSamples(20);
+    other.setSpacing(Generator::Spacing::linear);
+    other.setNoise(1e-2);
+    other.setSeed(7);
+    other.generate();
+    std::ostringstream out;
+    out.precision(3);
+    other.write(out);
+    EXPECT_EQ(3, out.precision());
+
+    std::istringstream in(out.str());
+    for (size_t i = 0; i < samples.size(); ++i) {
+        Real sReal, sImag;
+        ASSERT_TRUE(in >> sReal >> sImag);
+        EXPECT_EQ(samples[i].first, Complex(sReal, sImag));
+        for (MatrixXcd::Index j = 0; j < samples[i].second.size(); ++j) {
+            Real re, im;
+            ASSERT_TRUE(in >> re >> im);
+            EXPECT_EQ(samples[i].second(j), Complex(re, im));
+        }
+    }
+
+    other.setSeed(8);
+    other.generate();
+    EXPECT_NE(generator.getPoles()[0], other.getPoles()[0]);
+}
+
+TEST_F(GeneratorTest, fit) {
+    Generator generator;
+    generator.setOrder(6);
+    generator.setNumberOfPorts(2);
+    generator.setNumberOfSamples(300);
+    generator.setRange(make_pair(1e3, 1e6));
+    generator.generate();
+
+    Options opts;
+    opts.setN(6);
+    opts.setPolesType(Options::PolesType::logcmplx);
+    Driver driver(generator.getSamples(), opts);
+
+    const vector<Complex>& truth = generator.getPoles();
+    for (const Complex& p : driver.getPoles()) {
+        Real closest = numeric_limits<Real>::infinity();
+        for (const Complex& q : truth) {
+            closest = min(closest, abs(p - q));
+        }
+        EXPECT_LT(closest, 1e-6 * abs(p));
+    }
+    EXPECT_LT(driver.getRMSE(), 1e-8);
+}
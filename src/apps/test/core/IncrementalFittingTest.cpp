@@ -0,0 +1,215 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Alejandro García Montoro        (alejandro.garciamontoro@gmail.com)
+//					  Alejandra López de Aberasturi Gómez (aloaberasturi@ugr.es)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+#include "gtest/gtest.h"
+
+#include "GeneratedSamples.h"
+#include "IncrementalFitting.h"
+
+using namespace VectorFitting;
+using namespace std;
+
+class IncrementalFittingTest : public ::testing::Test {
+protected:
+    static vector<Fitting::Sample> noisySamples() {
+        return packSamples(
+                buildSamples(6, 2, 200, 1, make_pair(1e3, 1e6), 1e-4));
+    }
+
+    // The sample measured again, with a small error.
+    static Fitting::Sample remeasure(const Fitting::Sample& sample) {
+        return Fitting::Sample(sample.first,
+                               sample.second * Complex(1.0 + 1e-4, 1e-4));
+    }
+
+    static Options buildOptions() {
+        Options opts;
+        opts.setN(6);
+        opts.setPolesType(Options::PolesType::logcmplx);
+        opts.setAsymptoticTrend(Options::AsymptoticTrend::linear);
+        return opts;
+    }
+
+    // Downdates are accurate up to the square of the condition number.
+    static void expectSameModel(const IncrementalFitting& lhs,
+                                const IncrementalFitting& rhs) {
+        ASSERT_EQ(lhs.getPoles().size(), rhs.getPoles().size());
+        for (size_t m = 0; m < lhs.getPoles().size(); ++m) {
+            EXPECT_LT(abs(lhs.getPoles()[m] - rhs.getPoles()[m]),
+                      1e-6 * abs(rhs.getPoles()[m]));
+        }
+        EXPECT_TRUE(lhs.getResidues().isApprox(rhs.getResidues(), 1e-5));
+        for (const Fitting::Sample& sample : rhs.getSamples()) {
+            EXPECT_LT((lhs.evaluate(sample.first) -
+                       rhs.evaluate(sample.first)).norm(),
+                      1e-5 * sample.second.norm());
+        }
+        EXPECT_NEAR(lhs.getRMSE(), rhs.getRMSE(), 1e-3 * rhs.getRMSE());
+    }
+};
+
+TEST_F(IncrementalFittingTest, sameAsFitting) {
+    const vector<Fitting::Sample> samples = noisySamples();
+    Options opts = buildOptions();
+    opts.setComplexSpaceState(true);
+    const vector<Complex> poles = Driver::buildPoles(samples, opts);
+
+    IncrementalFitting incremental(samples, opts, poles);
+    Fitting fitting(samples, opts, poles);
+    for (size_t i = 0; i < 3; ++i) {
+        EXPECT_EQ(1, incremental.refit(1));
+        fitting.fit();
+        for (size_t m = 0; m < poles.size(); ++m) {
+            EXPECT_LT(abs(incremental.getPoles()[m] - fitting.getPoles()[m]),
+                      1e-8 * abs(fitting.getPoles()[m]));
+        }
+    }
+    EXPECT_EQ(4, incremental.getFactorizations());
+
+    // Residues of the last poles.
+    opts.setSkipPoleIdentification(true);
+    Fitting residues(samples, opts, incremental.getPoles());
+    residues.fit();
+    EXPECT_TRUE(incremental.getResidues().isApprox(residues.getC(), 1e-8));
+    EXPECT_TRUE(incremental.getD().isApprox(residues.getD(), 1e-8));
+    EXPECT_TRUE(incremental.getE().isApprox(residues.getE(), 1e-8));
+}
+
+TEST_F(IncrementalFittingTest, edits) {
+    const vector<Fitting::Sample> original = noisySamples();
+    // Relocates even when the poles barely move.
+    Options opts = buildOptions();
+    opts.setPoleTolerance(1e-12);
+    IncrementalFitting converged(original, opts,
+                                 Driver::buildPoles(original, opts));
+    converged.refit(5);
+    const vector<Complex> poles = converged.getPoles();
+
+    IncrementalFitting incremental(original, opts, poles);
+
+    // Replaces three samples, removes two and adds one back.
+    vector<Fitting::Sample> samples = original;
+    for (const size_t i : {10, 100, 150}) {
+        samples[i] = remeasure(original[i]);
+    }
+    incremental.replace({samples[10], samples[100], samples[150]});
+    incremental.remove({samples[20].first, samples[199].first});
+    incremental.add({samples[20]});
+    samples.erase(samples.begin() + 199);
+    EXPECT_EQ(1, incremental.getFactorizations());
+
+    const IncrementalFitting rebuilt(samples, opts, poles);
+    ASSERT_EQ(samples.size(), incremental.getSamples().size());
+    for (size_t i = 0; i < samples.size(); ++i) {
+        EXPECT_EQ(samples[i].first, incremental.getSamples()[i].first);
+    }
+    expectSameModel(incremental, rebuilt);
+
+    IncrementalFitting relocated = incremental;
+    IncrementalFitting relocatedRebuilt = rebuilt;
+    EXPECT_EQ(1, relocated.refit(1));
+    relocatedRebuilt.refit(1);
+    expectSameModel(relocated, relocatedRebuilt);
+
+    EXPECT_THROW(incremental.add({samples[0]}), std::runtime_error);
+    EXPECT_THROW(incremental.remove({Complex(0.0, -1.0)}), std::runtime_error);
+    EXPECT_THROW(incremental.replace({Fitting::Sample(Complex(0.0, -1.0),
+                                                      samples[0].second)}),
+                 std::runtime_error);
+}
+
+TEST_F(IncrementalFittingTest, invalidEdits) {
+    const vector<Fitting::Sample> samples = noisySamples();
+    Options opts = buildOptions();
+    opts.setPoleTolerance(1e-12);
+    const vector<Complex> poles = Driver::buildPoles(samples, opts);
+    IncrementalFitting incremental(samples, opts, poles);
+
+    // Each batch fails on its last edit, after valid ones.
+    const Fitting::Sample missing(Complex(0.0, -1.0), samples[0].second);
+    const Fitting::Sample shorter(samples[3].first, samples[3].second.head(1));
+    EXPECT_THROW(incremental.replace({remeasure(samples[1]), missing}),
+                 std::runtime_error);
+    EXPECT_THROW(incremental.replace({remeasure(samples[1]), shorter}),
+                 std::runtime_error);
+    EXPECT_THROW(incremental.replace({remeasure(samples[1]),
+                                      remeasure(samples[1])}),
+                 std::runtime_error);
+    EXPECT_THROW(incremental.add({missing, samples[2]}), std::runtime_error);
+    EXPECT_THROW(incremental.add({missing, missing}), std::runtime_error);
+    EXPECT_THROW(incremental.remove({samples[4].first, missing.first}),
+                 std::runtime_error);
+    EXPECT_THROW(incremental.remove({samples[4].first, samples[4].first}),
+                 std::runtime_error);
+    vector<Complex> all;
+    for (const Fitting::Sample& sample : samples) {
+        all.push_back(sample.first);
+    }
+    EXPECT_THROW(incremental.remove(all), std::runtime_error);
+
+    // Nothing was changed.
+    ASSERT_EQ(samples.size(), incremental.getSamples().size());
+    for (size_t i = 0; i < samples.size(); ++i) {
+        EXPECT_EQ(samples[i].first, incremental.getSamples()[i].first);
+        EXPECT_EQ(samples[i].second, incremental.getSamples()[i].second);
+    }
+    IncrementalFitting rebuilt(samples, opts, poles);
+    incremental.refit(1);
+    rebuilt.refit(1);
+    expectSameModel(incremental, rebuilt);
+}
+
+TEST_F(IncrementalFittingTest, converged) {
+    const vector<Fitting::Sample> original = noisySamples();
+    Options opts = buildOptions();
+    opts.setPoleTolerance(1e-3);
+
+    IncrementalFitting incremental(original, opts,
+                                   Driver::buildPoles(original, opts));
+    EXPECT_LT(incremental.refit(10), 10);
+    const size_t factorizations = incremental.getFactorizations();
+    const vector<Complex> poles = incremental.getPoles();
+    const Real rmse = incremental.getRMSE();
+
+    // Poles barely move with a few samples measured again, so only the
+    // residues are identified again, without new factorizations.
+    incremental.replace({remeasure(original[50]), remeasure(original[51])});
+    EXPECT_EQ(0, incremental.refit(10));
+    EXPECT_EQ(factorizations, incremental.getFactorizations());
+    EXPECT_EQ(poles, incremental.getPoles());
+    EXPECT_LT(incremental.getRMSE(), 2.0 * rmse);
+}
+
+TEST_F(IncrementalFittingTest, defaultTolerance) {
+    const vector<Fitting::Sample> original = noisySamples();
+    const Options opts = buildOptions();
+    ASSERT_EQ(0.0, opts.getPoleTolerance());
+
+    IncrementalFitting incremental(original, opts,
+                                   Driver::buildPoles(original, opts));
+    EXPECT_LT(incremental.refit(20), 20);
+
+    // Converged poles are kept without factorizing again.
+    const size_t factorizations = incremental.getFactorizations();
+    EXPECT_EQ(0, incremental.refit(1));
+    EXPECT_EQ(factorizations, incremental.getFactorizations());
+}
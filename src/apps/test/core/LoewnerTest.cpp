@@ -0,0 +1,85 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Alejandro García Montoro        (alejandro.garciamontoro@gmail.com)
+//					  Alejandra López de Aberasturi Gómez (aloaberasturi@ugr.es)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+#include "gtest/gtest.h"
+
+#include "GeneratedSamples.h"
+#include "Loewner.h"
+
+using namespace VectorFitting;
+using namespace std;
+
+class LoewnerTest : public ::testing::Test {
+protected:
+    static Generator threePortGenerator(const size_t order) {
+        return buildGenerator(order, 3, 400, 3, make_pair(1e3, 1e7));
+    }
+
+    static Real distanceToClosest(const Complex& p,
+                                  const vector<Complex>& poles) {
+        Real res = numeric_limits<Real>::infinity();
+        for (const Complex& q : poles) {
+            res = min(res, abs(p - q));
+        }
+        return res;
+    }
+};
+
+TEST_F(LoewnerTest, poles) {
+    const Generator generator = threePortGenerator(10);
+    const vector<Fitting::Sample> packed = packSamples(generator.getSamples());
+
+    // The constant term adds to the rank of the pencil.
+    Loewner loewner(packed, 16);
+    EXPECT_GE(loewner.getOrder(), 10);
+    EXPECT_LE(loewner.getOrder(), 16);
+    ASSERT_EQ(10, loewner.getPoles().size());
+    for (const Complex& p : generator.getPoles()) {
+        EXPECT_LT(distanceToClosest(p, loewner.getPoles()), 1e-6 * abs(p));
+    }
+    for (size_t m = 0; m < 10; m += 2) {
+        EXPECT_EQ(conj(loewner.getPoles()[m]), loewner.getPoles()[m+1]);
+        EXPECT_LT(loewner.getPoles()[m].imag(), 0.0);
+    }
+
+    // Lower orders keep the poles that fit.
+    EXPECT_LE(Loewner(packed, 5).getPoles().size(), 5);
+}
+
+TEST_F(LoewnerTest, driver) {
+    const Generator generator = threePortGenerator(12);
+
+    Options opts;
+    opts.setN(14);
+    opts.setPolesType(Options::PolesType::loewner);
+    const vector<Complex> poles =
+            Driver::buildPoles(generator.getSamples(), opts);
+    ASSERT_EQ(14, poles.size());
+    for (const Complex& p : generator.getPoles()) {
+        EXPECT_LT(distanceToClosest(p, poles), 1e-6 * abs(p));
+    }
+
+    // Starting close to the answer, a single iteration is enough.
+    opts.setIterations({0, 1});
+    Driver driver(generator.getSamples(), opts);
+    EXPECT_LT(driver.getRMSE(), 1e-8);
+}
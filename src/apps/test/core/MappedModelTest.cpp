@@ -0,0 +1,155 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Alejandro García Montoro        (alejandro.garciamontoro@gmail.com)
+//					  Alejandra López de Aberasturi Gómez (aloaberasturi@ugr.es)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+#include "gtest/gtest.h"
+
+#include "GeneratedSamples.h"
+#include "MappedModel.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+using namespace VectorFitting;
+using namespace std;
+
+class MappedModelTest : public ::testing::Test {
+protected:
+    MappedModelTest() :
+            filename("MappedModelTest.vfm"),
+            samples(buildSamples(4, 2, 200)) {
+        opts.setN(4);
+        opts.setIterations({3,5});
+        opts.setWeighting(Options::Weighting::one);
+        opts.setNu(2e-3);
+        opts.setRelax(false);
+        opts.setPoleTolerance(1e-6);
+        opts.setSinglePrecision(true);
+        opts.setBasis(Options::Basis::orthonormal);
+        opts.setSketching(true);
+    }
+
+    ~MappedModelTest() {
+        remove(filename.c_str());
+    }
+
+    string filename;
+    vector<Driver::Sample> samples;
+    Options opts;
+};
+
+TEST_F(MappedModelTest, roundTrip) {
+    Driver driver(samples, opts);
+    MappedModel::write(filename, driver, opts);
+
+    MappedModel model(filename);
+    EXPECT_EQ(2, model.getNumberOfPorts());
+    EXPECT_EQ(4, model.getNumberOfPoles());
+    EXPECT_EQ(3, model.getD().size());
+    EXPECT_EQ(samples.size(), model.getNumberOfSamples());
+    EXPECT_EQ(driver.getRMSE(), model.getRMSE());
+    EXPECT_LT(0.0, model.getMaxDeviation());
+    EXPECT_EQ(samples.front().first.imag(), model.getFrequencyRange().first);
+    EXPECT_EQ(samples.back().first.imag(), model.getFrequencyRange().second);
+    EXPECT_EQ(MappedModel::signature(samples), model.getSignature());
+
+    Options loaded = model.getOptions();
+    EXPECT_EQ(opts.getN(), loaded.getN());
+    EXPECT_EQ(opts.getIterations(), loaded.getIterations());
+    EXPECT_EQ(opts.getNu(), loaded.getNu());
+    EXPECT_EQ(opts.getPoleTolerance(), loaded.getPoleTolerance());
+    EXPECT_EQ(opts.isSinglePrecision(), loaded.isSinglePrecision());
+    EXPECT_EQ(opts.getBasis(), loaded.getBasis());
+    EXPECT_EQ(opts.isSketching(), loaded.isSketching());
+    EXPECT_EQ(opts.isRelax(), loaded.isRelax());
+    EXPECT_EQ(opts.isStable(), loaded.isStable());
+    EXPECT_EQ(opts.getAsymptoticTrend(), loaded.getAsymptoticTrend());
+
+    pair<vector<Complex>, vector<MatrixXcd>> expected = driver.ss2pr();
+    pair<vector<Complex>, vector<MatrixXcd>> obtained = model.ss2pr();
+    EXPECT_EQ(expected.first, obtained.first);
+    for (size_t k = 0; k < expected.second.size(); ++k) {
+        EXPECT_EQ(expected.second[k], obtained.second[k]);
+    }
+
+    vector<Driver::Sample> fitted = driver.getFittedSamples();
+    for (size_t i = 0; i < fitted.size(); ++i) {
+        MatrixXcd value = model.evaluate(fitted[i].first);
+        EXPECT_NEAR(0.0, (value - fitted[i].second).norm(),
+                    1e-12 * fitted[i].second.norm());
+    }
+}
+
+TEST_F(MappedModelTest, invalidFiles) {
+    EXPECT_THROW(MappedModel("nonExistent.vfm"), std::runtime_error);
+
+    {
+        ofstream out(filename.c_str(), ios::binary);
+        out << "This is not a model file, though it is long enough to be one "
+               "as its length exceeds the size of the header of model files "
+               "by a comfortable margin of several bytes.";
+    }
+    EXPECT_THROW(MappedModel model(filename), std::runtime_error);
+
+    Driver driver(samples, opts);
+    MappedModel::write(filename, driver, opts);
+    vector<char> content;
+    {
+        ifstream in(filename.c_str(), ios::binary);
+        content.assign(istreambuf_iterator<char>(in),
+                       istreambuf_iterator<char>());
+    }
+    {
+        ofstream out(filename.c_str(), ios::binary | ios::trunc);
+        out.write(content.data(), content.size() - 16);
+    }
+    EXPECT_THROW(MappedModel model(filename), std::runtime_error);
+
+    // Sizes which wrap the ends of the arrays around to valid offsets:
+    // 2^61 ports give 2^60 packed responses of 16 bytes, and so do 2^60
+    // poles.
+    const size_t nPortsOffset = 24, nPolesOffset = 32;
+    for (const size_t offset : {nPortsOffset, nPolesOffset}) {
+        vector<char> crafted = content;
+        const std::uint64_t count = (offset == nPortsOffset) ?
+                (std::uint64_t) 1 << 61 : (std::uint64_t) 1 << 60;
+        std::memcpy(crafted.data() + offset, &count, sizeof(count));
+        {
+            ofstream out(filename.c_str(), ios::binary | ios::trunc);
+            out.write(crafted.data(), crafted.size());
+        }
+        EXPECT_THROW(MappedModel model(filename), std::runtime_error);
+    }
+
+    // Out of range asymptotic trend, poles type, weighting and basis.
+    for (const size_t offset : {40, 44, 48, 52}) {
+        vector<char> crafted = content;
+        const std::uint32_t value = 100;
+        std::memcpy(crafted.data() + offset, &value, sizeof(value));
+        {
+            ofstream out(filename.c_str(), ios::binary | ios::trunc);
+            out.write(crafted.data(), crafted.size());
+        }
+        EXPECT_THROW(MappedModel model(filename), std::runtime_error);
+    }
+}
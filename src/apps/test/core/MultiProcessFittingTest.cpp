@@ -0,0 +1,167 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Alejandro García Montoro        (alejandro.garciamontoro@gmail.com)
+//					  Alejandra López de Aberasturi Gómez (aloaberasturi@ugr.es)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+#include "gtest/gtest.h"
+
+#include "GeneratedSamples.h"
+#include "MultiProcessFitting.h"
+#include "SpaceGenerator.h"
+
+#include <cstdio>
+#include <fstream>
+
+#include <dirent.h>
+#include <signal.h>
+#include <unistd.h>
+
+using namespace VectorFitting;
+using namespace std;
+
+class MultiProcessFittingTest : public ::testing::Test {
+protected:
+    // Packed responses of a symmetric model with three pairs of poles.
+    static vector<Fitting::Sample> portSamples(const size_t ports) {
+        return packSamples(
+                buildSamples(6, ports, 150, 0, make_pair(1e2, 1e4)));
+    }
+
+    // Workers are the only children of the test process.
+    static vector<pid_t> children() {
+        vector<pid_t> res;
+        DIR* dir = opendir("/proc");
+        if (dir == nullptr) {
+            return res;
+        }
+        while (const dirent* entry = readdir(dir)) {
+            ifstream file(string("/proc/") + entry->d_name + "/stat");
+            string stat;
+            if (atoi(entry->d_name) <= 0 || !getline(file, stat)) {
+                continue;
+            }
+            char state;
+            int ppid;
+            const size_t end = stat.rfind(')');
+            if (end != string::npos &&
+                    sscanf(stat.c_str() + end + 1, " %c %d", &state, &ppid) == 2 &&
+                    ppid == getpid()) {
+                res.push_back(atoi(entry->d_name));
+            }
+        }
+        closedir(dir);
+        return res;
+    }
+};
+
+TEST_F(MultiProcessFittingTest, sameAsFitting) {
+    const vector<Fitting::Sample> samples = portSamples(3);
+    Options opts;
+    opts.setSkipResidueIdentification(false);
+    vector<Complex> poles;
+    for (const Real w : logspace(make_pair(2.0, 4.0), 3)) {
+        poles.push_back(Complex(-0.01 * w, -w));
+        poles.push_back(Complex(-0.01 * w,  w));
+    }
+
+    Fitting reference(samples, opts, poles);
+    MultiProcessFitting distributed(samples, opts, poles, 3);
+    EXPECT_EQ(3, distributed.getNumberOfWorkers());
+
+    for (size_t i = 0; i < 4; ++i) {
+        reference.fit();
+        distributed.fit();
+        ASSERT_EQ(reference.getPoles().size(), distributed.getPoles().size());
+        for (size_t k = 0; k < poles.size(); ++k) {
+            EXPECT_NEAR(0.0, abs(reference.getPoles()[k] -
+                                 distributed.getPoles()[k]),
+                        1e-9 * abs(reference.getPoles()[k]));
+        }
+    }
+    EXPECT_NEAR(0.0, (reference.getA() - distributed.getA()).norm(),
+                1e-9 * reference.getA().norm());
+    EXPECT_EQ(reference.getB(), distributed.getB());
+    EXPECT_NEAR(0.0, (reference.getC() - distributed.getC()).norm(),
+                1e-9 * reference.getC().norm());
+    EXPECT_NEAR(0.0, (reference.getD() - distributed.getD()).norm(),
+                1e-9 * reference.getD().norm());
+    EXPECT_NEAR(reference.getRMSE(), distributed.getRMSE(), 1e-9);
+    EXPECT_NEAR(reference.getMaxDeviation(), distributed.getMaxDeviation(),
+                1e-9);
+    EXPECT_LT(distributed.getRMSE(), 1e-8);
+}
+
+TEST_F(MultiProcessFittingTest, loader) {
+    const vector<Fitting::Sample> samples = portSamples(3);
+    Options opts;
+    opts.setSkipResidueIdentification(false);
+    const vector<Complex> poles = {Complex(-1e1, -1e3), Complex(-1e1, 1e3)};
+
+    // Each worker builds its own responses.
+    MultiProcessFitting::Loader load = [](size_t first, size_t last) {
+        MultiProcessFitting::Part part;
+        for (const Fitting::Sample& sample : portSamples(3)) {
+            part.samples.push_back(Fitting::Sample(
+                    sample.first, sample.second.segment(first, last - first)));
+        }
+        return part;
+    };
+    MultiProcessFitting distributed(samples.front().second.size(), load,
+                                    opts, poles, 4);
+    EXPECT_EQ(4, distributed.getNumberOfWorkers());
+    EXPECT_EQ(6, distributed.getResponseSize());
+
+    Fitting reference(samples, opts, poles);
+    reference.fit();
+    distributed.fit();
+    EXPECT_NEAR(0.0, (reference.getC() - distributed.getC()).norm(),
+                1e-9 * reference.getC().norm());
+    EXPECT_NEAR(reference.getRMSE(), distributed.getRMSE(), 1e-9);
+
+    MultiProcessFitting::Loader fail = [](size_t, size_t) {
+        throw runtime_error("No data");
+        return MultiProcessFitting::Part();
+    };
+    EXPECT_THROW(MultiProcessFitting(6, fail, opts, poles, 2), runtime_error);
+    EXPECT_EQ(4, children().size());
+}
+
+TEST_F(MultiProcessFittingTest, moreWorkersThanResponses) {
+    Options opts;
+    MultiProcessFitting distributed(portSamples(2), opts,
+            {Complex(-1e1, -1e3), Complex(-1e1, 1e3)}, 8);
+    EXPECT_EQ(3, distributed.getNumberOfWorkers());
+    distributed.fit();
+    EXPECT_EQ(2, distributed.getPoles().size());
+}
+
+TEST_F(MultiProcessFittingTest, lostWorker) {
+    Options opts;
+    MultiProcessFitting distributed(portSamples(2), opts,
+            {Complex(-1e1, -1e3), Complex(-1e1, 1e3)}, 2);
+    const vector<pid_t> workers = children();
+    ASSERT_EQ(2, workers.size());
+    kill(workers.front(), SIGKILL);
+
+    EXPECT_THROW(distributed.fit(), runtime_error);
+    EXPECT_EQ(0, distributed.getNumberOfWorkers());
+    EXPECT_TRUE(children().empty());
+    EXPECT_THROW(distributed.fit(), runtime_error);
+}
@@ -0,0 +1,117 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Alejandro García Montoro        (alejandro.garciamontoro@gmail.com)
+//					  Alejandra López de Aberasturi Gómez (aloaberasturi@ugr.es)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+#include "gtest/gtest.h"
+
+#include "GeneratedSamples.h"
+#include "Passivity.h"
+
+using namespace VectorFitting;
+using namespace std;
+
+class PassivityTest : public ::testing::Test {
+protected:
+    // Y(s) = 0.5 - 1/(s-p) - 1/(s-conj(p)) with p = -1 + 10j, which is not
+    // passive around w = 10.
+    static Passivity build(const Passivity::Method method) {
+        vector<Complex> poles = {Complex(-1.0, 10.0), Complex(-1.0, -10.0)};
+        vector<MatrixXcd> residues(2, MatrixXcd::Constant(1,1, -1.0));
+        return Passivity(poles, residues,
+                         MatrixXcd::Constant(1,1, 0.5),
+                         MatrixXcd::Zero(1,1),
+                         method);
+    }
+};
+
+TEST_F(PassivityTest, halfSizeMatrix) {
+    Passivity passivity = build(Passivity::Method::halfSizeMatrix);
+    EXPECT_EQ(Passivity::Method::halfSizeMatrix, passivity.getMethod());
+    EXPECT_FALSE(passivity.isPassive());
+
+    const vector<Real>& crossings = passivity.getCrossings();
+    ASSERT_EQ(2, crossings.size());
+    for (size_t i = 0; i < crossings.size(); ++i) {
+        EXPECT_NEAR(0.0, passivity.minEigenvalue(crossings[i]), 1e-10);
+    }
+
+    ASSERT_EQ(1, passivity.getViolations().size());
+    const Passivity::Band& band = passivity.getViolations().front();
+    EXPECT_EQ(crossings[0], band.from);
+    EXPECT_EQ(crossings[1], band.to);
+    EXPECT_LT(band.from, 10.0);
+    EXPECT_GT(band.to, 10.0);
+    EXPECT_NEAR(10.0, band.worst, 0.5);
+    EXPECT_LT(band.minEigenvalue, 0.0);
+}
+
+TEST_F(PassivityTest, sampling) {
+    Passivity reference = build(Passivity::Method::halfSizeMatrix);
+    Passivity passivity = build(Passivity::Method::sampling);
+    EXPECT_EQ(Passivity::Method::sampling, passivity.getMethod());
+    EXPECT_FALSE(passivity.isPassive());
+
+    ASSERT_EQ(reference.getCrossings().size(),
+              passivity.getCrossings().size());
+    for (size_t i = 0; i < passivity.getCrossings().size(); ++i) {
+        EXPECT_NEAR(reference.getCrossings()[i],
+                    passivity.getCrossings()[i], 1e-8);
+    }
+    EXPECT_EQ(1, passivity.getViolations().size());
+}
+
+TEST_F(PassivityTest, singularD) {
+    vector<Complex> poles = {-1.0};
+    vector<MatrixXcd> residues(1, MatrixXcd::Constant(1,1, -1.0));
+    Passivity passivity(poles, residues,
+                        MatrixXcd::Zero(1,1), MatrixXcd::Zero(1,1));
+
+    // Re Y(jw) = -1 / (1 + w^2) is negative at every frequency.
+    EXPECT_EQ(Passivity::Method::sampling, passivity.getMethod());
+    EXPECT_TRUE(passivity.getCrossings().empty());
+    ASSERT_EQ(1, passivity.getViolations().size());
+    EXPECT_EQ(0.0, passivity.getViolations().front().from);
+    EXPECT_NEAR(-1.0, passivity.getViolations().front().minEigenvalue, 1e-12);
+}
+
+TEST_F(PassivityTest, driver) {
+    // A single band of violation within the range.
+    const Generator generator = buildGenerator(4, 2, 200, 53);
+    Options opts;
+    opts.setN(4);
+    Driver driver(generator.getSamples(), opts);
+
+    Passivity passivity(driver);
+    EXPECT_EQ(Passivity::Method::halfSizeMatrix, passivity.getMethod());
+
+    // Same violations as the model which was sampled.
+    Passivity reference(generator.getPoles(), generator.getResidues(),
+                        generator.getD(), generator.getE());
+    EXPECT_FALSE(passivity.isPassive());
+    ASSERT_EQ(1, reference.getViolations().size());
+    ASSERT_EQ(1, passivity.getViolations().size());
+    const Passivity::Band& expected = reference.getViolations().front();
+    const Passivity::Band& band = passivity.getViolations().front();
+    EXPECT_NEAR(expected.from, band.from, 1e-6 * expected.to);
+    EXPECT_NEAR(expected.to, band.to, 1e-6 * expected.to);
+    EXPECT_NEAR(expected.minEigenvalue, band.minEigenvalue,
+                1e-6 * abs(expected.minEigenvalue));
+}
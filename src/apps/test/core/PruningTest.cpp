@@ -0,0 +1,115 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Alejandro García Montoro        (alejandro.garciamontoro@gmail.com)
+//					  Alejandra López de Aberasturi Gómez (aloaberasturi@ugr.es)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+#include "gtest/gtest.h"
+
+#include "GeneratedSamples.h"
+#include "Pruning.h"
+
+using namespace VectorFitting;
+using namespace std;
+
+class PruningTest : public ::testing::Test {
+};
+
+TEST_F(PruningTest, rank) {
+    const vector<Complex> poles = {
+            Complex(-1e3, 0.0),
+            Complex(-2e3, -1e4), Complex(-2e3, 1e4),
+            Complex(-5e3, -1e5), Complex(-5e3, 1e5)};
+    MatrixXcd residues(1, 5);
+    residues << 1e2, 1e-3, 1e-3, 1e5, 1e5;
+    vector<Fitting::Sample> samples;
+    for (const Real w : linspace(make_pair(1e3, 1e6), 100)) {
+        samples.push_back(Fitting::Sample(Complex(0.0, w), VectorXcd::Zero(1)));
+    }
+
+    const vector<pair<Real, size_t>> ranking =
+            Pruning::rank(samples, poles, residues);
+    ASSERT_EQ(3, ranking.size());
+    EXPECT_EQ(1, ranking[0].second);
+    EXPECT_EQ(0, ranking[1].second);
+    EXPECT_EQ(3, ranking[2].second);
+    EXPECT_LT(ranking[0].first, ranking[1].first);
+    EXPECT_LT(ranking[1].first, ranking[2].first);
+}
+
+TEST_F(PruningTest, driver) {
+    const Generator generator =
+            buildGenerator(6, 2, 300, 0, make_pair(1e3, 1e6), 1e-6);
+
+    // Twice the poles needed.
+    Options opts;
+    opts.setN(12);
+    opts.setPolesType(Options::PolesType::logcmplx);
+    const Driver driver(generator.getSamples(), opts);
+
+    const Pruning pruning(driver, opts, 0.1);
+    const size_t N = pruning.getPoles().size();
+    EXPECT_LT(N, 12);
+    EXPECT_GE(N, 6);
+    EXPECT_EQ(12, N + pruning.getRemovedPoles().size());
+    EXPECT_LE(pruning.getRMSE(), 1.1 * pruning.getOriginalRMSE());
+    EXPECT_EQ(N, pruning.getResidues().cols());
+
+    // Pairs are removed together.
+    const vector<Complex>& removed = pruning.getRemovedPoles();
+    for (size_t k = 0; k < removed.size(); ++k) {
+        if (removed[k].imag() != 0.0) {
+            ASSERT_LT(k + 1, removed.size());
+            EXPECT_EQ(conj(removed[k]), removed[k+1]);
+            k++;
+        }
+    }
+
+    // True poles are kept.
+    for (const Complex& p : generator.getPoles()) {
+        Real closest = numeric_limits<Real>::infinity();
+        for (const Complex& q : pruning.getPoles()) {
+            closest = min(closest, abs(p - q));
+        }
+        EXPECT_LT(closest, 1e-3 * abs(p));
+    }
+
+    const Driver reduced(driver.getSamples(), pruning.getPoles(),
+                         pruning.getResidues(), pruning.getD(),
+                         pruning.getE());
+    EXPECT_LT(reduced.getRMSE(), 2.0 * driver.getRMSE());
+}
+
+TEST_F(PruningTest, tolerance) {
+    const vector<Driver::Sample> samples =
+            buildSamples(6, 2, 200, 0, make_pair(1e3, 1e6));
+
+    Options opts;
+    opts.setN(6);
+    opts.setPolesType(Options::PolesType::logcmplx);
+    const Driver driver(samples, opts);
+
+    // All the poles are needed.
+    const Pruning pruning(driver, opts, 0.1);
+    EXPECT_EQ(6, pruning.getPoles().size());
+    EXPECT_TRUE(pruning.getRemovedPoles().empty());
+    EXPECT_EQ(pruning.getOriginalRMSE(), pruning.getRMSE());
+
+    EXPECT_THROW(Pruning(driver, opts, -1.0), std::runtime_error);
+}
@@ -0,0 +1,145 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Alejandro García Montoro        (alejandro.garciamontoro@gmail.com)
+//					  Alejandra López de Aberasturi Gómez (aloaberasturi@ugr.es)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+#include "gtest/gtest.h"
+
+#include "RecursiveConvolution.h"
+
+using namespace VectorFitting;
+using namespace std;
+
+class RecursiveConvolutionTest : public ::testing::Test {
+protected:
+    RecursiveConvolutionTest() {
+        poles = {-1e3, Complex(-2e2, 3e3), Complex(-2e2, -3e3)};
+        MatrixXcd R0(2,2), R1(2,2);
+        R0 << 5e2, 1e2,
+              1e2, 3e2;
+        R1 << Complex(1e2, 4e2), Complex(-2e1, 1e1),
+              Complex(-2e1, 1e1), Complex(3e2, -1e2);
+        residues = {R0, R1, R1.conjugate()};
+        D = MatrixXcd(2,2);
+        D << 2.0, -0.5,
+            -0.5, 1.0;
+        E = MatrixXcd(2,2);
+        E << 1e-4, 0.0,
+             0.0,  2e-4;
+    }
+
+    // Current of the model at time t for the input v(t) = a t.
+    Vector2d rampCurrent(const Vector2d& a, const Real t) const {
+        Vector2cd res = D * a * t + E * a;
+        for (size_t k = 0; k < poles.size(); ++k) {
+            const Complex& p = poles[k];
+            res += residues[k] * a * ((exp(p*t) - 1.0 - p*t) / (p*p));
+        }
+        return res.real();
+    }
+
+    // Current of the model at time t for the input v(t) = a sin(w t).
+    Vector2d sineCurrent(const Vector2d& a, const Real w, const Real t) const {
+        Vector2cd res = D * a * sin(w*t) + E * a * w * cos(w*t);
+        for (size_t k = 0; k < poles.size(); ++k) {
+            const Complex& p = poles[k];
+            const Complex jw(0.0, w);
+            const Complex psi =
+                    ((exp(jw*t) - exp(p*t)) / (jw - p) -
+                     (exp(-jw*t) - exp(p*t)) / (-jw - p)) / Complex(0.0, 2.0);
+            res += residues[k] * a * psi;
+        }
+        return res.real();
+    }
+
+    vector<Complex> poles;
+    vector<MatrixXcd> residues;
+    MatrixXcd D, E;
+};
+
+TEST_F(RecursiveConvolutionTest, ramp) {
+    const size_t nCells = 5;
+    const Real dt = 1e-5;
+    RecursiveConvolution conv(poles, residues, D, E, dt, nCells);
+    EXPECT_EQ(2, conv.getNumberOfPorts());
+    EXPECT_EQ(nCells, conv.getNumberOfCells());
+
+    vector<Real> v(2*nCells), i(2*nCells), h(2*nCells);
+    for (size_t n = 1; n <= 1000; ++n) {
+        const Real t = n * dt;
+        for (size_t c = 0; c < nCells; ++c) {
+            v[c]          = (c+1) * t;
+            v[nCells + c] = -0.5 * (c+1) * t;
+        }
+
+        conv.history(h.data());
+        conv.step(v.data(), i.data());
+
+        for (size_t c = 0; c < nCells; ++c) {
+            Vector2d vc, hc, ic;
+            vc << v[c], v[nCells + c];
+            hc << h[c], h[nCells + c];
+            ic << i[c], i[nCells + c];
+            Vector2d a;
+            a << (c+1), -0.5 * (c+1);
+
+            // Piecewise linear convolution is exact for a ramp.
+            const Vector2d expected = rampCurrent(a, t);
+            EXPECT_NEAR(0.0, (ic - expected).norm(), 1e-9*expected.norm());
+            const Vector2d split = conv.getConductance() * vc + hc;
+            EXPECT_NEAR(0.0, (ic - split).norm(), 1e-12*ic.norm());
+        }
+    }
+}
+
+TEST_F(RecursiveConvolutionTest, sine) {
+    const Real dt = 1e-6;
+    const Real w = 2*M_PI*500.0;
+    RecursiveConvolution conv(poles, residues, D, E, dt);
+
+    Vector2d a;
+    a << 1.0, 0.3;
+    vector<Real> v(2), i(2);
+    Real maxError = 0.0, maxCurrent = 0.0;
+    for (size_t n = 1; n <= 4000; ++n) {
+        const Real t = n * dt;
+        v[0] = a(0) * sin(w*t);
+        v[1] = a(1) * sin(w*t);
+        conv.step(v.data(), i.data());
+
+        const Vector2d expected = sineCurrent(a, w, t);
+        maxError = max(maxError, max(abs(i[0] - expected(0)),
+                                     abs(i[1] - expected(1))));
+        maxCurrent = max(maxCurrent, expected.cwiseAbs().maxCoeff());
+    }
+    EXPECT_LT(maxError, 1e-3 * maxCurrent);
+
+    conv.reset();
+    conv.step(v.data(), i.data());
+    vector<Real> fresh(2);
+    RecursiveConvolution(poles, residues, D, E, dt).step(v.data(), fresh.data());
+    EXPECT_EQ(fresh, i);
+}
+
+TEST_F(RecursiveConvolutionTest, unpairedPole) {
+    vector<Complex> p = {Complex(-1.0, 1.0)};
+    vector<MatrixXcd> r(1, MatrixXcd::Identity(2,2));
+    EXPECT_THROW(RecursiveConvolution(p, r, D, E, 1e-3), std::runtime_error);
+}
@@ -0,0 +1,125 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Alejandro García Montoro        (alejandro.garciamontoro@gmail.com)
+//					  Alejandra López de Aberasturi Gómez (aloaberasturi@ugr.es)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+#include "gtest/gtest.h"
+
+#include "Fitting.h"
+#include "SecularSolver.h"
+
+using namespace VectorFitting;
+using namespace std;
+
+class SecularSolverTest : public ::testing::Test {
+protected:
+    // Zeros of sigma computed as eigenvalues of the dense ZER matrix.
+    static vector<Complex> denseZeros(const vector<Complex>& p,
+                                      const vector<Complex>& r,
+                                      const Real d) {
+        const size_t N = p.size();
+        MatrixXcd ZER = MatrixXcd::Zero(N,N);
+        for (size_t i = 0; i < N; ++i) {
+            ZER(i,i) = p[i];
+            for (size_t j = 0; j < N; ++j) {
+                ZER(i,j) -= r[j] / d;
+            }
+        }
+        return Fitting::toStdVector(
+                VectorXcd(ComplexEigenSolver<MatrixXcd>(ZER).eigenvalues()));
+    }
+
+    static void expectSameZeros(const vector<Complex>& expected,
+                                const vector<Complex>& obtained,
+                                const Real tol) {
+        ASSERT_EQ(expected.size(), obtained.size());
+        vector<bool> used(obtained.size(), false);
+        for (size_t i = 0; i < expected.size(); ++i) {
+            size_t best = obtained.size();
+            Real bestDist = numeric_limits<Real>::max();
+            for (size_t j = 0; j < obtained.size(); ++j) {
+                if (!used[j] && abs(expected[i] - obtained[j]) < bestDist) {
+                    bestDist = abs(expected[i] - obtained[j]);
+                    best = j;
+                }
+            }
+            ASSERT_LT(best, obtained.size());
+            used[best] = true;
+            EXPECT_NEAR(0.0, bestDist / abs(expected[i]), tol);
+        }
+    }
+};
+
+TEST_F(SecularSolverTest, realPoles) {
+    vector<Complex> p = {-1.0, -10.0, -100.0, -1000.0};
+    vector<Complex> r = {0.5, -2.0, 30.0, 400.0};
+    const Real d = 1.3;
+
+    SecularSolver solver(p, r, d);
+    ASSERT_TRUE(solver.solve());
+    expectSameZeros(denseZeros(p, r, d), solver.getZeros(), 1e-10);
+}
+
+TEST_F(SecularSolverTest, complexPoles) {
+    vector<Complex> p, r;
+    const size_t nPairs = 40;
+    for (size_t k = 0; k < nPairs; ++k) {
+        const Real imag = 1e3 * (Real) (k+1);
+        p.push_back(Complex(-1e-2*imag, -imag));
+        p.push_back(Complex(-1e-2*imag, +imag));
+        const Complex res(1e2 * std::cos((Real) k), 1e2 * std::sin((Real) k));
+        r.push_back(res);
+        r.push_back(std::conj(res));
+    }
+    p.push_back(-5e2);
+    r.push_back(7e1);
+    const Real d = 0.8;
+
+    SecularSolver solver(p, r, d);
+    ASSERT_TRUE(solver.solve());
+    const vector<Complex>& zeros = solver.getZeros();
+    expectSameZeros(denseZeros(p, r, d), zeros, 1e-8);
+
+    // Zeros come as exact conjugated pairs or exactly real.
+    for (size_t i = 0; i < zeros.size(); ++i) {
+        if (zeros[i].imag() != 0.0) {
+            EXPECT_EQ(1, count(zeros.begin(), zeros.end(), conj(zeros[i])));
+        }
+    }
+}
+
+TEST_F(SecularSolverTest, deflation) {
+    vector<Complex> p = {-1.0, -2.0, Complex(-3.0, -40.0), Complex(-3.0, 40.0)};
+    vector<Complex> r = {0.0, 1.0, 0.0, 0.0};
+
+    SecularSolver solver(p, r, 1.0);
+    ASSERT_TRUE(solver.solve());
+    vector<Complex> zeros = solver.getZeros();
+    ASSERT_EQ(4, zeros.size());
+    EXPECT_EQ(1, count(zeros.begin(), zeros.end(), Complex(-1.0, 0.0)));
+    EXPECT_EQ(1, count(zeros.begin(), zeros.end(), Complex(-3.0, -40.0)));
+    EXPECT_EQ(1, count(zeros.begin(), zeros.end(), Complex(-3.0,  40.0)));
+    EXPECT_EQ(1, count(zeros.begin(), zeros.end(), Complex(-3.0,  0.0)));
+}
+
+TEST_F(SecularSolverTest, zeroConstantTerm) {
+    SecularSolver solver({-1.0}, {1.0}, 0.0);
+    EXPECT_FALSE(solver.solve());
+}
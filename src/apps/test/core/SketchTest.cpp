@@ -0,0 +1,122 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Alejandro García Montoro        (alejandro.garciamontoro@gmail.com)
+//					  Alejandra López de Aberasturi Gómez (aloaberasturi@ugr.es)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+#include "gtest/gtest.h"
+
+#include "GeneratedSamples.h"
+#include "Sketch.h"
+
+#include <random>
+
+using namespace VectorFitting;
+using namespace std;
+
+class SketchTest : public ::testing::Test {
+protected:
+    static MatrixXd buildMatrix(const Index rows,
+                                const Index cols,
+                                const unsigned long seed) {
+        mt19937_64 engine(seed);
+        normal_distribution<Real> normal;
+        MatrixXd res(rows, cols);
+        for (Index i = 0; i < res.size(); ++i) {
+            res(i) = normal(engine);
+        }
+        // Columns of very different norms.
+        for (Index j = 0; j < cols; ++j) {
+            res.col(j) *= pow(10.0, (Real) (j % 7) - 3.0);
+        }
+        return res;
+    }
+};
+
+TEST_F(SketchTest, apply) {
+    const MatrixXd A = buildMatrix(2000, 10, 1);
+    const Sketch sketch(A.rows(), Sketch::sketchRows(A.cols()), 5);
+    EXPECT_EQ(2000, sketch.getRows());
+    EXPECT_EQ(80, sketch.getSketchRows());
+
+    // Same seed, same sketch.
+    const MatrixXd SA = sketch.apply(A);
+    EXPECT_EQ(SA, sketch.apply(A));
+    EXPECT_EQ(SA.col(3), sketch.apply(A.col(3)));
+
+    const VectorXd x = VectorXd::Ones(A.cols());
+    const Real ratio = (SA * x).norm() / (A * x).norm();
+    EXPECT_GT(ratio, 0.5);
+    EXPECT_LT(ratio, 2.0);
+
+    EXPECT_THROW(sketch.apply(A.topRows(10)), std::runtime_error);
+}
+
+TEST_F(SketchTest, solve) {
+    const MatrixXd A = buildMatrix(5000, 20, 2);
+    const VectorXd b = A * VectorXd::LinSpaced(A.cols(), 1.0, 2.0) +
+            1e-3 * buildMatrix(A.rows(), 1, 3);
+    const VectorXd exact = A.householderQr().solve(b);
+
+    bool fallback = true;
+    const VectorXd x = Sketch::solve(A, b, 4, &fallback);
+    EXPECT_FALSE(fallback);
+    EXPECT_LT((x - exact).norm(), 1e-10 * exact.norm());
+}
+
+TEST_F(SketchTest, fallback) {
+    // Too few rows to pay off.
+    bool fallback = false;
+    const MatrixXd small = buildMatrix(100, 20, 5);
+    const VectorXd b = VectorXd::Ones(small.rows());
+    Sketch::solve(small, b, 6, &fallback);
+    EXPECT_TRUE(fallback);
+
+    // Singular triangular factor.
+    MatrixXd A = buildMatrix(5000, 20, 7);
+    A.col(4) = A.col(3);
+    fallback = false;
+    Sketch::solve(A, VectorXd::Ones(A.rows()), 8, &fallback);
+    EXPECT_TRUE(fallback);
+}
+
+TEST_F(SketchTest, fitting) {
+    const vector<Fitting::Sample> samples = packSamples(
+            buildSamples(8, 2, 2000, 0, make_pair(1e3, 1e7), 1e-4));
+
+    Options opts;
+    opts.setN(8);
+    opts.setPolesType(Options::PolesType::logcmplx);
+    const vector<Complex> poles = Driver::buildPoles(samples, opts);
+
+    Fitting exact(samples, opts, poles);
+    opts.setSketching(true);
+    Fitting sketched(samples, opts, poles);
+    for (size_t i = 0; i < 5; ++i) {
+        exact.fit();
+        sketched.fit();
+    }
+
+    // Relocation solves the sketched problem, which is close but not equal.
+    EXPECT_NEAR(exact.getRMSE(), sketched.getRMSE(), 5e-2 * exact.getRMSE());
+    for (size_t m = 0; m < poles.size(); ++m) {
+        EXPECT_LT(abs(exact.getPoles()[m] - sketched.getPoles()[m]),
+                  1e-4 * abs(exact.getPoles()[m]));
+    }
+}
@@ -0,0 +1,131 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Alejandro García Montoro        (alejandro.garciamontoro@gmail.com)
+//					  Alejandra López de Aberasturi Gómez (aloaberasturi@ugr.es)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+#include "gtest/gtest.h"
+
+#include "GeneratedSamples.h"
+#include "Sweep.h"
+
+using namespace VectorFitting;
+using namespace std;
+
+class SweepTest : public ::testing::Test {
+protected:
+    // A generated model whose resonances shift along the sweep.
+    static vector<Driver::Sample> shiftedSamples(const Real shift) {
+        const Generator generator = buildGenerator(4, 2, 300);
+
+        const vector<Complex>& poles = generator.getPoles();
+        const vector<MatrixXcd>& residues = generator.getResidues();
+        const vector<Real> freq = generator.getFrequencies();
+        vector<Driver::Sample> samples;
+        for (size_t i = 0; i < freq.size(); ++i) {
+            const Complex s(0.0, freq[i]);
+            MatrixXcd data = generator.getD() + s * generator.getE();
+            for (size_t m = 0; m < poles.size(); ++m) {
+                const Complex p(poles[m].real(),
+                                poles[m].imag() * (1.0 + shift));
+                data += residues[m] / (s - p);
+            }
+            samples.push_back({s, data});
+        }
+        return samples;
+    }
+};
+
+TEST_F(SweepTest, warmStartedChains) {
+    const size_t nPoints = 6;
+    vector<vector<Driver::Sample>> datasets;
+    for (size_t t = 0; t < nPoints; ++t) {
+        datasets.push_back(shiftedSamples(0.02 * t));
+    }
+    Options opts;
+    opts.setN(4);
+    opts.setIterations({4,6});
+
+    Sweep sweep(datasets, opts, 2);
+    ASSERT_EQ(nPoints, sweep.size());
+    EXPECT_EQ(2, sweep.getNumberOfChains());
+
+    for (size_t t = 0; t < nPoints; ++t) {
+        const Driver& model = sweep.getModel(t);
+        EXPECT_LT(model.getRMSE(), 1e-6);
+        if (t == 0) {
+            EXPECT_EQ(opts.getIterations(), model.getPerformedIterations());
+        } else {
+            EXPECT_EQ(0, model.getPerformedIterations().first);
+            EXPECT_LT(model.getPerformedIterations().second,
+                      opts.getIterations().second);
+        }
+    }
+
+    const vector<vector<Complex>>& poles = sweep.getPoles();
+    ASSERT_EQ(nPoints, poles.size());
+    for (size_t t = 1; t < nPoints; ++t) {
+        ASSERT_EQ(4, poles[t].size());
+        for (size_t k = 0; k < poles[t].size(); ++k) {
+            EXPECT_LT(abs(poles[t][k] - poles[t-1][k]),
+                      0.05 * abs(poles[t-1][k]));
+        }
+    }
+}
+
+TEST_F(SweepTest, defaultChains) {
+    vector<vector<Driver::Sample>> datasets;
+    for (size_t t = 0; t < 2 * Sweep::minChainLength - 1; ++t) {
+        datasets.push_back(shiftedSamples(0.02 * t));
+    }
+    Options opts;
+    opts.setN(4);
+    opts.setIterations({4,0});
+
+    Sweep sweep(datasets, opts);
+    EXPECT_EQ(1, sweep.getNumberOfChains());
+    for (size_t t = 1; t < sweep.size(); ++t) {
+        EXPECT_EQ(make_pair((size_t) 0, (size_t) 1),
+                  sweep.getModel(t).getPerformedIterations());
+    }
+}
+
+TEST_F(SweepTest, match) {
+    vector<Complex> reference = {Complex(-1.0, 10.0), Complex(-1.0, -10.0),
+                                 Complex(-2.0, 20.0), Complex(-2.0, -20.0)};
+    vector<Complex> poles = {Complex(-2.1, -20.5), Complex(-2.1, 20.5),
+                             Complex(-1.1, 10.2), Complex(-1.1, -10.2)};
+    vector<Complex> matched = Sweep::match(reference, poles);
+    EXPECT_EQ(poles[2], matched[0]);
+    EXPECT_EQ(poles[3], matched[1]);
+    EXPECT_EQ(poles[1], matched[2]);
+    EXPECT_EQ(poles[0], matched[3]);
+}
+
+TEST_F(SweepTest, matchKeepsConjugatePairs) {
+    // The real pole of reference is closest to a member of the pair.
+    vector<Complex> reference = {Complex(-1.0, 0.0),
+                                 Complex(-50.0, 50.0), Complex(-50.0, -50.0)};
+    vector<Complex> poles = {Complex(-1.0, -2.0), Complex(-1.0, 2.0),
+                             Complex(-50.0, 0.0)};
+    vector<Complex> matched = Sweep::match(reference, poles);
+    EXPECT_EQ(poles[2], matched[0]);
+    EXPECT_EQ(poles[1], matched[1]);
+    EXPECT_EQ(poles[0], matched[2]);
+}
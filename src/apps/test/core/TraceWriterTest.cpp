@@ -0,0 +1,178 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Alejandro García Montoro        (alejandro.garciamontoro@gmail.com)
+//					  Alejandra López de Aberasturi Gómez (aloaberasturi@ugr.es)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+#include "gtest/gtest.h"
+
+#include "Driver.h"
+#include "GeneratedSamples.h"
+#include "TraceWriter.h"
+
+#include <sstream>
+
+using namespace VectorFitting;
+using namespace std;
+
+class TraceWriterTest : public ::testing::Test {
+protected:
+    class Recorder : public Observer {
+    public:
+        explicit Recorder(const bool rmse = false) : rmse_(rmse) {}
+        void observe(const Trace& trace) {traces.push_back(trace);}
+        bool isRMSERequired() const {return rmse_;}
+        vector<Trace> traces;
+    private:
+        bool rmse_;
+    };
+
+    // Symmetric responses with two pairs of poles.
+    static vector<Driver::Sample> portSamples(const size_t Nc) {
+        return buildSamples(4, Nc, 200, 0, make_pair(1e2, 1e6));
+    }
+
+    static Options buildOptions() {
+        Options opts;
+        opts.setN(4);
+        opts.setPolesType(Options::PolesType::logcmplx);
+        opts.setIterations({2, 3});
+        return opts;
+    }
+};
+
+TEST_F(TraceWriterTest, fitting) {
+    vector<Fitting::Sample> samples;
+    for (const Driver::Sample& sample : portSamples(1)) {
+        samples.push_back(Fitting::Sample(sample.first, sample.second.col(0)));
+    }
+    const Options opts = buildOptions();
+    Recorder recorder;
+    Control control;
+    control.setObserver(&recorder);
+
+    Fitting fitting(samples, opts, Driver::buildPoles(samples, opts));
+    fitting.setControl(&control);
+    for (size_t i = 0; i < 3; ++i) {
+        fitting.fit();
+    }
+
+    ASSERT_EQ(3, recorder.traces.size());
+    for (size_t i = 0; i < 3; ++i) {
+        const Trace& trace = recorder.traces[i];
+        EXPECT_EQ(Control::Stage::relocation, trace.stage);
+        EXPECT_EQ(i+1, trace.iteration);
+        EXPECT_EQ(samples.size(), trace.samples);
+        EXPECT_EQ(1, trace.responses);
+        EXPECT_EQ(4, trace.order);
+        EXPECT_TRUE(std::isfinite(trace.sigmaConstant));
+        EXPECT_GE(trace.condition, 1.0);
+        EXPECT_TRUE(std::isfinite(trace.poleShift));
+        EXPECT_EQ(0, trace.flippedPoles);
+        EXPECT_GE(trace.seconds, 0.0);
+    }
+    EXPECT_DOUBLE_EQ(fitting.getRMSE(), recorder.traces.back().rmse);
+    EXPECT_LT(recorder.traces.back().rmse, recorder.traces.front().rmse);
+    EXPECT_LT(recorder.traces.back().poleShift, 1e-6);
+}
+
+TEST_F(TraceWriterTest, driverStages) {
+    const vector<Driver::Sample> samples = portSamples(2);
+    const Options opts = buildOptions();
+    Recorder recorder(true);
+    Control control;
+    control.setObserver(&recorder);
+
+    Driver observed(samples, opts, {}, {}, &control);
+    Driver driver(samples, opts);
+
+    const pair<size_t, size_t> performed = observed.getPerformedIterations();
+    ASSERT_EQ(performed.first + performed.second, recorder.traces.size());
+    for (size_t i = 0; i < recorder.traces.size(); ++i) {
+        const Trace& trace = recorder.traces[i];
+        if (i < performed.first) {
+            EXPECT_EQ(Control::Stage::relocationOfSum, trace.stage);
+            EXPECT_EQ(i+1, trace.iteration);
+            EXPECT_EQ(1, trace.responses);
+        } else {
+            EXPECT_EQ(Control::Stage::relocation, trace.stage);
+            EXPECT_EQ(3, trace.responses);
+        }
+        EXPECT_TRUE(std::isfinite(trace.rmse));
+    }
+
+    // Reporting the error does not change the model.
+    ASSERT_EQ(driver.getPoles().size(), observed.getPoles().size());
+    for (size_t i = 0; i < driver.getPoles().size(); ++i) {
+        EXPECT_EQ(driver.getPoles()[i], observed.getPoles()[i]);
+    }
+    EXPECT_EQ(driver.getRMSE(), observed.getRMSE());
+}
+
+TEST_F(TraceWriterTest, driverWithoutRMSE) {
+    Recorder recorder;
+    Control control;
+    control.setObserver(&recorder);
+    Driver(portSamples(2), buildOptions(), {}, {}, &control);
+
+    // Relocations skip residue identification unless the error is asked,
+    // only the last one identifies the residues of the model.
+    ASSERT_GT(recorder.traces.size(), 1);
+    for (size_t i = 0; i+1 < recorder.traces.size(); ++i) {
+        EXPECT_TRUE(std::isnan(recorder.traces[i].rmse));
+        EXPECT_TRUE(std::isfinite(recorder.traces[i].poleShift));
+    }
+    EXPECT_TRUE(std::isfinite(recorder.traces.back().rmse));
+}
+
+TEST_F(TraceWriterTest, json) {
+    Trace trace;
+    trace.stage = Control::Stage::relocationOfSum;
+    trace.iteration = 2;
+    trace.samples = 100;
+    trace.responses = 3;
+    trace.order = 8;
+    trace.fixedConstant = 1.0;
+    trace.flippedPoles = 1;
+    trace.rmse = 0.25;
+
+    EXPECT_EQ("{\"stage\":\"relocationOfSum\",\"iteration\":2,"
+              "\"samples\":100,\"responses\":3,\"order\":8,"
+              "\"sigmaConstant\":null,\"fixedConstant\":1,"
+              "\"condition\":null,\"poleShift\":null,\"flippedPoles\":1,"
+              "\"rmse\":0.25,\"seconds\":0}",
+              TraceWriter::toJSON(trace));
+
+    std::ostringstream out;
+    {
+        TraceWriter writer(out);
+        Control control;
+        control.setObserver(&writer);
+        Driver(portSamples(2), buildOptions(), {}, {}, &control);
+    }
+    std::istringstream in(out.str());
+    std::string line;
+    size_t lines = 0;
+    while (std::getline(in, line)) {
+        EXPECT_EQ('{', line.front());
+        EXPECT_EQ('}', line.back());
+        ++lines;
+    }
+    EXPECT_GT(lines, 0);
+}
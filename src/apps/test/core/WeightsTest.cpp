@@ -0,0 +1,194 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Alejandro García Montoro        (alejandro.garciamontoro@gmail.com)
+//					  Alejandra López de Aberasturi Gómez (aloaberasturi@ugr.es)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+#include "gtest/gtest.h"
+
+#include "Driver.h"
+#include "GeneratedSamples.h"
+#include "Weights.h"
+
+using namespace VectorFitting;
+using namespace std;
+
+class WeightsTest : public ::testing::Test {};
+
+TEST_F(WeightsTest, modes) {
+    EXPECT_TRUE(Weights().isUniform());
+    EXPECT_TRUE(Weights({}, 3).isUniform());
+
+    vector<VectorXd> perSample(2, VectorXd::Constant(1, 2.0));
+    Weights w1(perSample, 3);
+    EXPECT_EQ(Weights::Mode::perSample, w1.getMode());
+    EXPECT_EQ(2, w1.getSamplesSize());
+    EXPECT_EQ(2.0, w1(1,2));
+
+    vector<VectorXd> mixed = {VectorXd::Constant(1, 2.0),
+                              VectorXd::LinSpaced(3, 1.0, 3.0)};
+    Weights w2(mixed, 3);
+    EXPECT_EQ(Weights::Mode::perElement, w2.getMode());
+    EXPECT_EQ(2.0, w2(0,1));
+    EXPECT_EQ(3.0, w2(1,2));
+
+    EXPECT_THROW(Weights(vector<VectorXd>(1, VectorXd::Ones(2)), 3),
+                 std::runtime_error);
+
+    MatrixXd A = MatrixXd::Ones(4, 2);
+    Weights().scaleRows(A, 0, 0);
+    EXPECT_EQ(MatrixXd::Ones(4, 2), A);
+    w2.scaleRows(A, 2, 2);
+    EXPECT_EQ(1.0, A(1,0));
+    EXPECT_EQ(2.0, A(2,0));
+    EXPECT_EQ(3.0, A(3,1));
+
+    Weights sub = w2.subset({1});
+    EXPECT_EQ(1, sub.getSamplesSize());
+    EXPECT_EQ(3.0, sub(0,2));
+}
+
+TEST_F(WeightsTest, build) {
+    vector<Fitting::Sample> samples = packSamples(buildSamples(4, 2, 100));
+    const Fitting::Sample& s = samples[10];
+
+    EXPECT_TRUE(Weights::build(samples, Options::Weighting::one).isUniform());
+
+    Weights abs = Weights::build(samples, Options::Weighting::oneOverAbs);
+    EXPECT_EQ(Weights::Mode::perElement, abs.getMode());
+    EXPECT_DOUBLE_EQ(1.0 / std::abs(s.second(1)), abs(10,1));
+
+    Weights sqrtAbs =
+            Weights::build(samples, Options::Weighting::oneOverSqrtAbs);
+    EXPECT_DOUBLE_EQ(1.0 / sqrt(std::abs(s.second(2))), sqrtAbs(10,2));
+
+    Weights norm = Weights::build(samples, Options::Weighting::oneOverNorm);
+    EXPECT_EQ(Weights::Mode::perSample, norm.getMode());
+    EXPECT_DOUBLE_EQ(1.0 / s.second.norm(), norm(10,0));
+
+    Weights sqrtNorm =
+            Weights::build(samples, Options::Weighting::oneOverSqrtNorm);
+    EXPECT_DOUBLE_EQ(1.0 / sqrt(s.second.norm()), sqrtNorm(10,2));
+}
+
+TEST_F(WeightsTest, singlePrecision) {
+    MatrixXd values(3, 2);
+    values << 1.0, 0.1, 2.0, 0.2, 3.0, 0.3;
+    const Weights w(values);
+    const Weights single = w.toSinglePrecision();
+    EXPECT_FALSE(w.isSinglePrecision());
+    EXPECT_TRUE(single.isSinglePrecision());
+    EXPECT_EQ(Weights::Mode::perElement, single.getMode());
+    EXPECT_EQ(3, single.getSamplesSize());
+    EXPECT_EQ(2, single.getResponseSize());
+    EXPECT_EQ((Real) 0.2f, single(1,1));
+
+    MatrixXd A = MatrixXd::Ones(3, 2), B = MatrixXd::Ones(3, 2);
+    w.scaleRows(A, 0, 1);
+    single.scaleRows(B, 0, 1);
+    EXPECT_NEAR(0.0, (A - B).norm(), 1e-7);
+
+    const Weights sub = single.subset({2, 0});
+    EXPECT_TRUE(sub.isSinglePrecision());
+    EXPECT_EQ(2, sub.getSamplesSize());
+    EXPECT_EQ(3.0, sub(0,0));
+}
+
+TEST_F(WeightsTest, views) {
+    // Two responses stored interleaved, sample after sample.
+    const vector<Real> data = {1.0, 0.1, 2.0, 0.2, 3.0, 0.3};
+    const Weights w(data.data(), 3, 2, 2, 1);
+    EXPECT_EQ(Weights::Mode::perElement, w.getMode());
+    EXPECT_EQ(3, w.getSamplesSize());
+    EXPECT_EQ(2, w.getResponseSize());
+    EXPECT_EQ(0.2, w(1,1));
+    EXPECT_FALSE(w.toSinglePrecision().isSinglePrecision());
+
+    MatrixXd A = MatrixXd::Ones(4, 2);
+    w.scaleRows(A, 1, 1);
+    EXPECT_EQ(1.0, A(0,0));
+    EXPECT_EQ(0.3, A(3,1));
+
+    const Weights sub = w.subset({2, 0});
+    EXPECT_EQ(2, sub.getSamplesSize());
+    EXPECT_EQ(0.3, sub(0,1));
+    EXPECT_EQ(1.0, sub(1,0));
+
+    // Responses stored one after the other, weights are the same as the
+    // ones built from the samples.
+    vector<Fitting::Sample> samples = packSamples(buildSamples(4, 2, 100));
+    const size_t Ns = samples.size(), Nc = samples.front().second.size();
+    vector<Complex> responses(Ns*Nc);
+    for (size_t i = 0; i < Ns; ++i) {
+        for (size_t n = 0; n < Nc; ++n) {
+            responses[i + n*Ns] = samples[i].second(n);
+        }
+    }
+    for (auto weighting : {Options::Weighting::oneOverAbs,
+                           Options::Weighting::oneOverSqrtAbs,
+                           Options::Weighting::oneOverNorm,
+                           Options::Weighting::oneOverSqrtNorm}) {
+        const Weights expected = Weights::build(samples, weighting);
+        const Weights view =
+                Weights::build(responses.data(), Ns, Nc, 1, Ns, weighting);
+        EXPECT_EQ(expected.getMode(), view.getMode());
+        EXPECT_EQ(Ns, view.getSamplesSize());
+        for (size_t n = 0; n < Nc; ++n) {
+            EXPECT_NEAR(0.0, (expected.column(n) - view.column(n)).norm(),
+                        1e-12 * expected.column(n).norm());
+        }
+    }
+}
+
+TEST_F(WeightsTest, constantWeightsDoNotChangePoles) {
+    vector<Fitting::Sample> samples = packSamples(buildSamples(4, 2, 100));
+    Options opts;
+    opts.setN(2);
+    vector<Complex> poles = Driver::buildPoles(
+            make_pair(samples.front().first.imag(),
+                      samples.back().first.imag()), opts);
+
+    Fitting uniform(samples, opts, poles);
+    uniform.fit();
+    Fitting scaled(samples, opts, poles,
+                   Weights(VectorXd(VectorXd::Constant(samples.size(), 3.0))));
+    scaled.fit();
+
+    vector<Complex> p1 = uniform.getPoles(), p2 = scaled.getPoles();
+    ASSERT_EQ(p1.size(), p2.size());
+    for (size_t i = 0; i < p1.size(); ++i) {
+        EXPECT_NEAR(0.0, std::abs(p1[i] - p2[i]), 1e-6 * std::abs(p1[i]));
+    }
+}
+
+TEST_F(WeightsTest, driverWeightings) {
+    vector<Driver::Sample> samples = buildSamples(4, 2, 100);
+    const vector<Options::Weighting> weightings = {
+            Options::Weighting::oneOverAbs,
+            Options::Weighting::oneOverSqrtAbs,
+            Options::Weighting::oneOverNorm,
+            Options::Weighting::oneOverSqrtNorm};
+    for (size_t w = 0; w < weightings.size(); ++w) {
+        Options opts;
+        opts.setN(4);
+        opts.setWeighting(weightings[w]);
+        Driver driver(samples, opts);
+        EXPECT_LT(driver.getRMSE(), 1e-6);
+    }
+}
@@ -29,6 +29,8 @@ SRC_DIRS := $(SRC_APP_DIR) \
 
 SRCS_CXX := $(shell find $(SRC_DIRS) -maxdepth 1 -type f -name "*.cpp")
 OBJS_CXX := $(addprefix $(OBJ_DIR), $(SRCS_CXX:.cpp=.o))
+SRCS_C   := $(shell find $(SRC_DIRS) -maxdepth 1 -type f -name "*.c")
+OBJS_C   := $(addprefix $(OBJ_DIR), $(SRCS_C:.c=.o))
 # =============================================================================
 LIBS      += gtest pthread
 LIBRARIES += 
@@ -46,7 +48,12 @@ $(OBJ_DIR)%.o: %.cpp
 	@echo "Compiling:" $@
 	$(CXX) $(CXXFLAGS) $(addprefix -D, $(DEFINES)) $(addprefix -I,$(INCLUDES)) -c -o $@ $<
 
-$(BIN_DIR)$(OUT): $(OBJS_CXX)
+$(OBJ_DIR)%.o: %.c
+	@dirname $@ | xargs mkdir -p
+	@echo "Compiling:" $@
+	$(CC) -std=c99 $(CCFLAGS) $(addprefix -D, $(DEFINES)) $(addprefix -I,$(INCLUDES)) -c -o $@ $<
+
+$(BIN_DIR)$(OUT): $(OBJS_CXX) $(OBJS_C)
 	@mkdir -p $(BIN_DIR)
 	@echo "Linking:" $@
 	${CXX} $^ \
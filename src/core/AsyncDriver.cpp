@@ -0,0 +1,79 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Alejandro García Montoro        (alejandro.garciamontoro@gmail.com)
+//					  Alejandra López de Aberasturi Gómez (aloaberasturi@ugr.es)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+#include "AsyncDriver.h"
+
+namespace VectorFitting {
+
+AsyncDriver::AsyncDriver(
+        const std::vector<Driver::Sample>& samples,
+        const Options& options,
+        const std::shared_ptr<Control>& control,
+        const std::vector<Complex>& poles,
+        const std::vector<MatrixXd>& weights) :
+                control_(control) {
+    if (!control_) {
+        throw std::runtime_error("Control can not be null");
+    }
+    std::shared_ptr<Control> ctrl = control_;
+    result_ = std::async(std::launch::async,
+            [samples, options, poles, weights, ctrl]() mutable {
+        return Driver(std::move(samples), options, poles, weights, ctrl.get());
+    });
+}
+
+AsyncDriver::~AsyncDriver() {
+    if (result_.valid()) {
+        control_->cancel();
+        result_.wait();
+    }
+}
+
+void AsyncDriver::cancel() {
+    control_->cancel();
+}
+
+bool AsyncDriver::isReady() const {
+    return waitFor(Control::Clock::duration::zero());
+}
+
+void AsyncDriver::wait() const {
+    if (result_.valid()) {
+        result_.wait();
+    }
+}
+
+bool AsyncDriver::waitFor(const Control::Clock::duration& timeout) const {
+    if (!result_.valid()) {
+        return true;
+    }
+    return result_.wait_for(timeout) == std::future_status::ready;
+}
+
+Driver AsyncDriver::get() {
+    if (!result_.valid()) {
+        throw std::runtime_error("Result has already been retrieved");
+    }
+    return result_.get();
+}
+
+} /* namespace VectorFitting */
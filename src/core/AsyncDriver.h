@@ -0,0 +1,81 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Alejandro García Montoro        (alejandro.garciamontoro@gmail.com)
+//					  Alejandra López de Aberasturi Gómez (aloaberasturi@ugr.es)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef VECTOR_FITTING_ASYNC_DRIVER_H_
+#define VECTOR_FITTING_ASYNC_DRIVER_H_
+
+#include <future>
+#include <memory>
+
+#include "Driver.h"
+
+namespace VectorFitting {
+
+/**
+ * Runs a Driver in a background thread. The handle gives access to the
+ * fitted Driver once ready, and to the Control used to report progress,
+ * cancel, or bound the runtime of the fit.
+ */
+class AsyncDriver {
+public:
+    /**
+     * Starts the fit. Arguments are the same as in Driver. The control must
+     * be configured before being passed, as the fit starts right away.
+     */
+    AsyncDriver(const std::vector<Driver::Sample>& samples,
+                const Options& options,
+                const std::shared_ptr<Control>& control =
+                        std::make_shared<Control>(),
+                const std::vector<Complex>& poles = {},
+                const std::vector<MatrixXd>& weights = {});
+
+    /**
+     * Cancels the fit and waits for the background thread to stop.
+     */
+    ~AsyncDriver();
+
+    void cancel();
+
+    bool isReady() const;
+    void wait() const;
+    bool waitFor(const Control::Clock::duration& timeout) const;
+
+    /**
+     * Blocks until the fit finishes and returns it. Rethrows any exception
+     * raised during the fit, Control::Interrupted if it was cancelled. Can
+     * only be called once.
+     */
+    Driver get();
+
+    Control& control() {return *control_;}
+
+private:
+    std::shared_ptr<Control> control_;
+    std::future<Driver> result_;
+
+    AsyncDriver(const AsyncDriver&);
+    AsyncDriver& operator=(const AsyncDriver&);
+};
+
+} /* namespace VectorFitting */
+
+#endif // VECTOR_FITTING_ASYNC_DRIVER_H_
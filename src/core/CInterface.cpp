@@ -0,0 +1,272 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Alejandro García Montoro        (alejandro.garciamontoro@gmail.com)
+//					  Alejandra López de Aberasturi Gómez (aloaberasturi@ugr.es)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+#include "CInterface.h"
+
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include "Driver.h"
+
+using namespace VectorFitting;
+
+namespace {
+
+thread_local std::string lastError;
+
+// Size of the options of the first version with a size field, older
+// callers may not pass fewer bytes.
+const size_t minOptionsSize =
+        offsetof(vf_options, multiResolution) + sizeof(int);
+
+bool isSupported(const vf_options* options) {
+    return options != nullptr &&
+           options->size >= minOptionsSize &&
+           options->size <= sizeof(vf_options);
+}
+
+vf_options defaultOptions() {
+    const Options defaults;
+    vf_options res;
+    res.size            = sizeof(vf_options);
+    res.order           = defaults.getN();
+    res.iterationsOfSum = defaults.getIterations().first;
+    res.iterations      = defaults.getIterations().second;
+    res.polesType       = static_cast<int>(defaults.getPolesType());
+    res.asymptoticTrend = static_cast<int>(defaults.getAsymptoticTrend());
+    res.weighting       = static_cast<int>(defaults.getWeighting());
+    res.relax           = defaults.isRelax() ? 1 : 0;
+    res.stable          = defaults.isStable() ? 1 : 0;
+    res.poleTolerance   = defaults.getPoleTolerance();
+    res.multiResolution = defaults.isMultiResolution() ? 1 : 0;
+    return res;
+}
+
+Options toOptions(const vf_options& in) {
+    if (in.polesType < VF_POLES_LINCMPLX || in.polesType > VF_POLES_LOEWNER) {
+        throw std::invalid_argument("Unknown type of starting poles");
+    }
+    if (in.asymptoticTrend < VF_TREND_ZERO ||
+            in.asymptoticTrend > VF_TREND_LINEAR) {
+        throw std::invalid_argument("Unknown asymptotic trend");
+    }
+    if (in.weighting < VF_WEIGHTING_ONE ||
+            in.weighting > VF_WEIGHTING_ONE_OVER_SQRT_NORM) {
+        throw std::invalid_argument("Unknown weighting");
+    }
+    if (in.order == 0) {
+        throw std::invalid_argument("Order cannot be zero");
+    }
+    if (in.iterationsOfSum == 0 && in.iterations == 0) {
+        throw std::invalid_argument("No iterations to perform");
+    }
+    Options res;
+    res.setN(in.order);
+    res.setIterations({in.iterationsOfSum, in.iterations});
+    res.setPolesType(static_cast<Options::PolesType>(in.polesType));
+    res.setAsymptoticTrend(
+            static_cast<Options::AsymptoticTrend>(in.asymptoticTrend));
+    res.setWeighting(static_cast<Options::Weighting>(in.weighting));
+    res.setRelax(in.relax != 0);
+    res.setStable(in.stable != 0);
+    res.setPoleTolerance(in.poleTolerance);
+    res.setMultiResolution(in.multiResolution != 0);
+    // Residues are returned in complex form.
+    res.setComplexSpaceState(true);
+    res.setSkipResidueIdentification(true);
+    return res;
+}
+
+/**
+ * Relocates the poles with the sum of the responses and then with all of
+ * them, with the stages of Driver, and identifies the residues in the last
+ * iteration.
+ */
+Fitting fit(const std::vector<Complex>& s,
+            const Fitting::ResponseView& view,
+            const Options& opts,
+            const double* weights,
+            const std::ptrdiff_t weightSampleStride,
+            const std::ptrdiff_t weightStride) {
+    const size_t Ns = s.size();
+    const size_t Nr = view.responses;
+
+    std::vector<Fitting::Sample> fSum, spectrum;
+    fSum.reserve(Ns);
+    spectrum.reserve(Ns);
+    for (size_t i = 0; i < Ns; ++i) {
+        Complex sum = 0.0;
+        Real norm = 0.0;
+        for (size_t n = 0; n < Nr; ++n) {
+            const Complex f = view(i, n);
+            sum += f;
+            norm += std::norm(f);
+        }
+        fSum.push_back(Fitting::Sample(s[i], VectorXcd::Constant(1, sum)));
+        spectrum.push_back(Fitting::Sample(s[i],
+                VectorXcd::Constant(1, std::sqrt(norm))));
+    }
+
+    // Given and absolute weights are read in place.
+    const Weights allWeights = (weights != nullptr) ?
+            Weights(weights, Ns, Nr, weightSampleStride, weightStride) :
+            Weights::build(view.data, Ns, Nr,
+                           view.sampleStride, view.responseStride,
+                           opts.getWeighting());
+    const Weights sumWeights = Driver::buildSumWeights(allWeights,
+            weights != nullptr, fSum, opts.getWeighting());
+
+    // The Loewner pencil is built with the sum, the other types only need
+    // the norm of the responses.
+    std::vector<Complex> poles = Driver::buildPoles(
+            (opts.getPolesType() == Options::PolesType::loewner) ?
+                    fSum : spectrum,
+            opts);
+    const size_t nFirst  = opts.getIterations().first;
+    const size_t nSecond = opts.getIterations().second;
+    const std::vector<size_t> schedule =
+            Driver::buildSchedule(Ns, nFirst + nSecond, opts);
+
+    size_t performed = 0;
+    Fitting fitting1(fSum, opts, poles, sumWeights);
+    Driver::relocateStage(fitting1,
+            std::vector<size_t>(schedule.begin(), schedule.begin() + nFirst),
+            poles, false, nullptr, Control::Stage::relocationOfSum,
+            false, performed);
+
+    Fitting fitting2(s, view, opts, poles, allWeights);
+    if (nSecond == 0) {
+        fitting2.options().setSkipPoleIdentification(true);
+        fitting2.options().setSkipResidueIdentification(false);
+        fitting2.fit();
+    } else {
+        Driver::relocateStage(fitting2,
+                std::vector<size_t>(schedule.begin() + nFirst, schedule.end()),
+                poles, true, nullptr, Control::Stage::relocation,
+                false, performed);
+    }
+    return fitting2;
+}
+
+}
+
+extern "C" {
+
+int vf_default_options(vf_options* options) {
+    if (!isSupported(options)) {
+        return VF_INVALID_INPUT;
+    }
+    const vf_options defaults = defaultOptions();
+    std::memcpy((char*) options + sizeof(size_t),
+                (const char*) &defaults + sizeof(size_t),
+                options->size - sizeof(size_t));
+    return VF_OK;
+}
+
+int vf_fit(const vf_options* options,
+           size_t Ns,
+           size_t Nr,
+           const double* frequencies,
+           ptrdiff_t frequencyStride,
+           const double* responses,
+           ptrdiff_t responseSampleStride,
+           ptrdiff_t responseStride,
+           const double* weights,
+           ptrdiff_t weightSampleStride,
+           ptrdiff_t weightStride,
+           double* poles,
+           double* residues,
+           double* D,
+           double* E,
+           double* rmse) {
+    lastError.clear();
+    try {
+        if (options == nullptr || frequencies == nullptr ||
+                responses == nullptr || poles == nullptr ||
+                residues == nullptr) {
+            throw std::invalid_argument("Missing input or output array");
+        }
+        if (Ns == 0 || Nr == 0) {
+            throw std::invalid_argument("Samples size cannot be zero");
+        }
+        if (!isSupported(options)) {
+            throw std::invalid_argument("Unsupported size of options");
+        }
+        // Fields unknown to the caller keep their defaults.
+        vf_options given = defaultOptions();
+        std::memcpy(&given, options, options->size);
+        const Options opts = toOptions(given);
+
+        std::vector<Complex> s(Ns);
+        for (size_t i = 0; i < Ns; ++i) {
+            s[i] = Complex(0.0,
+                           frequencies[(std::ptrdiff_t) i*frequencyStride]);
+            if (i > 0 && !(s[i].imag() > s[i-1].imag())) {
+                throw std::invalid_argument(
+                        "Frequencies must be in increasing order");
+            }
+        }
+
+        // std::complex<double> has the layout of two doubles.
+        Fitting::ResponseView view;
+        view.data = reinterpret_cast<const Complex*>(responses);
+        view.responses = Nr;
+        view.sampleStride = responseSampleStride;
+        view.responseStride = responseStride;
+
+        const Fitting fitting = fit(s, view, opts,
+                                    weights, weightSampleStride, weightStride);
+
+        const size_t N = opts.getN();
+        Map<VectorXcd>(reinterpret_cast<Complex*>(poles), N) =
+                Fitting::toEigenVector(fitting.getPoles());
+        Map<MatrixXcd>(reinterpret_cast<Complex*>(residues), Nr, N) =
+                fitting.getC();
+        if (D != nullptr) {
+            Map<VectorXcd>(reinterpret_cast<Complex*>(D), Nr) = fitting.getD();
+        }
+        if (E != nullptr) {
+            Map<VectorXcd>(reinterpret_cast<Complex*>(E), Nr) = fitting.getE();
+        }
+        if (rmse != nullptr) {
+            *rmse = fitting.getRMSE();
+        }
+    } catch (const std::invalid_argument& e) {
+        lastError = e.what();
+        return VF_INVALID_INPUT;
+    } catch (const std::exception& e) {
+        lastError = e.what();
+        return VF_FITTING_FAILED;
+    } catch (...) {
+        lastError = "Unknown error";
+        return VF_FITTING_FAILED;
+    }
+    return VF_OK;
+}
+
+const char* vf_last_error(void) {
+    return lastError.c_str();
+}
+
+}
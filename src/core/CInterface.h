@@ -0,0 +1,144 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Alejandro García Montoro        (alejandro.garciamontoro@gmail.com)
+//					  Alejandra López de Aberasturi Gómez (aloaberasturi@ugr.es)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+/*
+ * C interface of the fitter, for callers which keep their samples in their
+ * own arrays, e.g. C or Fortran simulators. Responses and weights are
+ * read in place through strides. Only vectors of Ns values are stored:
+ * the frequencies, the sum and norm of the responses in each sample and
+ * the weights of the sum.
+ *
+ * Complex numbers are pairs of doubles, real part first, as C99 double
+ * complex and Fortran complex(8). Strides are counted in elements, complex
+ * or real, and may be negative. A column-major Ns x Nr Fortran array has
+ * a sample stride of 1 and a response stride of Ns.
+ */
+
+#ifndef VECTOR_FITTING_C_INTERFACE_H_
+#define VECTOR_FITTING_C_INTERFACE_H_
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+enum {
+    VF_OK             = 0,
+    VF_INVALID_INPUT  = 1,
+    VF_FITTING_FAILED = 2
+};
+
+enum {
+    VF_POLES_LINCMPLX = 0,
+    VF_POLES_LOGCMPLX = 1,
+    VF_POLES_PEAKS    = 2,
+    VF_POLES_LOEWNER  = 3
+};
+
+enum {
+    VF_TREND_ZERO     = 0,
+    VF_TREND_CONSTANT = 1,
+    VF_TREND_LINEAR   = 2
+};
+
+enum {
+    VF_WEIGHTING_ONE                = 0,
+    VF_WEIGHTING_ONE_OVER_ABS       = 1,
+    VF_WEIGHTING_ONE_OVER_SQRT_ABS  = 2,
+    VF_WEIGHTING_ONE_OVER_NORM      = 3,
+    VF_WEIGHTING_ONE_OVER_SQRT_NORM = 4
+};
+
+/*
+ * Options of vf_fit(), see VectorFitting::Options. Set size to
+ * sizeof(vf_options) and fill them with vf_default_options() before
+ * changing any. Later versions only append fields, the library reads and
+ * writes the first size bytes and uses defaults for the fields after them.
+ * Sizes larger than the one of the library are rejected.
+ */
+typedef struct {
+    size_t size;
+    size_t order;
+    size_t iterationsOfSum;   /* Relocations with the sum of responses. */
+    size_t iterations;        /* Relocations with all of them, the last
+                                 one also identifies the residues. */
+    int polesType;
+    int asymptoticTrend;
+    int weighting;            /* Used when no weights are given. */
+    int relax;
+    int stable;
+    double poleTolerance;
+    int multiResolution;      /* Early relocations with fewer samples. */
+} vf_options;
+
+/*
+ * Returns VF_OK, or VF_INVALID_INPUT if the size of options is not
+ * supported, in which case they are left untouched.
+ */
+int vf_default_options(vf_options* options);
+
+/*
+ * Fits the Nr responses sampled at Ns angular frequencies w_i, s = j w_i,
+ * which must be in increasing order.
+ *
+ * Inputs, where element (i, n) of an array with strides (si, sn) is at
+ * index i*si + n*sn:
+ *   frequencies         Ns doubles, with stride frequencyStride.
+ *   responses           Ns x Nr complex.
+ *   weights             Ns x Nr doubles, or NULL to follow the weighting
+ *                       of the options.
+ * Outputs, contiguous and column-major, with N the order:
+ *   poles               N complex.
+ *   residues            Nr x N complex, residue of response n for pole k
+ *                       at n + k*Nr.
+ *   D, E                Nr complex each, or NULL if not needed.
+ *   rmse                Root mean square error, or NULL.
+ * Returns VF_OK or an error code, with a message in vf_last_error().
+ */
+int vf_fit(const vf_options* options,
+           size_t Ns,
+           size_t Nr,
+           const double* frequencies,
+           ptrdiff_t frequencyStride,
+           const double* responses,
+           ptrdiff_t responseSampleStride,
+           ptrdiff_t responseStride,
+           const double* weights,
+           ptrdiff_t weightSampleStride,
+           ptrdiff_t weightStride,
+           double* poles,
+           double* residues,
+           double* D,
+           double* E,
+           double* rmse);
+
+/*
+ * Message of the last error of the calling thread, empty if none.
+ */
+const char* vf_last_error(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* VECTOR_FITTING_C_INTERFACE_H_ */
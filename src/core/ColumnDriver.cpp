@@ -0,0 +1,267 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Alejandro García Montoro        (alejandro.garciamontoro@gmail.com)
+//					  Alejandra López de Aberasturi Gómez (aloaberasturi@ugr.es)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+#include "ColumnDriver.h"
+
+#include <exception>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace VectorFitting {
+
+ColumnDriver::ColumnDriver(const std::vector<Driver::Sample>& samples,
+                           const Options& options,
+                           const std::vector<std::size_t>& orders,
+                           const std::size_t nThreads,
+                           const Control* control) :
+                nThreads_(nThreads),
+                samples_(samples) {
+    if (samples_.empty()) {
+        throw std::runtime_error("Samples size cannot be zero");
+    }
+    Fitting::sortSamples(samples_);
+
+    const std::size_t Nc = samples_.front().second.rows();
+    for (std::size_t i = 0; i < samples_.size(); ++i) {
+        if ((std::size_t) samples_[i].second.rows() != Nc ||
+                (std::size_t) samples_[i].second.cols() != Nc) {
+            throw std::runtime_error("Samples must be square and same size");
+        }
+    }
+    if (!orders.empty() && orders.size() != Nc) {
+        throw std::runtime_error("There must be one order per column");
+    }
+    if (options.getIterations() == std::pair<std::size_t,std::size_t>(0,0)) {
+        throw std::runtime_error("No iterations to perform");
+    }
+
+    if (nThreads_ == 0) {
+#ifdef _OPENMP
+        nThreads_ = omp_get_max_threads();
+#else
+        nThreads_ = 1;
+#endif
+    }
+    nThreads_ = std::max((std::size_t) 1, std::min(nThreads_, Nc));
+
+    poles_.resize(Nc);
+    residues_.resize(Nc);
+    performed_.assign(Nc, std::pair<std::size_t, std::size_t>(0, 0));
+    D_ = MatrixXcd::Zero(Nc, Nc);
+    E_ = MatrixXcd::Zero(Nc, Nc);
+
+    std::vector<std::exception_ptr> errors(Nc);
+    std::size_t done = 0;
+#pragma omp parallel for schedule(dynamic) num_threads(nThreads_)
+    for (long j = 0; j < (long) Nc; ++j) {
+        try {
+            Options opts = options;
+            if (!orders.empty()) {
+                opts.setN(orders[j]);
+            }
+            fitColumn_(j, opts, control);
+            // The callback runs outside of any lock, it may be slow or
+            // throw.
+            std::size_t fitted;
+#pragma omp atomic capture
+            fitted = ++done;
+            Driver::notify(control, Control::Stage::relocation, fitted, Nc);
+        } catch (...) {
+            errors[j] = std::current_exception();
+        }
+    }
+    for (std::size_t j = 0; j < errors.size(); ++j) {
+        if (errors[j]) {
+            std::rethrow_exception(errors[j]);
+        }
+    }
+    Driver::notify(control, Control::Stage::finished, 0, 0);
+}
+
+/**
+ * Runs the stages of Driver on column j: relocation of the poles with the
+ * sum of its elements, relocation with all of them and identification of
+ * residues with the last poles.
+ */
+void ColumnDriver::fitColumn_(const std::size_t j,
+                              const Options& options,
+                              const Control* control) {
+    std::vector<Fitting::Sample> f;
+    f.reserve(samples_.size());
+    for (std::size_t i = 0; i < samples_.size(); ++i) {
+        f.push_back(Fitting::Sample(samples_[i].first,
+                                    samples_[i].second.col(j)));
+    }
+    const std::vector<Fitting::Sample> fSum = Driver::calcFsum(f);
+    const Weights weights = Weights::build(f, options.getWeighting());
+    const Weights sumWeights = Driver::buildSumWeights(weights, false, fSum,
+                                                       options.getWeighting());
+
+    // Residues are read back in complex form.
+    Options opts = options;
+    opts.setComplexSpaceState(true);
+
+    std::vector<Complex> poles = Driver::buildPoles(f, opts);
+    const std::size_t nFirst  = opts.getIterations().first;
+    const std::size_t nSecond = opts.getIterations().second;
+    const std::vector<std::size_t> schedule =
+            Driver::buildSchedule(f.size(), nFirst + nSecond, opts);
+
+    // Progress is reported per column, not per iteration. When the deadline
+    // expires the residues are identified with the last poles, as Driver
+    // does. Cancellation propagates Control::Interrupted.
+    Fitting fitting1(fSum, opts, poles, sumWeights);
+    Fitting fitting2(f, opts, poles, weights);
+    try {
+        Driver::relocateStage(fitting1,
+                std::vector<std::size_t>(schedule.begin(),
+                                         schedule.begin() + nFirst),
+                poles, false, control, Control::Stage::relocationOfSum,
+                false, performed_[j].first);
+        if (nSecond == 0) {
+            // Only identification when there are no relocations with all
+            // the elements.
+            Driver::checkpoint(control);
+            fitting2.options().setSkipPoleIdentification(true);
+            fitting2.options().setSkipResidueIdentification(false);
+            fitting2.setControl(control);
+            fitting2.setStage(Control::Stage::identification, 1);
+            fitting2.setPoles(poles);
+            fitting2.fit();
+        } else {
+            Driver::relocateStage(fitting2,
+                    std::vector<std::size_t>(schedule.begin() + nFirst,
+                                             schedule.end()),
+                    poles, true, control, Control::Stage::relocation,
+                    false, performed_[j].second);
+        }
+    } catch (const Control::Interrupted&) {
+        if (control == nullptr || control->isCancelled()) {
+            throw;
+        }
+        Driver::identifyResidues(fitting2, poles, control);
+    }
+
+    poles_[j] = fitting2.getPoles();
+    residues_[j] = fitting2.getC();
+    D_.col(j) = fitting2.getD();
+    E_.col(j) = fitting2.getE();
+}
+
+const std::vector<Complex>& ColumnDriver::getPoles(const std::size_t j) const {
+    return poles_.at(j);
+}
+
+const MatrixXcd& ColumnDriver::getResidues(const std::size_t j) const {
+    return residues_.at(j);
+}
+
+std::pair<std::size_t, std::size_t>
+        ColumnDriver::getPerformedIterations(const std::size_t j) const {
+    return performed_.at(j);
+}
+
+std::size_t ColumnDriver::countStates_() const {
+    std::size_t res = 0;
+    for (std::size_t j = 0; j < poles_.size(); ++j) {
+        res += poles_[j].size();
+    }
+    return res;
+}
+
+MatrixXcd ColumnDriver::getA() const {
+    VectorXcd diagonal(countStates_());
+    std::size_t offset = 0;
+    for (std::size_t j = 0; j < poles_.size(); ++j) {
+        for (std::size_t k = 0; k < poles_[j].size(); ++k) {
+            diagonal(offset + k) = poles_[j][k];
+        }
+        offset += poles_[j].size();
+    }
+    return diagonal.asDiagonal();
+}
+
+MatrixXi ColumnDriver::getB() const {
+    MatrixXi B = MatrixXi::Zero(countStates_(), poles_.size());
+    std::size_t offset = 0;
+    for (std::size_t j = 0; j < poles_.size(); ++j) {
+        B.block(offset, j, poles_[j].size(), 1).setOnes();
+        offset += poles_[j].size();
+    }
+    return B;
+}
+
+MatrixXcd ColumnDriver::getC() const {
+    MatrixXcd C(residues_.size(), countStates_());
+    std::size_t offset = 0;
+    for (std::size_t j = 0; j < residues_.size(); ++j) {
+        C.middleCols(offset, residues_[j].cols()) = residues_[j];
+        offset += residues_[j].cols();
+    }
+    return C;
+}
+
+MatrixXcd ColumnDriver::evaluate(const Complex& s) const {
+    MatrixXcd res = D_ + s * E_;
+    for (std::size_t j = 0; j < poles_.size(); ++j) {
+        VectorXcd inv(poles_[j].size());
+        for (std::size_t k = 0; k < poles_[j].size(); ++k) {
+            inv(k) = 1.0 / (s - poles_[j][k]);
+        }
+        res.col(j) += residues_[j] * inv;
+    }
+    return res;
+}
+
+std::vector<Driver::Sample> ColumnDriver::getFittedSamples() const {
+    std::vector<Driver::Sample> res;
+    res.reserve(samples_.size());
+    for (std::size_t i = 0; i < samples_.size(); ++i) {
+        res.push_back({samples_[i].first, evaluate(samples_[i].first)});
+    }
+    return res;
+}
+
+/**
+ * Root mean square error, normalized as in Driver::getRMSE().
+ */
+Real ColumnDriver::getRMSE() const {
+    Real error = 0.0;
+    for (std::size_t i = 0; i < samples_.size(); ++i) {
+        error += (samples_[i].second - evaluate(samples_[i].first))
+                .squaredNorm();
+    }
+    return std::sqrt(error / ((Real) (samples_.size() * samples_.size())));
+}
+
+Real ColumnDriver::getMaxDeviation() const {
+    Real res = 0.0;
+    for (std::size_t i = 0; i < samples_.size(); ++i) {
+        res = std::max(res, (samples_[i].second - evaluate(samples_[i].first))
+                .cwiseAbs().maxCoeff());
+    }
+    return res;
+}
+
+} /* namespace VectorFitting */
@@ -0,0 +1,116 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Alejandro García Montoro        (alejandro.garciamontoro@gmail.com)
+//					  Alejandra López de Aberasturi Gómez (aloaberasturi@ugr.es)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef VECTOR_FITTING_COLUMN_DRIVER_H_
+#define VECTOR_FITTING_COLUMN_DRIVER_H_
+
+#include "Driver.h"
+
+namespace VectorFitting {
+
+/**
+ * Fits each column of the response matrices with its own set of poles, as
+ * the column option of vectfit3. Pole identification of a column only
+ * involves its Nc responses, so cost and memory grow linearly with the
+ * number of ports instead of quadratically, and a column which needs a high
+ * order does not force it on the rest.
+ *
+ * Columns are fitted concurrently. Each one follows the same stages as
+ * Driver: relocation on the summed column, relocation on all its elements
+ * and identification of residues. Responses need not be symmetric.
+ */
+class ColumnDriver {
+public:
+    /**
+     * @param samples   Data to be fitted, square matrices.
+     * @param options   Options shared by all columns.
+     * @param orders    Order of each column, options.getN() for all of them
+     *                  when empty.
+     * @param nThreads  Columns fitted at a time, zero to use one per thread.
+     * @param control   Progress, cancellation and deadline hooks (optional).
+     *                  Progress is reported once per fitted column, from
+     *                  the thread which fitted it and without any lock
+     *                  held, so callbacks may run concurrently. When
+     *                  the deadline expires each column identifies its
+     *                  residues with the poles it has reached.
+     */
+    ColumnDriver(const std::vector<Driver::Sample>& samples,
+                 const Options& options,
+                 const std::vector<std::size_t>& orders = {},
+                 const std::size_t nThreads = 0,
+                 const Control* control = nullptr);
+
+    std::size_t getNumberOfPorts() const {return poles_.size();}
+    std::size_t getNumberOfThreads() const {return nThreads_;}
+
+    /**
+     * Model of column j: Y(:,j) = sum_k R(:,k) / (s - p_k) + D(:,j) + s E(:,j)
+     * with p = getPoles(j) and R = getResidues(j), of size Nc, N_j.
+     */
+    const std::vector<Complex>& getPoles(const std::size_t j) const;
+    const MatrixXcd& getResidues(const std::size_t j) const;
+    const MatrixXcd& getD() const {return D_;}
+    const MatrixXcd& getE() const {return E_;}
+
+    /**
+     * Complex state space realization of all the columns, as the column
+     * option of vectfit3: A = blkdiag(diag(p_1), ..., diag(p_Nc)), B feeds
+     * input j to the states of column j and C = [R_1 ... R_Nc], so that
+     * Y(s) = C (sI - A)^-1 B + D + s E. There are sum_j N_j states.
+     */
+    MatrixXcd getA() const;
+    MatrixXi  getB() const;
+    MatrixXcd getC() const;
+
+    /**
+     * Iterations run in each stage for column j, see
+     * Driver::getPerformedIterations().
+     */
+    std::pair<std::size_t, std::size_t>
+            getPerformedIterations(const std::size_t j) const;
+
+    MatrixXcd evaluate(const Complex& s) const;
+
+    const std::vector<Driver::Sample>& getSamples() const {return samples_;}
+    std::vector<Driver::Sample> getFittedSamples() const;
+    Real getRMSE() const;
+    Real getMaxDeviation() const;
+
+private:
+    std::size_t nThreads_;
+    std::vector<Driver::Sample> samples_;
+
+    std::vector<std::vector<Complex>> poles_;
+    std::vector<MatrixXcd> residues_;
+    MatrixXcd D_;
+    MatrixXcd E_;
+    std::vector<std::pair<std::size_t, std::size_t>> performed_;
+
+    std::size_t countStates_() const;
+    void fitColumn_(const std::size_t j,
+                    const Options& options,
+                    const Control* control);
+};
+
+} /* namespace VectorFitting */
+
+#endif // VECTOR_FITTING_COLUMN_DRIVER_H_
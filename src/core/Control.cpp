@@ -0,0 +1,85 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Alejandro García Montoro        (alejandro.garciamontoro@gmail.com)
+//					  Alejandra López de Aberasturi Gómez (aloaberasturi@ugr.es)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+#include "Control.h"
+#include "Observer.h"
+
+namespace VectorFitting {
+
+Control::Control() :
+        cancelled_(false),
+        hasDeadline_(false),
+        observer_(nullptr) {
+}
+
+void Control::cancel() {
+    cancelled_ = true;
+}
+
+bool Control::isCancelled() const {
+    return cancelled_;
+}
+
+void Control::setDeadline(const Clock::time_point& deadline) {
+    hasDeadline_ = true;
+    deadline_ = deadline;
+}
+
+void Control::setTimeout(const Clock::duration& timeout) {
+    setDeadline(Clock::now() + timeout);
+}
+
+bool Control::isExpired() const {
+    return hasDeadline_ && Clock::now() >= deadline_;
+}
+
+bool Control::isInterrupted() const {
+    return isCancelled() || isExpired();
+}
+
+void Control::checkpoint() const {
+    if (isInterrupted()) {
+        throw Interrupted();
+    }
+}
+
+void Control::setProgressCallback(const ProgressCallback& callback) {
+    callback_ = callback;
+}
+
+void Control::notify(const Progress& progress) const {
+    if (callback_) {
+        callback_(progress);
+    }
+}
+
+void Control::setObserver(Observer* observer) {
+    observer_ = observer;
+}
+
+void Control::observe(const Trace& trace) const {
+    if (observer_ != nullptr) {
+        observer_->observe(trace);
+    }
+}
+
+} /* namespace VectorFitting */
@@ -0,0 +1,108 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Alejandro García Montoro        (alejandro.garciamontoro@gmail.com)
+//					  Alejandra López de Aberasturi Gómez (aloaberasturi@ugr.es)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef VECTOR_FITTING_CONTROL_H_
+#define VECTOR_FITTING_CONTROL_H_
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <stdexcept>
+
+namespace VectorFitting {
+
+class Observer;
+struct Trace;
+
+/**
+ * Runtime hooks of a fit: progress reporting, cooperative cancellation and
+ * a wall-clock deadline. Fitters poll the control between phases and
+ * between responses. A control may be shared with other threads, cancel()
+ * can be called from any of them.
+ */
+class Control {
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    enum class Stage {
+        relocationOfSum,
+        relocation,
+        identification,
+        finished
+    };
+
+    struct Progress {
+        Stage stage;
+        std::size_t iteration;  // Iterations completed in this stage.
+        std::size_t iterations; // Iterations scheduled in this stage.
+    };
+
+    typedef std::function<void(const Progress&)> ProgressCallback;
+
+    /**
+     * Thrown by checkpoint() when the fit must stop.
+     */
+    class Interrupted : public std::runtime_error {
+    public:
+        Interrupted() : std::runtime_error("Fitting has been interrupted") {}
+    };
+
+    Control();
+
+    void cancel();
+    bool isCancelled() const;
+
+    void setDeadline(const Clock::time_point& deadline);
+    void setTimeout(const Clock::duration& timeout);
+    bool isExpired() const;
+
+    bool isInterrupted() const;
+    void checkpoint() const;
+
+    /**
+     * The callback is invoked from the thread running the fit.
+     */
+    void setProgressCallback(const ProgressCallback& callback);
+    void notify(const Progress& progress) const;
+
+    /**
+     * Convergence telemetry of each fit, see Observer. The observer is not
+     * owned and must outlive the fits.
+     */
+    void setObserver(Observer* observer);
+    Observer* getObserver() const {return observer_;}
+    void observe(const Trace& trace) const;
+
+private:
+    std::atomic<bool> cancelled_;
+    bool hasDeadline_;
+    Clock::time_point deadline_;
+    ProgressCallback callback_;
+    Observer* observer_;
+
+    Control(const Control&);
+    Control& operator=(const Control&);
+};
+
+} /* namespace VectorFitting */
+
+#endif // VECTOR_FITTING_CONTROL_H_
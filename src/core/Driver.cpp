@@ -22,6 +22,7 @@
 
 
 #include "Driver.h"
+#include "Loewner.h"
 
 namespace VectorFitting {
 
@@ -30,46 +31,159 @@ Driver::Driver(
         const std::vector<Sample>& samples,
         const Options& opts,
         const std::vector<Complex>& inputPoles,
-        const std::vector<MatrixXd>& weights) :
-                samples_(samples) {
+        const std::vector<MatrixXd>& weights,
+        const Control* control) :
+                Driver(std::vector<Sample>(samples),
+                       opts, inputPoles, weights, control) {}
 
-    std::sort(samples_.begin(), samples_.end(), [](Sample a, Sample b) {
-        return lower(a.first.imag(), b.first.imag());
-    });
+Driver::Driver(
+        std::vector<Sample>&& samples,
+        const Options& opts,
+        const std::vector<Complex>& inputPoles,
+        const std::vector<MatrixXd>& weights,
+        const Control* control) :
+                samples_(std::move(samples)),
+                complexSpaceState_(opts.isComplexSpaceState()) {
+
+    const std::vector<size_t> perm = Fitting::sortSamples(samples_);
 
     std::vector<Complex> poles = inputPoles;
-    if (poles.empty() && !samples.empty()) {
-        std::pair<Real,Real> range(samples_.front().first.imag(),
-                                   samples_.back().first.imag());
-        poles = buildPoles(range, opts);
-    } else {
-        poles = inputPoles;
+    if (poles.empty() && !samples_.empty()) {
+        poles = buildPoles(samples_, opts);
     }
 
-    std::vector<Fitting::Sample> squeezedSum = calcFsum(squeeze(samples_), opts);
-    std::vector<VectorXd> squeezedWeights = squeeze(weights);
-    Fitting fitting1(squeezedSum, opts, poles, squeezedWeights);
-    fitting1.options().setSkipResidueIdentification(true);
-    for (size_t i = 0; i < opts.getIterations().first; ++i) {
-        fitting1.fit();
-        poles = fitting1.getPoles();
-    }
+    std::vector<Fitting::Sample> squeezed = squeeze(samples_);
+    std::vector<Fitting::Sample> squeezedSum = calcFsum(squeezed);
 
-    Fitting fitting2(squeeze(samples_), opts, poles, squeeze(weights));
-    fitting2.options().setSkipResidueIdentification(true);
-    for (size_t i = 0; i < opts.getIterations().second; ++i) {
-        if (i == opts.getIterations().second - 1) {
-            fitting2.options().setSkipResidueIdentification(false);
+    // Weights given by the user apply to all elements, otherwise they
+    // follow the weighting option.
+    Weights squeezedWeights;
+    if (weights.empty()) {
+        squeezedWeights = Weights::build(squeezed, opts.getWeighting());
+    } else {
+        if (weights.size() != samples_.size()) {
+            throw std::runtime_error(
+                    "Weights and samples must have same size.");
+        }
+        squeezedWeights = Weights(squeeze(weights),
+                                  squeezed.front().second.size());
+        if (!perm.empty()) {
+            squeezedWeights = squeezedWeights.subset(perm);
+        }
+    }
+    const Weights sumWeights = buildSumWeights(squeezedWeights,
+            !weights.empty(), squeezedSum, opts.getWeighting());
+
+    const size_t nFirst  = opts.getIterations().first;
+    const size_t nSecond = opts.getIterations().second;
+    const std::vector<size_t> schedule =
+            buildSchedule(samples_.size(), nFirst + nSecond, opts);
+
+    // Squeezed samples are taken over by the fittings, so that only the
+    // single precision copy remains when Options::isSinglePrecision() is set.
+    Fitting fitting1(std::move(squeezedSum), opts, poles, sumWeights);
+    Fitting fitting2(std::move(squeezed), opts, poles, squeezedWeights);
+
+    // When the deadline expires the model is built with the last poles
+    // relocated. Cancellation propagates Control::Interrupted.
+    try {
+        relocateStage(fitting1,
+                std::vector<size_t>(schedule.begin(),
+                                    schedule.begin() + nFirst),
+                poles, false, control, Control::Stage::relocationOfSum,
+                true, performed_.first);
+        relocateStage(fitting2,
+                std::vector<size_t>(schedule.begin() + nFirst,
+                                    schedule.end()),
+                poles, true, control, Control::Stage::relocation,
+                true, performed_.second);
+    } catch (const Control::Interrupted&) {
+        if (control == nullptr || control->isCancelled()) {
+            throw;
         }
-        fitting2.fit();
+        // fitting2 holds the squeezed responses, the residues are identified
+        // on it with the last poles.
+        identifyResidues(fitting2, poles, control);
+        notify(control, Control::Stage::identification, 1, 1);
+        store_(fitting2);
+        notify(control, Control::Stage::finished, 0, 0);
+        return;
     }
 
     if (opts.getIterations() == std::pair<size_t,size_t>(0,0)) {
         throw std::runtime_error("No iterations to perform");
     } else if (opts.getIterations().second == 0) {
-        tri2full(fitting1);
+        store_(fitting1);
     } else {
-        tri2full(fitting2);
+        store_(fitting2);
+    }
+    notify(control, Control::Stage::finished, 0, 0);
+}
+
+Driver::Driver(
+        const std::vector<Sample>& samples,
+        const std::vector<Complex>& poles,
+        const std::vector<MatrixXcd>& residues,
+        const MatrixXcd& D,
+        const MatrixXcd& E,
+        const bool complexSpaceState) :
+                Nc_(D.rows()),
+                poles_(poles),
+                D_(pack(D)),
+                E_(pack(E)),
+                samples_(samples),
+                performed_(0, 0),
+                complexSpaceState_(complexSpaceState) {
+    Fitting::sortSamples(samples_);
+
+    if (poles.size() != residues.size()) {
+        throw std::runtime_error("Poles and residues must have the same size");
+    }
+    residues_.resize(D_.size(), poles.size());
+    for (size_t k = 0; k < poles.size(); ++k) {
+        residues_.col(k) = pack(residues[k]);
+    }
+}
+
+Driver::Driver(
+        const std::vector<Sample>& samples,
+        const std::vector<Complex>& poles,
+        const MatrixXcd& packedResidues,
+        const VectorXcd& packedD,
+        const VectorXcd& packedE,
+        const bool complexSpaceState) :
+                Nc_(packedSizeToNc(packedD.size())),
+                poles_(poles),
+                residues_(packedResidues),
+                D_(packedD),
+                E_(packedE),
+                samples_(samples),
+                performed_(0, 0),
+                complexSpaceState_(complexSpaceState) {
+    Fitting::sortSamples(samples_);
+
+    if ((size_t) residues_.cols() != poles.size() ||
+            residues_.rows() != D_.size() || E_.size() != D_.size()) {
+        throw std::runtime_error("Packed model has inconsistent sizes");
+    }
+}
+
+void Driver::checkpoint(const Control* control) {
+    if (control != nullptr) {
+        control->checkpoint();
+    }
+}
+
+void Driver::notify(const Control* control,
+                    const Control::Stage stage,
+                    const size_t iteration,
+                    const size_t iterations) {
+    if (control != nullptr) {
+        Control::Progress progress;
+        progress.stage      = stage;
+        progress.iteration  = iteration;
+        progress.iterations = iterations;
+        control->notify(progress);
     }
 }
 
@@ -89,96 +203,517 @@ std::vector<Fitting::Sample> Driver::squeeze(
     return res;
 }
 
-std::vector<Complex> Driver::buildPoles(
-        const std::pair<Real, Real>& range,
+/**
+ * Number of samples used in each of the relocation iterations. When
+ * multi-resolution is enabled the last iteration uses all the samples and
+ * every previous one halves its predecessor, down to the coarsest level.
+ */
+std::vector<size_t> Driver::buildSchedule(
+        const size_t Ns,
+        const size_t iterations,
         const Options& options) {
-    if (options.getPolesType() == Options::PolesType::lincmplx) {
-        std::vector<Real> imagParts = linspace(range, options.getN()/2);
-        std::vector<Complex> poles(options.getN());
-        for (size_t i = 0; i < options.getN(); i+=2) {
-            Real imag = - imagParts[i/2];
-            Real real = imag *  options.getNu();
-            poles[i] = Complex(real, imag);
-            poles[i+1] = conj(poles[i]);
+    std::vector<size_t> schedule(iterations, Ns);
+    if (!options.isMultiResolution()) {
+        return schedule;
+    }
+    size_t coarsest = options.getCoarsestSamples();
+    if (coarsest == 0) {
+        coarsest = std::max((size_t) 200, 20 * (options.getN() + 2));
+    }
+    size_t size = Ns;
+    for (size_t i = iterations; i-- > 0; ) {
+        schedule[i] = std::min(Ns, std::max(coarsest, size));
+        size /= 2;
+    }
+    return schedule;
+}
+
+/**
+ * Selects a subset of the samples, sorted by frequency, with nSamples
+ * elements at most. Three quarters of them are spaced logarithmically in
+ * frequency, the rest are placed around the sharpest peaks and dips of the
+ * magnitude of the responses, where resonances are.
+ */
+std::vector<size_t> Driver::decimate(
+        const std::vector<Fitting::Sample>& f,
+        const size_t nSamples) {
+    std::vector<Real> freq(f.size()), mag(f.size(), 0.0);
+    for (size_t i = 0; i < f.size(); ++i) {
+        freq[i] = f[i].first.imag();
+        for (VectorXcd::Index n = 0; n < f[i].second.size(); ++n) {
+            mag[i] += std::abs(f[i].second(n));
         }
+    }
+    return decimate_(freq, mag, nSamples);
+}
 
-        if (options.getN() % 2 != 0) {
-            std::complex<Real> extraPole;
-            extraPole = -(range.first + range.second)/2.0;
-            poles.push_back(extraPole);
+/**
+ * Same as above with the responses of a fitting, which may be stored in
+ * single precision or read from a view.
+ */
+std::vector<size_t> Driver::decimate(const Fitting& f,
+                                     const size_t nSamples) {
+    const size_t Ns = f.getSamplesSize();
+    const size_t Nc = f.getResponseSize();
+    std::vector<Real> freq(Ns), mag(Ns, 0.0);
+    for (size_t i = 0; i < Ns; ++i) {
+        freq[i] = f.getSamples()[i].first.imag();
+        for (size_t n = 0; n < Nc; ++n) {
+            mag[i] += std::abs(f.getResponse(i,n));
         }
-        return poles;
-    } else {
-        throw std::runtime_error(
-                "log distributed initial poles hasn't been implemented yet");
     }
+    return decimate_(freq, mag, nSamples);
 }
 
+std::vector<size_t> Driver::decimate_(const std::vector<Real>& freq,
+                                      const std::vector<Real>& mag,
+                                      const size_t nSamples) {
+    const size_t Ns = freq.size();
+    std::vector<size_t> res;
+    if (nSamples >= Ns) {
+        res.resize(Ns);
+        for (size_t i = 0; i < Ns; ++i) {
+            res[i] = i;
+        }
+        return res;
+    }
 
-std::vector<Fitting::Sample> Driver::calcFsum(
-        const std::vector<Fitting::Sample>& f,
-        const Options& options) {
-    switch (options.getWeighting()) {
-    case Options::Weighting::one:
-    {
-        std::vector<Fitting::Sample> fSum;
-        for (size_t i = 0; i < f.size(); ++i){
-            VectorXcd sum(1);
-            sum << f[i].second.sum();
-            fSum.push_back(std::make_pair(f[i].first, sum));
+    std::vector<bool> selected(Ns, false);
+    selected.front() = true;
+    selected.back()  = true;
+
+    Real lowest = freq.front();
+    const Real highest = freq.back();
+    if (lowest <= 0.0) {
+        lowest = std::min(freq[1], highest * 1e-6);
+        lowest = std::max(lowest, highest * 1e-12);
+    }
+    const size_t nLog = nSamples - nSamples / 4;
+    std::vector<Real> targets = logspace(
+            std::make_pair(std::log10(lowest), std::log10(highest)), nLog);
+    // Where the grid is coarser than the targets, the following sample is
+    // taken instead of repeating the nearest one.
+    size_t pos = 0;
+    size_t next = 0;
+    for (size_t j = 0; j < targets.size() && next < Ns; ++j) {
+        while (pos+1 < Ns && freq[pos+1] < targets[j]) {
+            pos++;
+        }
+        size_t nearest = pos;
+        if (pos+1 < Ns && std::abs(freq[pos+1] - targets[j]) <
+                std::abs(freq[pos] - targets[j])) {
+            nearest = pos+1;
+        }
+        nearest = std::max(nearest, next);
+        selected[nearest] = true;
+        next = nearest + 1;
+    }
+
+    std::vector<Real> logMag(Ns);
+    for (size_t i = 0; i < Ns; ++i) {
+        logMag[i] = std::log(mag[i] + std::numeric_limits<Real>::min());
+    }
+    std::vector<std::pair<Real, size_t>> extrema;
+    for (size_t i = 1; i+1 < Ns; ++i) {
+        const bool peak = logMag[i] >= logMag[i-1] && logMag[i] > logMag[i+1];
+        const bool dip  = logMag[i] <= logMag[i-1] && logMag[i] < logMag[i+1];
+        if (peak || dip) {
+            const Real sharpness =
+                    std::abs(2.0*logMag[i] - logMag[i-1] - logMag[i+1]);
+            extrema.push_back(std::make_pair(sharpness, i));
+        }
+    }
+    std::sort(extrema.begin(), extrema.end(),
+            [](const std::pair<Real,size_t>& a,
+               const std::pair<Real,size_t>& b) {
+        return a.first > b.first;
+    });
+    const size_t nExtrema = std::min(extrema.size(), (nSamples/4) / 3);
+    for (size_t j = 0; j < nExtrema; ++j) {
+        const size_t i = extrema[j].second;
+        selected[i-1] = true;
+        selected[i  ] = true;
+        selected[i+1] = true;
+    }
+
+    for (size_t i = 0; i < Ns; ++i) {
+        if (selected[i]) {
+            res.push_back(i);
+        }
+    }
+    return res;
+}
+
+std::vector<Complex> Driver::relocate(
+        const Fitting& f,
+        const size_t nSamples,
+        const std::vector<Complex>& poles,
+        const Control* control,
+        const Control::Stage stage,
+        const size_t iteration) {
+    const std::vector<size_t> indices = decimate(f, nSamples);
+    const size_t Nc = f.getResponseSize();
+    std::vector<Fitting::Sample> subset;
+    subset.reserve(indices.size());
+    for (size_t i = 0; i < indices.size(); ++i) {
+        VectorXcd response(Nc);
+        for (size_t n = 0; n < Nc; ++n) {
+            response(n) = f.getResponse(indices[i], n);
+        }
+        subset.push_back(Fitting::Sample(f.getSamples()[indices[i]].first,
+                                         response));
+    }
+    Fitting fitting(std::move(subset), f.getOptions(), poles,
+                    f.getWeights().subset(indices));
+    fitting.options().setSkipResidueIdentification(true);
+    fitting.setControl(control);
+    fitting.setStage(stage, iteration);
+    fitting.fit();
+    return fitting.getPoles();
+}
+
+void Driver::relocateStage(Fitting& fitting,
+                           const std::vector<size_t>& schedule,
+                           std::vector<Complex>& poles,
+                           const bool identifyResidues,
+                           const Control* control,
+                           const Control::Stage stage,
+                           const bool notifyIterations,
+                           size_t& performed) {
+    const size_t n = schedule.size();
+    const Real tolerance = fitting.getOptions().getPoleTolerance();
+    fitting.options().setSkipResidueIdentification(true);
+    fitting.setControl(control);
+    for (size_t i = 0; i < n; ++i) {
+        checkpoint(control);
+        const std::vector<Complex> previous = poles;
+        if (schedule[i] < fitting.getSamplesSize()) {
+            poles = relocate(fitting, schedule[i], poles, control, stage, i+1);
+        } else {
+            if (identifyResidues && i+1 == n) {
+                fitting.options().setSkipResidueIdentification(false);
+            }
+            fitting.setStage(stage, i+1);
+            fitting.setPoles(poles);
+            fitting.fit();
+            poles = fitting.getPoles();
+        }
+        if (notifyIterations) {
+            notify(control, stage, i+1, n);
+        }
+        performed++;
+        if (Fitting::poleShift(previous, poles) < tolerance) {
+            if (!identifyResidues) {
+                break;
+            }
+            // Go straight to the last iteration, which also identifies the
+            // residues.
+            if (i+2 < n) {
+                i = n - 2;
+            }
         }
-        return fSum;
     }
+}
+
+void Driver::identifyResidues(Fitting& fitting,
+                              const std::vector<Complex>& poles,
+                              const Control* control) {
+    fitting.options().setSkipPoleIdentification(true);
+    fitting.options().setSkipResidueIdentification(false);
+    Control observed;
+    if (control != nullptr) {
+        observed.setObserver(control->getObserver());
+    }
+    fitting.setControl(&observed);
+    fitting.setStage(Control::Stage::identification, 1);
+    fitting.setPoles(poles);
+    fitting.fit();
+    fitting.setControl(nullptr);
+}
+
+Weights Driver::buildSumWeights(const Weights& weights,
+                                const bool given,
+                                const std::vector<Fitting::Sample>& fSum,
+                                const Options::Weighting weighting) {
+    if (weights.getMode() == Weights::Mode::perElement && given) {
+        const size_t Nc = weights.getResponseSize();
+        VectorXd mean = VectorXd::Zero(weights.getSamplesSize());
+        for (size_t n = 0; n < Nc; ++n) {
+            mean += weights.column(n);
+        }
+        return Weights(VectorXd(mean / (Real) Nc));
+    }
+    if (given || weights.getMode() == Weights::Mode::perSample) {
+        return weights;
+    }
+    return Weights::build(fSum, weighting);
+}
+
+std::vector<Complex> Driver::buildPoles(
+        const std::pair<Real, Real>& range,
+        const Options& options) {
+    const size_t nPairs = options.getN() / 2;
+    std::vector<Real> imagParts;
+    Real extra;
+    switch (options.getPolesType()) {
+    case Options::PolesType::lincmplx:
+        imagParts = linspace(range, nPairs);
+        extra = (range.first + range.second) / 2.0;
+        break;
+    case Options::PolesType::logcmplx:
+        if (!(range.first > 0.0)) {
+            throw std::runtime_error(
+                    "Log distributed poles need a positive lower frequency");
+        }
+        imagParts = logspace(std::make_pair(std::log10(range.first),
+                                            std::log10(range.second)),
+                             nPairs);
+        extra = std::sqrt(range.first * range.second);
+        break;
     default:
-        throw std::runtime_error("Weighting parameter not implemented");
+        throw std::runtime_error(
+                "Data driven initial poles need the samples to be fitted");
+    }
+
+    std::vector<Complex> poles(2*nPairs);
+    for (size_t i = 0; i < 2*nPairs; i+=2) {
+        Real imag = - imagParts[i/2];
+        Real real = imag *  options.getNu();
+        poles[i] = Complex(real, imag);
+        poles[i+1] = conj(poles[i]);
+    }
+
+    if (options.getN() % 2 != 0) {
+        poles.push_back(-extra);
+    }
+    return poles;
+}
+
+/**
+ * Starting poles for the samples. With PolesType::peaks a pair of poles is
+ * placed at each of the most prominent peaks of the norm of the response,
+ * with a real part given by the half power bandwidth of the peak. Remaining
+ * pairs are distributed logarithmically, or linearly if the lowest
+ * frequency is zero. With PolesType::loewner they are the poles of the
+ * Loewner pencil of the data, see Loewner, completed in the same way.
+ */
+std::vector<Complex> Driver::buildPoles(
+        const std::vector<Sample>& samples,
+        const Options& options) {
+    if (options.getPolesType() == Options::PolesType::loewner) {
+        return buildLoewnerPoles_(squeeze(samples), options);
+    }
+    std::vector<std::pair<Real, Real>> spectrum;
+    spectrum.reserve(samples.size());
+    for (size_t i = 0; i < samples.size(); ++i) {
+        spectrum.push_back({samples[i].first.imag(), samples[i].second.norm()});
+    }
+    return buildPoles_(spectrum, options);
+}
+
+std::vector<Complex> Driver::buildPoles(
+        const std::vector<Fitting::Sample>& samples,
+        const Options& options) {
+    if (options.getPolesType() == Options::PolesType::loewner) {
+        return buildLoewnerPoles_(samples, options);
+    }
+    std::vector<std::pair<Real, Real>> spectrum;
+    spectrum.reserve(samples.size());
+    for (size_t i = 0; i < samples.size(); ++i) {
+        spectrum.push_back({samples[i].first.imag(), samples[i].second.norm()});
+    }
+    return buildPoles_(spectrum, options);
+}
+
+/**
+ * Poles from the norm of the responses at each angular frequency.
+ */
+std::vector<Complex> Driver::buildPoles_(
+        std::vector<std::pair<Real, Real>> spectrum,
+        const Options& options) {
+    if (spectrum.empty()) {
+        throw std::runtime_error("Samples size cannot be zero");
+    }
+    std::sort(spectrum.begin(), spectrum.end(),
+            [](const std::pair<Real, Real>& a, const std::pair<Real, Real>& b) {
+                return lower(a.first, b.first);
+            });
+    const std::pair<Real, Real> range(spectrum.front().first,
+                                      spectrum.back().first);
+    if (options.getPolesType() != Options::PolesType::peaks) {
+        return buildPoles(range, options);
+    }
+
+    const size_t Ns = spectrum.size();
+    std::vector<Real> w(Ns), mag(Ns);
+    for (size_t i = 0; i < Ns; ++i) {
+        w[i] = spectrum[i].first;
+        mag[i] = spectrum[i].second;
     }
 
+    // Prominence of a local maximum: ratio to the highest of the minima
+    // between it and the closest higher samples at each side.
+    std::vector<std::pair<Real, size_t>> peaks;
+    for (size_t i = 1; i+1 < Ns; ++i) {
+        if (!(mag[i] > mag[i-1] && mag[i] >= mag[i+1])) {
+            continue;
+        }
+        Real leftMin = mag[i], rightMin = mag[i];
+        for (size_t k = i; k > 0 && mag[k-1] <= mag[i]; --k) {
+            leftMin = std::min(leftMin, mag[k-1]);
+        }
+        for (size_t k = i+1; k < Ns && mag[k] <= mag[i]; ++k) {
+            rightMin = std::min(rightMin, mag[k]);
+        }
+        const Real base = std::max(leftMin, rightMin);
+        if (base > 0.0 && mag[i] > peakProminence_ * base) {
+            peaks.push_back({mag[i] / base, i});
+        }
+    }
+    std::sort(peaks.begin(), peaks.end(),
+            [](const std::pair<Real, size_t>& a,
+               const std::pair<Real, size_t>& b) {
+                return a.first > b.first;
+            });
+
+    const size_t nPairs = options.getN() / 2;
+    std::vector<Complex> poles;
+    for (size_t p = 0; p < peaks.size() && p < nPairs; ++p) {
+        const size_t i = peaks[p].second;
+        const Real halfPower = mag[i] / std::sqrt(2.0);
+        size_t lo = i, hi = i;
+        while (lo > 0 && mag[lo] > halfPower) {
+            lo--;
+        }
+        while (hi+1 < Ns && mag[hi] > halfPower) {
+            hi++;
+        }
+        const Real damping = std::max(0.5 * (w[hi] - w[lo]),
+                                      w[i] * options.getNu());
+        poles.push_back(Complex(-damping, -w[i]));
+        poles.push_back(Complex(-damping, +w[i]));
+    }
 
+    Options rest(options);
+    rest.setN(options.getN() - poles.size());
+    rest.setPolesType(range.first > 0.0 ?
+            Options::PolesType::logcmplx : Options::PolesType::lincmplx);
+    std::vector<Complex> fill = buildPoles(range, rest);
+    poles.insert(poles.end(), fill.begin(), fill.end());
+    return poles;
 }
 
+/**
+ * Poles of the Loewner pencil of the samples. When the data has lower
+ * order than requested, the rest are distributed over the range.
+ */
+std::vector<Complex> Driver::buildLoewnerPoles_(
+        const std::vector<Fitting::Sample>& samples,
+        const Options& options) {
+    if (samples.empty()) {
+        throw std::runtime_error("Samples size cannot be zero");
+    }
+    std::vector<Complex> poles = Loewner(samples, options.getN()).getPoles();
 
+    std::pair<Real, Real> range(samples.front().first.imag(),
+                                samples.front().first.imag());
+    for (size_t i = 0; i < samples.size(); ++i) {
+        range.first  = std::min(range.first,  samples[i].first.imag());
+        range.second = std::max(range.second, samples[i].first.imag());
+    }
+    Options rest(options);
+    rest.setN(options.getN() - poles.size());
+    rest.setPolesType(range.first > 0.0 ?
+            Options::PolesType::logcmplx : Options::PolesType::lincmplx);
+    std::vector<Complex> fill = buildPoles(range, rest);
+    poles.insert(poles.end(), fill.begin(), fill.end());
+    return poles;
+}
 
-void Driver::tri2full(const Fitting& fitting) {
+std::vector<Fitting::Sample> Driver::calcFsum(
+        const std::vector<Fitting::Sample>& f) {
+    std::vector<Fitting::Sample> fSum;
+    for (size_t i = 0; i < f.size(); ++i){
+        VectorXcd sum(1);
+        sum << f[i].second.sum();
+        fSum.push_back(std::make_pair(f[i].first, sum));
+    }
+    return fSum;
+}
 
-	const size_t N = fitting.getOrder();
 
-	size_t Nc;
-	{
-        size_t tell = 0;
-        for (size_t k = 0; k < 10000; ++k){
-            tell += (k+1);
-            if (tell == (size_t) fitting.getD().size()){
-                Nc = (k+1);
-                break;
+
+/**
+ * Keeps the model identified by fitting, whose responses are the packed
+ * elements. Residues are taken back to complex form when the fitting used
+ * a real state space.
+ */
+void Driver::store_(const Fitting& fitting) {
+    Nc_ = packedSizeToNc(fitting.getD().size());
+    poles_ = fitting.getPoles();
+    residues_ = fitting.getC();
+    D_ = fitting.getD();
+    E_ = fitting.getE();
+
+    if (!fitting.options_.isComplexSpaceState()) {
+        const RowVectorXi cindex = Fitting::getCIndex(poles_);
+        for (size_t m = 0; m < poles_.size(); ++m) {
+            if (cindex(m) == 1) {
+                const VectorXcd c1 = residues_.col(m).real().cast<Complex>();
+                const VectorXcd c2 = residues_.col(m+1).real().cast<Complex>();
+                residues_.col(m)   = c1 + Complex(0.0, 1.0) * c2;
+                residues_.col(m+1) = c1 - Complex(0.0, 1.0) * c2;
+                m++;
             }
         }
-	}
+    }
+}
 
-    C_ = MatrixXcd::Zero(Nc,Nc*N);
-    D_ = MatrixXcd::Zero(Nc,Nc);
-    E_ = MatrixXcd::Zero(Nc,Nc);
+size_t Driver::packedSizeToNc(const size_t Np) {
+    size_t Nc = 0;
+    while (Nc * (Nc + 1) / 2 < Np) {
+        Nc++;
+    }
+    if (Nc * (Nc + 1) / 2 != Np) {
+        throw std::runtime_error("Invalid size of packed matrix");
+    }
+    return Nc;
+}
 
+VectorXcd Driver::pack(const MatrixXcd& m) {
+    VectorXcd res(m.cols() * (m.cols() + 1) / 2);
     size_t tell = 0;
-	for (size_t i = 0; i < Nc; ++i){
-		A_ = blkdiag(A_, fitting.getA());
-		B_ = blkdiag(B_, (MatrixXi)fitting.getB());
-		for (size_t j = i; j < Nc; ++j){
-			D_(i,j) = fitting.getD()(tell);
-			E_(i,j) = fitting.getE()(tell);
-			if (i != j){
-				D_(j,i) = fitting.getD()(tell);
-				E_(j,i) = fitting.getE()(tell);
-			}
-			C_.block(i,j*N, 1,N) = fitting.getC().row(tell);
-			C_.block(j,i*N, 1,N) = fitting.getC().row(tell);
-			tell++;
-		}
-	}
+    for (MatrixXcd::Index j = 0; j < m.cols(); ++j) {
+        for (MatrixXcd::Index k = j; k < m.rows(); ++k) {
+            res(tell++) = m(k,j);
+        }
+    }
+    return res;
+}
 
+MatrixXcd Driver::unpack(const VectorXcd& packed, const size_t Nc) {
+    if ((size_t) packed.size() != Nc * (Nc + 1) / 2) {
+        throw std::runtime_error("Packed vector has wrong size");
+    }
+    MatrixXcd res(Nc, Nc);
+    size_t tell = 0;
+    for (size_t j = 0; j < Nc; ++j) {
+        for (size_t k = j; k < Nc; ++k) {
+            res(k,j) = packed(tell);
+            res(j,k) = packed(tell);
+            tell++;
+        }
+    }
+    return res;
 }
 
 std::pair<std::vector<Complex>, std::vector<MatrixXcd>> Driver::ss2pr() const {
-    return ss2pr_(A_, B_, C_);
+    std::pair<std::vector<Complex>, std::vector<MatrixXcd>> res;
+    res.first = poles_;
+    for (size_t k = 0; k < poles_.size(); ++k) {
+        res.second.push_back(unpack(residues_.col(k), Nc_));
+    }
+    return res;
 }
 
 std::pair<std::vector<Complex>, std::vector<MatrixXcd>> Driver::ss2pr_(
@@ -210,82 +745,157 @@ std::pair<std::vector<Complex>, std::vector<MatrixXcd>> Driver::ss2pr_(
 }
 
 MatrixXcd Driver::getA() const {
-	return A_;
+    const size_t N = poles_.size();
+    const RowVectorXi cindex = Fitting::getCIndex(poles_);
+    MatrixXcd A = MatrixXcd::Zero(Nc_*N, Nc_*N);
+    for (size_t j = 0; j < Nc_; ++j) {
+        for (size_t k = 0; k < N; ++k) {
+            const size_t n = j*N + k;
+            if (complexSpaceState_ || cindex(k) == 0) {
+                A(n, n) = poles_[k];
+            } else if (cindex(k) == 1) {
+                A(n  , n  ) =   poles_[k].real();
+                A(n  , n+1) =   poles_[k].imag();
+                A(n+1, n  ) = - poles_[k].imag();
+                A(n+1, n+1) =   poles_[k].real();
+            }
+        }
+    }
+    return A;
 }
 
 MatrixXi Driver::getB() const {
-	return B_;
+    const size_t N = poles_.size();
+    const RowVectorXi cindex = Fitting::getCIndex(poles_);
+    MatrixXi B = MatrixXi::Zero(Nc_*N, Nc_);
+    for (size_t j = 0; j < Nc_; ++j) {
+        for (size_t k = 0; k < N; ++k) {
+            if (complexSpaceState_ || cindex(k) == 0) {
+                B(j*N + k, j) = 1;
+            } else if (cindex(k) == 1) {
+                B(j*N + k, j) = 2;
+            }
+        }
+    }
+    return B;
 }
 
 MatrixXcd Driver::getC() const {
-	return C_;
+    const size_t N = poles_.size();
+    MatrixXcd residues = residues_;
+    if (!complexSpaceState_) {
+        const RowVectorXi cindex = Fitting::getCIndex(poles_);
+        for (size_t k = 0; k < N; ++k) {
+            if (cindex(k) == 1) {
+                residues.col(k+1) = residues_.col(k).imag().cast<Complex>();
+                residues.col(k)   = residues_.col(k).real().cast<Complex>();
+            }
+        }
+    }
+    MatrixXcd C(Nc_, Nc_*N);
+    size_t tell = 0;
+    for (size_t j = 0; j < Nc_; ++j) {
+        for (size_t i = j; i < Nc_; ++i) {
+            C.block(i, j*N, 1, N) = residues.row(tell);
+            C.block(j, i*N, 1, N) = residues.row(tell);
+            tell++;
+        }
+    }
+    return C;
 }
 
 MatrixXcd Driver::getD() const {
-	return D_;
+    return unpack(D_, Nc_);
 }
 
 MatrixXcd Driver::getE() const {
-	return E_;
+    return unpack(E_, Nc_);
+}
+
+std::pair<size_t, size_t> Driver::getPerformedIterations() const {
+    return performed_;
 }
 
 
-std::vector<Driver::Sample> Driver::getSamples() const {
+const std::vector<Driver::Sample>& Driver::getSamples() const {
 	return samples_;
 }
 
+VectorXcd Driver::evaluatePacked(const Complex& s) const {
+    VectorXcd res = D_ + s * E_;
+    if (!poles_.empty()) {
+        const VectorXcd poles =
+                Map<const VectorXcd>(poles_.data(), poles_.size());
+        res += residues_ * (s - poles.array()).inverse().matrix();
+    }
+    return res;
+}
+
+MatrixXcd Driver::evaluate(const Complex& s) const {
+    return unpack(evaluatePacked(s), Nc_);
+}
+
 /**
  * Returns the error of the model, measured as the root mean
- * square of the estimated data with respect to the samples.
+ * square of the estimated data with respect to the samples. The model is
+ * evaluated in packed form and compared with both triangles of the samples.
  * @return Real - Root mean square error of the model.
  */
 Real Driver::getRMSE() const {
-    std::vector<Sample> fittedSamples = getFittedSamples();
-
     Real error = 0.0;
     for (size_t i = 0; i < samples_.size(); i++) {
-        for (VectorXcd::Index j = 0; j < samples_[i].second.size(); j++) {
-            Complex actual = samples_[i].second(j);
-            Complex fitted = fittedSamples[i].second(j);
-            Complex diff = actual - fitted;
-            error += abs(diff * diff);
+        const VectorXcd fitted = evaluatePacked(samples_[i].first);
+        const MatrixXcd& actual = samples_[i].second;
+        size_t tell = 0;
+        for (size_t j = 0; j < Nc_; ++j) {
+            for (size_t k = j; k < Nc_; ++k) {
+                error += std::norm(actual(k,j) - fitted(tell));
+                if (k != j) {
+                    error += std::norm(actual(j,k) - fitted(tell));
+                }
+                tell++;
+            }
         }
     }
 
     return sqrt(error/((Real)(samples_.size() * samples_.size())));
 }
 
+/**
+ * Largest absolute deviation of any element of the model from the samples.
+ */
+Real Driver::getMaxDeviation() const {
+    Real res = 0.0;
+    for (size_t i = 0; i < samples_.size(); i++) {
+        const VectorXcd fitted = evaluatePacked(samples_[i].first);
+        const MatrixXcd& actual = samples_[i].second;
+        size_t tell = 0;
+        for (size_t j = 0; j < Nc_; ++j) {
+            for (size_t k = j; k < Nc_; ++k) {
+                res = std::max(res, std::abs(actual(k,j) - fitted(tell)));
+                res = std::max(res, std::abs(actual(j,k) - fitted(tell)));
+                tell++;
+            }
+        }
+    }
+    return res;
+}
+
 /**
  * Return the fitted samples: a vector of pairs s <-> f(s), where f(s) is
  * computed with the model in (2).
  * @return A std::vector of Samples obtained with the fitted parameters.
  */
 std::vector<Driver::Sample> Driver::getFittedSamples() const {
-
-    std::pair<std::vector<Complex>, std::vector<MatrixXcd>> pR = ss2pr();
-    const std::vector<Complex>& poles = pR.first;
-    const std::vector<MatrixXcd>& residues = pR.second;
-
     std::vector<Sample> res;
+    res.reserve(samples_.size());
     for (size_t i = 0; i < samples_.size(); ++i) {
         const Complex& s = samples_[i].first;
-        MatrixXcd fit =
-                MatrixXcd::Zero(samples_[i].second.rows(),
-                                samples_[i].second.cols());
-        for (size_t p = 0; p < poles.size(); ++p) {
-            fit += residues[p] / (s - poles[p]);
-        }
-
-        fit += D_;
-        fit += E_ * s;
-
-        res.push_back({s, fit});
+        res.push_back({s, evaluate(s)});
     }
     return res;
 }
 
-
-
 }/* namespace VectorFitting */
 
 
@@ -35,6 +35,7 @@ using namespace Eigen;
 class Driver {
     friend class DriverTest;
     friend class VectorFitting::Fitting;
+    friend class ColumnDriver;
     friend void VectorFitting::Options::setSkipPoleIdentification(bool);
 public:
     typedef std::pair<Complex, MatrixXcd> Sample;
@@ -45,56 +46,176 @@ public:
 	 * @param samples   Data to be fitted.
 	 * @param order     Order of approximation.
 	 * @param options   Options.
+	 * @param control   Progress, cancellation and deadline hooks (optional).
+	 *                  When the deadline expires the model is built with the
+	 *                  poles of the last completed iteration.
+	 *
+	 * Samples given as rvalues are taken over without copying them.
      */
 	Driver(const std::vector<Sample>& samples,
            const Options& options,
            const std::vector<Complex>& poles = {},
-           const std::vector<MatrixXd>& weights = {});
+           const std::vector<MatrixXd>& weights = {},
+           const Control* control = nullptr);
+	Driver(std::vector<Sample>&& samples,
+           const Options& options,
+           const std::vector<Complex>& poles = {},
+           const std::vector<MatrixXd>& weights = {},
+           const Control* control = nullptr);
+
+	/**
+	 * Builds the model from poles and residues obtained elsewhere, e.g.
+	 * loaded from a model file, without fitting. Residues, D and E must be
+	 * symmetric. complexSpaceState selects the form of getA/B/C, see
+	 * Options::setComplexSpaceState().
+	 */
+	Driver(const std::vector<Sample>& samples,
+	       const std::vector<Complex>& poles,
+	       const std::vector<MatrixXcd>& residues,
+	       const MatrixXcd& D,
+	       const MatrixXcd& E,
+	       const bool complexSpaceState = true);
+	/**
+	 * Same as above with the model in packed form, see getPackedResidues().
+	 */
+	Driver(const std::vector<Sample>& samples,
+	       const std::vector<Complex>& poles,
+	       const MatrixXcd& packedResidues,
+	       const VectorXcd& packedD,
+	       const VectorXcd& packedE,
+	       const bool complexSpaceState = true);
+
+	/**
+	 * The model is stored in packed form: only the lower triangle of the
+	 * symmetric matrices, column by column, as squeeze() orders responses.
+	 * These are views, valid while the driver lives.
+	 */
+	size_t getNumberOfPorts() const {return Nc_;}
+	const std::vector<Complex>& getPoles() const {return poles_;}
+	const MatrixXcd& getPackedResidues() const {return residues_;} // Np, N.
+	const VectorXcd& getPackedD() const {return D_;}               // Np.
+	const VectorXcd& getPackedE() const {return E_;}               // Np.
+
+	/**
+	 * State space matrices in full form. These are expanded from the
+	 * packed model on each call, A has size (Nc*N)^2. With a complex state
+	 * space A is diagonal and B is ones. Otherwise each conjugated pair
+	 * gives a real 2x2 block of A, rows 2 and 0 of B, and the real and
+	 * imaginary parts of its residue in C.
+	 */
 	MatrixXcd getA() const;
 	MatrixXi  getB() const;
 	MatrixXcd getC() const;
 	MatrixXcd getD() const;
 	MatrixXcd getE() const;
 
+	/**
+	 * Evaluates the model at s. The packed version computes only the
+	 * Nc(Nc+1)/2 unique responses.
+	 */
+	VectorXcd evaluatePacked(const Complex& s) const;
+	MatrixXcd evaluate(const Complex& s) const;
+
+	/**
+	 * Evaluates the model at the sample frequencies. The result is built on
+	 * each call.
+	 */
 	std::vector<Sample> getFittedSamples() const;
-	std::vector<Sample> getSamples() const;
+	const std::vector<Sample>& getSamples() const;
 
 	Real getRMSE() const;
+	Real getMaxDeviation() const;
 
+	/**
+	 * Iterations run in each stage, fewer than the scheduled ones when
+	 * the poles converge before.
+	 */
+	std::pair<size_t, size_t> getPerformedIterations() const;
+
+	/**
+	 * Poles and full residue matrices.
+	 */
 	std::pair<std::vector<Complex>, std::vector<MatrixXcd>> ss2pr() const;
 
+	static VectorXcd pack(const MatrixXcd& m);
+	static MatrixXcd unpack(const VectorXcd& packed, const size_t Nc);
+
 	static std::vector<Complex> buildPoles(
             const std::pair<Real, Real>& range, const Options& opts);
+	static std::vector<Complex> buildPoles(
+	        const std::vector<Sample>& samples, const Options& opts);
+	static std::vector<Complex> buildPoles(
+	        const std::vector<Fitting::Sample>& samples, const Options& opts);
 
 	static std::pair<std::vector<Complex>, std::vector<MatrixXcd>> ss2pr_(
 	        const MatrixXcd& A, const MatrixXi& B, const MatrixXcd& C);
+
+	static std::vector<size_t> decimate(
+	        const std::vector<Fitting::Sample>& f, const size_t nSamples);
+	static std::vector<size_t> decimate(
+	        const Fitting& f, const size_t nSamples);
+
+	static std::vector<size_t> buildSchedule(const size_t Ns,
+	                                         const size_t iterations,
+	                                         const Options& options);
+
+	/**
+	 * Runs a stage of pole relocations with the samples of fitting, as
+	 * many as schedule has, each with the number of samples it gives; see
+	 * buildSchedule(). Poles are updated after each iteration and
+	 * performed counts them. The stage ends when the pole shift is below
+	 * the pole tolerance. With identifyResidues the last iteration also
+	 * identifies the residues, and convergence skips to it.
+	 * Progress is notified after each iteration if notifyIterations.
+	 */
+	static void relocateStage(Fitting& fitting,
+	                          const std::vector<size_t>& schedule,
+	                          std::vector<Complex>& poles,
+	                          const bool identifyResidues,
+	                          const Control* control,
+	                          const Control::Stage stage,
+	                          const bool notifyIterations,
+	                          size_t& performed);
+
+	/**
+	 * Identifies the residues of fitting with poles, once the deadline of
+	 * control has expired. It cannot be interrupted and only reports to the
+	 * observer of control.
+	 */
+	static void identifyResidues(Fitting& fitting,
+	                             const std::vector<Complex>& poles,
+	                             const Control* control);
+
+	/**
+	 * Weights to fit the sum of the responses. Weights given by the user
+	 * are averaged in each sample. Otherwise per sample weights, those of
+	 * norm weightings, are reused as in vectfit, and the rest are built
+	 * from the sum.
+	 */
+	static Weights buildSumWeights(const Weights& weights,
+	                               const bool given,
+	                               const std::vector<Fitting::Sample>& fSum,
+	                               const Options::Weighting weighting);
 private:
 
-	MatrixXcd A_;
-	MatrixXi  B_;
-	MatrixXcd C_;
-	MatrixXcd D_;
-	MatrixXcd E_;
+	size_t Nc_ = 0;
+	std::vector<Complex> poles_;
+	MatrixXcd residues_;
+	VectorXcd D_;
+	VectorXcd E_;
 
 	std::vector<Driver::Sample> samples_;
 
+	std::pair<size_t, size_t> performed_;
+	bool complexSpaceState_ = true;
 
-	template <class T>
-	static T blkdiag(const T& a, const T& b) {
-	    T res = T::Zero(a.rows() + b.rows(), a.cols() + b.cols());
-	    for (typename T::Index i = 0; i < a.rows(); ++i) {
-	        for (typename T::Index j = 0; j < a.cols(); ++j) {
-	            res(i,j) = a(i,j);
-	        }
-	    }
-	    for (auto i = 0; i < b.rows(); ++i) {
-	        for (auto j = 0; j < b.cols(); ++j) {
-	            res(i+a.rows(),j+a.cols()) = b(i,j);
-	        }
-	    }
-	    return res;
-	}
+	static std::vector<Complex> buildPoles_(
+	        std::vector<std::pair<Real, Real>> spectrum, const Options& opts);
+	static std::vector<Complex> buildLoewnerPoles_(
+	        const std::vector<Fitting::Sample>& samples, const Options& opts);
 
+	// Minimum ratio of a peak to its surroundings to place poles on it.
+	static constexpr Real peakProminence_ = 1.1;
 
 
 	static std::vector<Fitting::Sample>
@@ -133,10 +254,26 @@ private:
 	}
 
 
+	static std::vector<size_t> decimate_(const std::vector<Real>& freq,
+	                                     const std::vector<Real>& mag,
+	                                     const size_t nSamples);
+	static std::vector<Complex> relocate(
+	        const Fitting& fitting,
+	        const size_t nSamples,
+	        const std::vector<Complex>& poles,
+	        const Control* control,
+	        const Control::Stage stage,
+	        const size_t iteration);
+	static void checkpoint(const Control* control);
+	static void notify(const Control* control,
+	                   const Control::Stage stage,
+	                   const size_t iteration,
+	                   const size_t iterations);
+
 	static std::vector<Fitting::Sample> calcFsum(
-	        const std::vector<Fitting::Sample>& f,
-	        const Options& options);
-	void tri2full(const Fitting& fitting);
+	        const std::vector<Fitting::Sample>& f);
+	void store_(const Fitting& fitting);
+	static size_t packedSizeToNc(const size_t Np);
 
 };
 
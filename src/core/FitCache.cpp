@@ -0,0 +1,398 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Alejandro García Montoro        (alejandro.garciamontoro@gmail.com)
+//					  Alejandra López de Aberasturi Gómez (aloaberasturi@ugr.es)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+#include "FitCache.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utime.h>
+
+namespace VectorFitting {
+
+namespace {
+
+// 64 bit FNV-1a.
+class Hasher {
+public:
+    Hasher() : value_(14695981039346656037ull) {}
+
+    void add(const void* data, const std::size_t size) {
+        const unsigned char* bytes = (const unsigned char*) data;
+        for (std::size_t i = 0; i < size; ++i) {
+            value_ ^= bytes[i];
+            value_ *= 1099511628211ull;
+        }
+    }
+
+    template<typename T>
+    void add(const T& value) {
+        add(&value, sizeof(T));
+    }
+
+    std::uint64_t value() const {return value_;}
+
+private:
+    std::uint64_t value_;
+};
+
+struct Entry {
+    std::string path;
+    std::size_t size;
+    struct timespec modified;
+};
+
+bool statEntry(const std::string& path, Entry& entry) {
+    struct stat st;
+    if (::stat(path.c_str(), &st) != 0) {
+        return false;
+    }
+    entry.path = path;
+    entry.size = st.st_size;
+    entry.modified = st.st_mtim;
+    return true;
+}
+
+// Index of each sample in order of increasing frequency, as sorted by
+// Fitting::sortSamples(), so that keys do not depend on the order in which
+// the samples are given.
+std::vector<std::size_t> frequencyOrder(
+        const std::vector<Driver::Sample>& samples) {
+    std::vector<std::pair<Complex, std::size_t>> keys;
+    keys.reserve(samples.size());
+    for (std::size_t i = 0; i < samples.size(); ++i) {
+        keys.push_back(std::make_pair(samples[i].first, i));
+    }
+    Fitting::sortSamples(keys);
+    std::vector<std::size_t> res(keys.size());
+    for (std::size_t i = 0; i < keys.size(); ++i) {
+        res[i] = keys[i].second;
+    }
+    return res;
+}
+
+bool older(const Entry& a, const Entry& b) {
+    if (a.modified.tv_sec != b.modified.tv_sec) {
+        return a.modified.tv_sec < b.modified.tv_sec;
+    }
+    return a.modified.tv_nsec < b.modified.tv_nsec;
+}
+
+}
+
+FitCache::FitCache(const std::string& directory, const std::size_t maxBytes) :
+        directory_(directory),
+        maxBytes_(maxBytes),
+        hits_(0),
+        misses_(0) {
+    if (::mkdir(directory_.c_str(), 0755) != 0 && errno != EEXIST) {
+        throw std::runtime_error("Could not create cache directory " +
+                                 directory_);
+    }
+}
+
+std::uint64_t FitCache::hashGrid(const std::vector<Driver::Sample>& samples,
+                                 const Options& options) {
+    const std::vector<std::size_t> order = frequencyOrder(samples);
+    Hasher h;
+    h.add((std::uint64_t) samples.size());
+    for (std::size_t i = 0; i < samples.size(); ++i) {
+        h.add(samples[order[i]].first);
+    }
+    h.add((std::uint64_t) (samples.empty() ? 0 : samples[0].second.rows()));
+    h.add((std::uint64_t) options.getN());
+    return h.value();
+}
+
+std::uint64_t FitCache::hash(const std::vector<Driver::Sample>& samples,
+                             const Options& options,
+                             const std::vector<Complex>& poles,
+                             const std::vector<MatrixXd>& weights) {
+    const std::vector<std::size_t> order = frequencyOrder(samples);
+    Hasher h;
+    h.add(hashGrid(samples, options));
+    for (std::size_t i = 0; i < samples.size(); ++i) {
+        const MatrixXcd& data = samples[order[i]].second;
+        h.add((std::uint64_t) data.rows());
+        h.add((std::uint64_t) data.cols());
+        h.add(data.data(), data.size() * sizeof(Complex));
+    }
+    // Weights go along with their samples.
+    const bool perSample = (weights.size() == samples.size());
+    h.add((std::uint64_t) weights.size());
+    for (std::size_t i = 0; i < weights.size(); ++i) {
+        const MatrixXd& w = weights[perSample ? order[i] : i];
+        h.add((std::uint64_t) w.rows());
+        h.add((std::uint64_t) w.cols());
+        h.add(w.data(), w.size() * sizeof(Real));
+    }
+    h.add((std::uint64_t) poles.size());
+    h.add(poles.data(), poles.size() * sizeof(Complex));
+
+    h.add((std::uint32_t) options.getAsymptoticTrend());
+    h.add((std::uint32_t) options.getPolesType());
+    h.add((std::uint32_t) options.getWeighting());
+    h.add((std::uint32_t) options.getBasis());
+    h.add(options.isRelax());
+    h.add(options.isStable());
+    h.add(options.isSkipPoleIdentification());
+    h.add(options.isSkipResidueIdentification());
+    h.add(options.isComplexSpaceState());
+    h.add(options.isMultiResolution());
+    h.add(options.isSinglePrecision());
+    h.add(options.isSketching());
+    h.add((std::uint64_t) options.getCoarsestSamples());
+    h.add((std::uint64_t) options.getIterations().first);
+    h.add((std::uint64_t) options.getIterations().second);
+    h.add(options.getNu());
+    h.add(options.getPoleTolerance());
+    return h.value();
+}
+
+Driver FitCache::fit(const std::vector<Driver::Sample>& samples,
+                     const Options& options,
+                     const std::vector<Complex>& poles,
+                     const std::vector<MatrixXd>& weights) {
+    const std::string path = path_(hashGrid(samples, options),
+                                   hash(samples, options, poles, weights));
+    if (::access(path.c_str(), R_OK) == 0) {
+        try {
+            MappedModel model(path);
+            ::utime(path.c_str(), nullptr);
+            const Map<const VectorXcd> poles = model.getPoles();
+            hits_++;
+            return Driver(samples,
+                          std::vector<Complex>(poles.data(),
+                                               poles.data() + poles.size()),
+                          model.getResidues(), model.getD(), model.getE(),
+                          options.isComplexSpaceState());
+        } catch (const std::runtime_error&) {
+            // Evicted or unreadable, fit again.
+        }
+    }
+    misses_++;
+
+    std::vector<Complex> start = poles;
+    if (start.empty()) {
+        start = warmStart(samples, options);
+    }
+    Driver driver(samples, options, start, weights);
+    store_(path, driver, options);
+    evict();
+    return driver;
+}
+
+bool FitCache::contains(const std::vector<Driver::Sample>& samples,
+                        const Options& options,
+                        const std::vector<Complex>& poles,
+                        const std::vector<MatrixXd>& weights) const {
+    const std::string path = path_(hashGrid(samples, options),
+                                   hash(samples, options, poles, weights));
+    return ::access(path.c_str(), R_OK) == 0;
+}
+
+std::vector<Complex> FitCache::warmStart(
+        const std::vector<Driver::Sample>& samples,
+        const Options& options) const {
+    const std::vector<std::string> paths =
+            entries_(prefix_(hashGrid(samples, options)));
+
+    std::vector<Entry> candidates;
+    for (std::size_t i = 0; i < paths.size(); ++i) {
+        Entry entry;
+        if (statEntry(paths[i], entry)) {
+            candidates.push_back(entry);
+        }
+    }
+    std::sort(candidates.begin(), candidates.end(), older);
+
+    // Stored signatures are computed on sorted samples.
+    std::vector<Driver::Sample> sorted;
+    const std::vector<std::size_t> order = frequencyOrder(samples);
+    if (!std::is_sorted(order.begin(), order.end())) {
+        sorted = samples;
+        Fitting::sortSamples(sorted);
+    }
+    const std::vector<Real> signature =
+            MappedModel::signature(sorted.empty() ? samples : sorted);
+    const Map<const VectorXd> sig(signature.data(), signature.size());
+    for (std::size_t i = candidates.size(); i > 0; --i) {
+        try {
+            MappedModel model(candidates[i-1].path);
+            const std::vector<Real> stored = model.getSignature();
+            const Map<const VectorXd> ref(stored.data(), stored.size());
+            if ((sig - ref).norm() > maxSignatureDistance * ref.norm()) {
+                continue;
+            }
+            return model.ss2pr().first;
+        } catch (const std::runtime_error&) {
+            // Evicted meanwhile, try the next one.
+        }
+    }
+    return {};
+}
+
+void FitCache::evict() const {
+    const std::string lockPath = directory_ + "/lock";
+    const int fd = ::open(lockPath.c_str(), O_CREAT | O_RDWR, 0644);
+    if (fd < 0) {
+        throw std::runtime_error("Could not open cache lock " + lockPath);
+    }
+    while (::flock(fd, LOCK_EX) != 0) {
+        if (errno != EINTR) {
+            ::close(fd);
+            throw std::runtime_error("Could not lock cache " + lockPath);
+        }
+    }
+
+    // Temporary files left by processes which died before renaming them
+    // are removed, those still being written count towards the bound.
+    std::size_t total = 0;
+    const std::vector<std::string> temporaries = entries_("", true);
+    for (std::size_t i = 0; i < temporaries.size(); ++i) {
+        Entry entry;
+        if (!statEntry(temporaries[i], entry)) {
+            continue;
+        }
+        if (isStale_(temporaries[i])) {
+            std::remove(temporaries[i].c_str());
+        } else {
+            total += entry.size;
+        }
+    }
+
+    const std::vector<std::string> paths = entries_("");
+    std::vector<Entry> entries;
+    for (std::size_t i = 0; i < paths.size(); ++i) {
+        Entry entry;
+        if (statEntry(paths[i], entry)) {
+            entries.push_back(entry);
+            total += entry.size;
+        }
+    }
+    std::sort(entries.begin(), entries.end(), older);
+    for (std::size_t i = 0; i < entries.size() && total > maxBytes_; ++i) {
+        if (std::remove(entries[i].path.c_str()) == 0) {
+            total -= entries[i].size;
+        }
+    }
+
+    // Closing the descriptor releases the lock.
+    ::close(fd);
+}
+
+void FitCache::clear() const {
+    const std::vector<std::string> paths = entries_("");
+    for (std::size_t i = 0; i < paths.size(); ++i) {
+        std::remove(paths[i].c_str());
+    }
+    const std::vector<std::string> temporaries = entries_("", true);
+    for (std::size_t i = 0; i < temporaries.size(); ++i) {
+        if (isStale_(temporaries[i])) {
+            std::remove(temporaries[i].c_str());
+        }
+    }
+}
+
+std::string FitCache::prefix_(const std::uint64_t grid) {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx-", (unsigned long long) grid);
+    return name;
+}
+
+std::string FitCache::path_(const std::uint64_t grid,
+                            const std::uint64_t key) const {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx", (unsigned long long) key);
+    return directory_ + "/" + prefix_(grid) + name + extension_;
+}
+
+std::vector<std::string> FitCache::entries_(const std::string& prefix,
+                                           const bool temporary) const {
+    std::vector<std::string> res;
+    DIR* dir = ::opendir(directory_.c_str());
+    if (dir == nullptr) {
+        return res;
+    }
+    const std::string ext(extension_);
+    const std::string tmp = ext + temporary_;
+    while (struct dirent* entry = ::readdir(dir)) {
+        const std::string name(entry->d_name);
+        if (name.compare(0, prefix.size(), prefix) != 0) {
+            continue;
+        }
+        bool matches;
+        if (temporary) {
+            matches = name.find(tmp) != std::string::npos;
+        } else {
+            matches = name.size() > ext.size() &&
+                name.compare(name.size() - ext.size(), ext.size(), ext) == 0;
+        }
+        if (matches) {
+            res.push_back(directory_ + "/" + name);
+        }
+    }
+    ::closedir(dir);
+    return res;
+}
+
+bool FitCache::isStale_(const std::string& temporary) {
+    // Named <entry>.tmp.<pid>.<counter>.
+    const std::string tmp = std::string(extension_) + temporary_;
+    const std::size_t pos = temporary.rfind(tmp);
+    if (pos == std::string::npos) {
+        return false;
+    }
+    char* end;
+    const long pid = std::strtol(temporary.c_str() + pos + tmp.size(),
+                                 &end, 10);
+    if (pid <= 0 || *end != '.') {
+        return true;
+    }
+    return ::kill((pid_t) pid, 0) != 0 && errno == ESRCH;
+}
+
+void FitCache::store_(const std::string& path,
+                      const Driver& driver,
+                      const Options& options) const {
+    static std::atomic<unsigned long> counter(0);
+    const std::string tmp = path + temporary_ +
+            std::to_string((long) ::getpid()) + "." +
+            std::to_string(counter++);
+    MappedModel::write(tmp, driver, options);
+    if (std::rename(tmp.c_str(), path.c_str()) != 0) {
+        std::remove(tmp.c_str());
+        throw std::runtime_error("Could not store cache entry " + path);
+    }
+}
+
+} /* namespace VectorFitting */
@@ -0,0 +1,126 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Alejandro García Montoro        (alejandro.garciamontoro@gmail.com)
+//					  Alejandra López de Aberasturi Gómez (aloaberasturi@ugr.es)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef VECTOR_FITTING_FIT_CACHE_H_
+#define VECTOR_FITTING_FIT_CACHE_H_
+
+#include <cstdint>
+#include <string>
+
+#include "MappedModel.h"
+
+namespace VectorFitting {
+
+/**
+ * Persistent cache of fitted models in a local directory.
+ *
+ * Models are stored as model files named after two hashes: one of the
+ * frequency grid, number of ports and order, and one of everything that
+ * determines the result (samples, weights, initial poles and every field of
+ * the Options). Samples are hashed in order of increasing frequency, so
+ * the order in which they are given does not matter. An exact match is
+ * returned without fitting. A model with the same grid, ports and order is
+ * a near miss, and its poles are a warm start when the signatures of both
+ * datasets, see MappedModel::signature(), are close.
+ *
+ * Entries are written to a temporary file and renamed, so readers in other
+ * processes never see partial files. Eviction of the least recently used
+ * entries keeps the directory below a size bound and is serialized among
+ * processes with a lock file. The cache is only built on POSIX systems.
+ */
+class FitCache {
+public:
+    FitCache(const std::string& directory,
+             const std::size_t maxBytes = 1 << 30);
+
+    /**
+     * Returns the cached model if present. Otherwise fits, starting from
+     * the poles of a near miss when no initial poles are given, and stores
+     * the result.
+     */
+    Driver fit(const std::vector<Driver::Sample>& samples,
+               const Options& options,
+               const std::vector<Complex>& poles = {},
+               const std::vector<MatrixXd>& weights = {});
+
+    bool contains(const std::vector<Driver::Sample>& samples,
+                  const Options& options,
+                  const std::vector<Complex>& poles = {},
+                  const std::vector<MatrixXd>& weights = {}) const;
+
+    /**
+     * Relative distance between data signatures below which a near miss is
+     * used as a warm start.
+     */
+    static constexpr Real maxSignatureDistance = 0.1;
+
+    /**
+     * Poles of the most recently used model with the same grid, number of
+     * ports and order and a close signature, or an empty vector if there is
+     * none.
+     */
+    std::vector<Complex> warmStart(
+            const std::vector<Driver::Sample>& samples,
+            const Options& options) const;
+
+    /**
+     * Removes the least recently used entries until the directory is below
+     * the size bound, counting the temporary files being written. Temporary
+     * files of processes which no longer exist are removed.
+     */
+    void evict() const;
+    void clear() const;
+
+    std::size_t getHits() const {return hits_;}
+    std::size_t getMisses() const {return misses_;}
+
+    static std::uint64_t hashGrid(const std::vector<Driver::Sample>& samples,
+                                  const Options& options);
+    static std::uint64_t hash(const std::vector<Driver::Sample>& samples,
+                              const Options& options,
+                              const std::vector<Complex>& poles,
+                              const std::vector<MatrixXd>& weights);
+
+private:
+    std::string directory_;
+    std::size_t maxBytes_;
+
+    std::size_t hits_;
+    std::size_t misses_;
+
+    static constexpr const char* extension_ = ".vfm";
+    static constexpr const char* temporary_ = ".tmp.";
+
+    static std::string prefix_(const std::uint64_t grid);
+    std::string path_(const std::uint64_t grid,
+                      const std::uint64_t key) const;
+    std::vector<std::string> entries_(const std::string& prefix,
+                                      const bool temporary = false) const;
+    static bool isStale_(const std::string& temporary);
+    void store_(const std::string& path,
+                const Driver& driver,
+                const Options& options) const;
+};
+
+} /* namespace VectorFitting */
+
+#endif // VECTOR_FITTING_FIT_CACHE_H_
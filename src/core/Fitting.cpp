@@ -22,6 +22,17 @@
 
 #include "Fitting.h"
 
+#include <chrono>
+#include <exception>
+#include <limits>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "Observer.h"
+#include "SecularSolver.h"
+#include "Sketch.h"
 #include "SpaceGenerator.h"
 
 namespace VectorFitting {
@@ -31,14 +42,33 @@ Fitting::Fitting(
         const Options& options,
         const std::vector<Complex>& poles,
 		const std::vector<VectorXd>& weights) :
+                Fitting(std::vector<Sample>(samples), options, poles, weights) {}
+
+Fitting::Fitting(
+        std::vector<Sample>&& samples,
+        const Options& options,
+        const std::vector<Complex>& poles,
+        const std::vector<VectorXd>& weights) :
+                Fitting(std::move(samples), options, poles,
+                        Weights(weights, samples.empty() ?
+                                0 : samples.front().second.size())) {}
+
+Fitting::Fitting(
+        const std::vector<Sample>& samples,
+        const Options& options,
+        const std::vector<Complex>& poles,
+        const Weights& weights) :
+                Fitting(std::vector<Sample>(samples), options, poles, weights) {}
+
+Fitting::Fitting(
+        std::vector<Sample>&& samples,
+        const Options& options,
+        const std::vector<Complex>& poles,
+        const Weights& weights) :
                 options_(options),
-                samples_(samples),
+                samples_(std::move(samples)),
                 poles_(poles),
                 weights_(weights) {
-    std::sort(samples_.begin(), samples_.end(), [](Sample a, Sample b) {
-        return lower(a.first.imag(), b.first.imag());
-    });
-
     if (poles_.empty()) {
         throw std::runtime_error("Poles size can not be zero.");
     }
@@ -47,20 +77,88 @@ Fitting::Fitting(
         throw std::runtime_error("Samples size cannot be zero");
     }
 
-    if (!weights_.empty() && weights_.size() != samples_.size()) {
+    if (!weights_.isUniform() &&
+            weights_.getSamplesSize() != samples_.size()) {
         throw std::runtime_error("Weights and samples must have same size.");
     }
-    if (weights_.empty()) {
-        weights_ = std::vector<VectorXd>(
-                getSamplesSize(), VectorXd::Ones(getResponseSize()));
+    if (weights_.getMode() == Weights::Mode::perElement &&
+            weights_.getResponseSize() != getResponseSize()) {
+        throw std::runtime_error("Weights and responses must have same size.");
+    }
+    checkPoles_(poles_);
+
+    const std::vector<size_t> perm = sortSamples(samples_);
+    if (!perm.empty()) {
+        weights_ = weights_.subset(perm);
+    }
+
+    if (options_.isSinglePrecision()) {
+        singleResponses_.resize(samples_.size(), getResponseSize());
+        for (size_t i = 0; i < samples_.size(); ++i) {
+            singleResponses_.row(i) =
+                    samples_[i].second.transpose().cast<std::complex<float>>();
+            VectorXcd().swap(samples_[i].second);
+        }
+        singlePrecision_ = true;
+        weights_ = weights_.toSinglePrecision();
     }
+}
+
+Fitting::Fitting(
+        const std::vector<Complex>& frequencies,
+        const ResponseView& responses,
+        const Options& options,
+        const std::vector<Complex>& poles,
+        const Weights& weights) :
+                options_(options),
+                poles_(poles),
+                view_(responses),
+                weights_(weights) {
+    if (poles_.empty()) {
+        throw std::runtime_error("Poles size can not be zero.");
+    }
+    if (frequencies.empty() || view_.responses == 0) {
+        throw std::runtime_error("Samples size cannot be zero");
+    }
+    if (view_.data == nullptr) {
+        throw std::runtime_error("Responses view has no data");
+    }
+    if (!weights_.isUniform() &&
+            weights_.getSamplesSize() != frequencies.size()) {
+        throw std::runtime_error("Weights and samples must have same size.");
+    }
+    if (weights_.getMode() == Weights::Mode::perElement &&
+            weights_.getResponseSize() != view_.responses) {
+        throw std::runtime_error("Weights and responses must have same size.");
+    }
+    checkPoles_(poles_);
+
+    samples_.reserve(frequencies.size());
+    for (size_t i = 0; i < frequencies.size(); ++i) {
+        if (i > 0 && lower(frequencies[i].imag(), frequencies[i-1].imag())) {
+            throw std::runtime_error("Frequencies of a view must be sorted");
+        }
+        samples_.push_back(Sample(frequencies[i], VectorXcd()));
+    }
+    options_.setSinglePrecision(false);
+}
+
+void Fitting::setPoles(const std::vector<Complex>& poles) {
+    if (poles.size() != poles_.size()) {
+        throw std::runtime_error("Poles size can not be changed.");
+    }
+    checkPoles_(poles);
+    poles_ = poles;
+}
+
+void Fitting::checkPoles_(const std::vector<Complex>& poles) {
     // Sanity check: the complex poles should come in pairs; otherwise, there
     // is an error
     Complex currentPole;
-    for (size_t i = 0; i < poles_.size(); i++) {
-        currentPole = poles_[i];
+    for (size_t i = 0; i < poles.size(); i++) {
+        currentPole = poles[i];
         if(!isReal(currentPole)){
-            if (conj(currentPole) == poles_[i+1]) {
+            if (i+1 < poles.size() && conj(currentPole) == poles[i+1]) {
                 i++;
             } else {
                 throw std::runtime_error(
@@ -77,6 +175,20 @@ void Fitting::fit(){
     const size_t N  = getOrder();
     const size_t Nc = getResponseSize();
 
+    const Observer* observer =
+            (control_ != nullptr) ? control_->getObserver() : nullptr;
+    const std::chrono::steady_clock::time_point start =
+            std::chrono::steady_clock::now();
+    Trace trace;
+    trace.stage = stage_;
+    trace.iteration = iteration_++;
+    trace.samples = Ns;
+    trace.responses = Nc;
+    trace.order = N;
+    // Residues are identified anyway when the observer asks for the error.
+    const bool identifyResidues = !options_.isSkipResidueIdentification() ||
+            (observer != nullptr && observer->isRMSERequired());
+
     VectorXcd SERD(Nc), SERE(Nc);
     VectorXi SERB(N);
     RowVectorXcd SERA(1,N);
@@ -84,316 +196,29 @@ void Fitting::fit(){
     for (size_t i = 0; i < N; ++i) {
         SERA(0,i) = poles_[i];
     }
-    VectorXcd roetter;
+    // Poles used in the residue identification. They are relocated unless
+    // the pole identification is skipped.
+    VectorXcd roetter = toEigenVector(poles_);
 
     // --- Pole identification ---
     if (!options_.isSkipPoleIdentification()) {
-
-        // Finds out which starting poles are complex.
-        RowVectorXi cindex = getCIndex(poles_);
-
-        // Builds system - matrix.
-        MatrixXcd LAMBD = MatrixXcd::Zero(N, N);
-        for (size_t i = 0; i < N; ++i) {
-            LAMBD(i,i) = poles_[i];
-        }
-
-        MatrixXcd Dk;
-        switch (options_.getAsymptoticTrend()) {
-        case Options::AsymptoticTrend::zero:
-        case Options::AsymptoticTrend::constant:
-            Dk = MatrixXcd::Zero(Ns,N+1);
-            break;
-        case Options::AsymptoticTrend::linear:
-            Dk = MatrixXcd::Zero(Ns,N+2);
-            break;
-        }
-
-        MatrixXcd LAMBDprime = LAMBD.transpose().conjugate();
-        for (size_t m = 0; m < N; ++m) {
-            if (cindex(m) == 0) { // Real pole.
-                for (size_t i = 0; i < Ns; ++i) {
-                    Dk(i,m) = Complex(1,0) / (samples_[i].first - LAMBD(m,m));
-                }
-            } else if (cindex(m) == 1) { // Complex pole, first part.
-                for (size_t i = 0; i < Ns; ++i) {
-                    Dk(i,m)   = Complex(1,0) / (samples_[i].first - LAMBD(m,m))
-                               + Complex(1,0) / (samples_[i].first - LAMBDprime(m,m));
-                    Dk(i,m+1) = Complex(0,1) / (samples_[i].first - LAMBD(m,m))
-                               - Complex(0,1) / (samples_[i].first - LAMBDprime(m,m));
-                }
-            }
-        }
-        for (size_t i = 0; i < Ns; ++i) {
-            Dk(i,N) = (Real) 1.0;
-            if (options_.getAsymptoticTrend() ==
-            		Options::AsymptoticTrend::linear) {
-                Dk(i,N+1) = samples_[i].first;
-            }
-        }
-        // Scaling for last row of LS-problem (pole identification).
-        Real scale = 0.0;
-        for (size_t m = 0; m < Nc; ++m) {
-            for (size_t i = 0; i < Ns; ++i) {
-                const Complex sample = samples_[i].second[m];
-                scale += std::pow(std::abs(
-                        useWeight_(i,m) * std::conj(sample)), 2);
-            }
-        }
-        scale = std::sqrt(scale) / (Real) Ns;
-
-        size_t offs;
-        switch (options_.getAsymptoticTrend()) {
-        case Options::AsymptoticTrend::zero:
-            offs = 0;
-            break;
-        case Options::AsymptoticTrend::constant:
-            offs = 1;
-            break;
-        case Options::AsymptoticTrend::linear:
-            offs = 2;
-            break;
-        }
-
-        VectorXd x(N+1);
+        VectorXd x;
         if (options_.isRelax()) {
-
-            // Computes AA and bb. Corresponding line in vectfit3.m code: 319
-            MatrixXd AA = MatrixXd::Zero(Nc*(N+1), N+1);
-            VectorXd bb = VectorXd::Zero(Nc*(N+1));
-            for (size_t n = 0; n < Nc; ++n) {
-                MatrixXd A = MatrixXd::Zero(2*Ns+1, (N+offs)+N+1);
-                // Left block.
-                for (size_t m = 0; m < N + offs; ++m) {
-                    for (size_t i = 0; i < Ns; ++i) {
-                        const Complex entry = useWeight_(i,n) * Dk(i,m);
-                        A(i   ,m) = std::real(entry);
-                        A(i+Ns,m) = std::imag(entry);
-                    }
-                }
-                // Right block.
-                const size_t inda = N + offs;
-                for (size_t m = 0; m < N+1; ++m) {
-                    for (size_t i = 0; i < Ns; ++i) {
-                        const Complex entry =
-                         - useWeight_(i,n) * Dk(i,m) * samples_[i].second[n];
-                        A(i   ,inda+m) = std::real(entry);
-                        A(i+Ns,inda+m) = std::imag(entry);
-                    }
-                }
-
-                // Integral criterion for sigma.
-                const size_t offset = N + offs;
-                if (n == Nc-1) {
-                    for (size_t mm = 0; mm < N+1; ++mm) {
-                        A(2*Ns, offset+mm) = std::real(scale*Dk.col(mm).sum());
-                    }
-                }
-
-                // Performs QR decomposition. Line 350
-                MatrixXd Q, R;
-                HouseholderQR<MatrixXd> qr(A.rows(), A.cols());
-                qr.compute(A);
-                Q = qr.householderQ() * MatrixXd::Identity(A.rows(),A.cols());
-                R = Q.transpose() * A;
-
-                const size_t ind = N + offs;
-                MatrixXd R22 = R.block(ind,ind, N+1,N+1);
-                AA.block(n*(N+1), 0, N+1, N+1) = R22;
-                if (n == Nc-1) {
-                    for (size_t i = 0; i < N+1; ++i) {
-                        bb(i + n*(N+1)) = Q(2*Ns, N + offs + i)
-                                * (Real) Ns * (Real) scale;
-                    }
-                }
-            }  // End of for loop n=1:Nc
-
-            // Computes scaling factor. Line 360
-            VectorXd Escale = VectorXd::Zero(N+1);
-            for (size_t col = 0; col < N+1; ++col) {
-                const double norm = AA.col(col).norm();
-                Escale(col) = 1.0 / norm;
-                AA.col(col) *= Escale(col);
-            }
-
-            x = AA.householderQr().solve(bb);
-            for (size_t i = 0; i < N+1; ++i) {
-                x(i) *= Escale(i);
-            }
-
-        } // End of if for "relax" flag.
-
-        if (!options_.isRelax() //Line 372
-                || lower  (std::abs(x(N)), toleranceLow_)
-                || greater(std::abs(x(N)), toleranceHigh_) ) {
-
-            Real Dnew;
-            if (!options_.isRelax()) {
-                Dnew = 1.0;
-            } else {
-                if (std::abs(x(N)) < toleranceLow_) {
-                    Dnew = 1.0;
-                } else if (lower  (std::abs(x(N)), toleranceLow_)) {
-                    std::signbit(x(N)) ?
-                            Dnew = toleranceLow_ : Dnew  = - toleranceLow_;
-                } else if (greater(std::abs(x(N)), toleranceHigh_)) {
-                    std::signbit(x(N)) ?
-                            Dnew = toleranceHigh_ : Dnew = - toleranceHigh_;
-                } else {
-                    throw std::runtime_error("Can not relax constant term");
-                }
-            }
-
-            MatrixXd AA(Nc*N, N);
-            VectorXd bb(Nc*N);
-            for (size_t n = 0; n < Nc; ++n) {
-
-                MatrixXd A(2*Ns, N+offs+N);
-                {
-                    for (size_t m = 0; m < N+offs; ++m) {
-                        for (size_t i = 0; i < Ns; ++i) {
-                            A(i,m)     = std::real(useWeight_(i,n) * Dk(i,m));
-                            A(i+Ns, m) = std::imag(useWeight_(i,n) * Dk(i,m));
-                        }
-                    }
-                    MatrixXd::Index inda = N + offs;
-                    for (size_t m = 0; m < N; ++m) {
-                        for (size_t i = 0; i < Ns; ++i) {
-                            Complex aux = - useWeight_(i,n) *
-                                    Dk(i,m) * std::conj(samples_[i].second(n));
-                            A(i,    inda+m) = std::real(aux);
-                            A(i+Ns, inda+m) = std::imag(aux);
-                        }
-                    }
-                }
-
-                VectorXd b(2*Ns);
-                for (size_t i = 0; i < Ns; ++i) {
-                    Complex aux = Dnew *
-                            useWeight_(i,n) * std::conj(samples_[i].second(n));
-                    b(i)    = std::real(aux);
-                    b(i+Ns) = std::imag(aux);
-                }
-
-                HouseholderQR<MatrixXd> qr(A.rows(), A.cols());
-                qr.compute(A);
-                MatrixXd Q = qr.householderQ() *
-                        MatrixXd::Identity(A.rows(),A.cols());
-                MatrixXd R = Q.transpose() * A;
-                MatrixXd::Index ind = N+offs;
-                MatrixXd R22 = R.block(ind,ind, N,N);
-                AA.block(n*N, 0, N, N) = R22;
-                bb.block(n*N, 0, N, 1) =
-                        Q.block(0, ind, A.rows(), N).transpose() * b;
-            }
-
-            RowVectorXd Escale = RowVectorXd::Zero(N);
-            for (MatrixXd::Index col = 0; col < AA.cols(); ++col) {
-                Escale(col) = 1 / AA.col(col).norm();
-                AA.col(col) *= Escale(col);
-            }
-
-            VectorXd xAux = AA.householderQr().solve(bb);
-            for (VectorXd::Index i = 0; i < xAux.size(); ++i) {
-                xAux(i) *= Escale(i);
-            }
-
-            x.head(N) = xAux;
-            x(N) = Dnew;
+            x = solveSigma(reduce(0, Nc), 0.0, &trace.condition);
+            trace.sigmaConstant = x(N);
         }
-
-        VectorXcd C = x.head(N).cast<Complex>(); // Line 433
-        for (size_t m = 0; m < N; ++m) {
-            if (cindex(m) == 1) {
-                const Real r1 = std::real(C(m  ));
-                const Real r2 = std::real(C(m+1));
-                C(m)   = Complex(r1,  r2);
-                C(m+1) = Complex(r1, -r2);
-            }
-        }
-        Real D = x(N);
-
-        // Calculates the zeros for sigma. Line 481
-        VectorXi B = VectorXi::Ones(N);
-        size_t m = 0;
-        for (size_t n = 0; n < N; ++n) {
-            if (m < N) {
-                if (greater(std::abs(LAMBD(m,m)),
-                            std::abs(std::real(LAMBD(m,m))))) {
-                    LAMBD(m+1,m  ) = - std::imag(LAMBD(m,m));
-                    LAMBD(m  ,m+1) =   std::imag(LAMBD(m,m));
-                    LAMBD(m  ,m  ) =   std::real(LAMBD(m,m));
-                    LAMBD(m+1,m+1) =             LAMBD(m,m);
-                    B(m  ) = 2;
-                    B(m+1) = 0;
-                    const Complex aux = C(m);
-                    C(m  ) = std::real(aux);
-                    C(m+1) = std::imag(aux);
-                    m++;
-                }
-            }
-            m++;
-        }
-
-        // Checks LAMBD and C are purely real.
-        for (size_t i = 0; i < N; ++i) {
-            for (size_t j = 0; j < N; ++j) {
-                if (!equal(std::imag(LAMBD(i,j)), 0.0)) {
-                    throw std::runtime_error("LAMBD is not purely real");
-                }
-            }
-        }
-        for (size_t i = 0; i < N; ++i) {
-            if (!equal(std::imag(C(i)), 0.0)) {
-                throw std::runtime_error("LAMBD is not purely real");
-            }
+        const Real dNew = fixedConstant(x);
+        if (dNew != 0.0) {
+            x = solveSigma(reduce(0, Nc, dNew), dNew, &trace.condition);
+            trace.fixedConstant = dNew;
         }
-
-        MatrixXd ZER = MatrixXd::Zero(N,N);//Line 498
-        for (size_t i = 0; i < N; ++i) {
-        	for (size_t j = 0; j < N; ++j) {
-        		ZER(i,j) = std::real(LAMBD(i,j)) - (Real) B(i) * std::real(C(j)) / D;
-        	}
-        }
-
-        // Stores roetter. Lines 499-504
-        roetter = EigenSolver<MatrixXd>(ZER, false).eigenvalues();
-        if (options_.isStable()) {
-        	for (size_t i = 0; i < N; ++i) {
-        		const Real realPart = std::real(roetter(i));
-        		if (greater(realPart, 0.0)) {
-        			roetter(i) = roetter(i) - 2.0 * realPart;
-        		}
-        	}
-        }
-
-        // First pure real poles in ascending order.
-        // Then complex poles in ascending order by imaginary part.
-       // lines 508 - 524
-        std::vector<Real> auxReal;
-        std::vector<Complex> auxComplex;
-        for (size_t m = 0; m < N; ++m) {
-            if (equal(roetter(m).imag(), 0.0)) {
-                auxReal.push_back(roetter(m).real());
-            } else {
-                auxComplex.push_back(roetter(m));
-            }
-        }
-        std::sort(auxReal.begin(), auxReal.end());
-        std::sort(auxComplex.begin(), auxComplex.end(), complexOrdering);
-        for (size_t m = 0; m < auxReal.size(); ++m) {
-            roetter(m) = auxReal[m];
-        }
-        for (size_t m = 0; m < auxComplex.size(); ++m) {
-            roetter(m + auxReal.size()) = auxComplex[m];
-        }
-        // Stores results for poles.
+        roetter = toEigenVector(zerosOfSigma(x, &trace.flippedPoles));
         SERA = roetter;
-
+        trace.poleShift = poleShift(poles_, toStdVector(roetter));
     } // End of if for "skip pole identification" flag.
 
     // --- Residue identification ---
-    if (!options_.isSkipResidueIdentification()) {
+    if (identifyResidues) {
         // We now calculate SER for f, using the modified zeros of sigma
         // as new poles.
         const VectorXcd& LAMBD = roetter;
@@ -401,23 +226,21 @@ void Fitting::fit(){
 
         // We now calculate the SER for f (new fitting), using the above
         // calculated zeros as known poles.
-        MatrixXcd Dk = MatrixXcd::Zero(Ns,N);
-        for (size_t m = 0; m < N; ++m) {
-            for (size_t i = 0; i < Ns; ++i) {
-                if (cindex(m) == 0) {
-                    Dk(i,m) = Complex(1,0) / (samples_[i].first - LAMBD(m));
-                } else if (cindex(m) == 1) {
-                    Dk(i,m)   = Complex(1,0) / (samples_[i].first - LAMBD(m)) +
-                            Complex(1,0) / (samples_[i].first - std::conj(LAMBD(m)));
-                    Dk(i,m+1) = Complex(0,1) / (samples_[i].first - LAMBD(m)) -
-                            Complex(0,1) / (samples_[i].first - std::conj(LAMBD(m)));
-                }
-            }
+        const MatrixXcd Dk = buildBasis_(toStdVector(LAMBD));
+        MatrixXd toPF;
+        if (options_.getBasis() == Options::Basis::orthonormal) {
+            toPF = toPartialFractions_(toStdVector(LAMBD));
         }
 
         MatrixXcd C  = MatrixXcd::Zero(Nc,N);
         for (size_t n = 0; n < Nc; ++n) {
-            VectorXcd BB = VectorXcd::Zero(2*Ns);
+            checkpoint_();
+            const VectorXcd f = getResponseColumn(n);
+            const VectorXd w = weights_.isUniform() ?
+                    VectorXd() : weights_.column(n);
+            VectorXcd BB(2*Ns);
+            BB.head(Ns) = f.real().cast<Complex>();
+            BB.tail(Ns) = f.imag().cast<Complex>();
             MatrixXcd A;
             switch (options_.getAsymptoticTrend()) {
             case Options::AsymptoticTrend::zero:
@@ -432,10 +255,8 @@ void Fitting::fit(){
             }
             for (size_t i = 0; i < Ns; ++i) {
                 for (size_t j = 0; j < N; ++j) {
-                    A (i    ,j) =   std::real(Dk(i,j)) * useWeight_(i,n);
-                    A (i+Ns ,j) =   std::imag(Dk(i,j)) * useWeight_(i,n);
-                    BB(i)    = std::real(samples_[i].second(n)) * useWeight_(i,n);
-                    BB(i+Ns) = std::imag(samples_[i].second(n)) * useWeight_(i,n);
+                    A (i    ,j) =   std::real(Dk(i,j));
+                    A (i+Ns ,j) =   std::imag(Dk(i,j));
                 }
             }
             switch (options_.getAsymptoticTrend()) {
@@ -443,19 +264,23 @@ void Fitting::fit(){
                 break;
             case Options::AsymptoticTrend::constant:
                 for (size_t i = 0; i < Ns; ++i) {
-                    A(i,    N) = 1.0 * useWeight_(i,n);
-                    A(i+Ns, N) = 0.0 * useWeight_(i,n);
+                    A(i,    N) = 1.0;
+                    A(i+Ns, N) = 0.0;
                 }
                 break;
             case Options::AsymptoticTrend::linear:
                 for (size_t i = 0; i < Ns; ++i) {
-                    A(i,    N  ) = 1.0 * useWeight_(i,n);
-                    A(i+Ns, N  ) = 0.0 * useWeight_(i,n);
-                    A(i,    N+1) = std::real(samples_[i].first) * useWeight_(i,n);
-                    A(i+Ns, N+1) = std::imag(samples_[i].first) * useWeight_(i,n);
+                    A(i,    N  ) = 1.0;
+                    A(i+Ns, N  ) = 0.0;
+                    A(i,    N+1) = std::real(samples_[i].first);
+                    A(i+Ns, N+1) = std::imag(samples_[i].first);
                 }
                 break;
             }
+            Weights::scaleRows(A,  0,  w);
+            Weights::scaleRows(A,  Ns, w);
+            Weights::scaleRows(BB, 0,  w);
+            Weights::scaleRows(BB, Ns, w);
 
             // Computes scaling factor.Line 624
             VectorXd Escale(A.cols());
@@ -464,10 +289,19 @@ void Fitting::fit(){
                 A.col(col) /= Escale(col);
             }
 
-            MatrixXcd X = A.householderQr().solve(BB);
+            MatrixXcd X;
+            if (options_.isSketching()) {
+                X = Sketch::solve(A.real(), BB.real(), n).cast<Complex>();
+            } else {
+                X = A.householderQr().solve(BB);
+            }
             for (int i = 0; i < A.cols(); ++i) {
                 X(i) /= Escale(i);
             }
+            if (toPF.size() != 0) {
+                const VectorXd c = toPF * X.col(0).head(N).real();
+                X.col(0).head(N) = c.cast<Complex>();
+            }
 
             // Stores results for response;
             for (size_t i = 0; i < N; ++i) {
@@ -519,12 +353,16 @@ void Fitting::fit(){
         A_(i,i) = SERA(i);
         poles_[i] = SERA(i);
     }
-    if (!options_.isSkipResidueIdentification()) {
+    if (identifyResidues) {
         B_ = SERB;
         C_ = SERC;
         D_ = SERD;
         E_ = SERE;
-    } else {
+        if (observer != nullptr) {
+            trace.rmse = getRMSE();
+        }
+    }
+    if (options_.isSkipResidueIdentification()) {
         B_ = VectorXi::Ones(N);
         C_ = MatrixXcd::Zero(Nc, N);
         D_ = VectorXcd::Zero(Nc);
@@ -562,6 +400,12 @@ void Fitting::fit(){
             n++;
         }
     }
+
+    if (observer != nullptr) {
+        trace.seconds = std::chrono::duration<double>(
+                std::chrono::steady_clock::now() - start).count();
+        control_->observe(trace);
+    }
 }
 
 /**
@@ -598,7 +442,7 @@ std::vector<Fitting::Sample> Fitting::getFittedSamples() const {
     return res;
 }
 
-std::vector<Complex> Fitting::getPoles() {
+const std::vector<Complex>& Fitting::getPoles() const {
     return poles_;
 }
 
@@ -611,13 +455,12 @@ Real Fitting::getRMSE() const {
     std::vector<Sample> fittedSamples = getFittedSamples();
 
     Real error = 0.0;
-    for (size_t i = 0; i < samples_.size(); i++) {
-        for (VectorXcd::Index j = 0; j < samples_[i].second.size(); j++) {
-            Complex actual = samples_[i].second[j];
-            Complex fitted = fittedSamples[i].second[j];
-            Complex diff = actual - fitted;
-            error += abs(diff * diff);
+    VectorXcd fitted(samples_.size());
+    for (size_t j = 0; j < getResponseSize(); j++) {
+        for (size_t i = 0; i < samples_.size(); i++) {
+            fitted(i) = fittedSamples[i].second[j];
         }
+        error += (getResponseColumn(j) - fitted).squaredNorm();
     }
 
     return sqrt(error/((Real)(samples_.size() * samples_.size())));
@@ -625,27 +468,55 @@ Real Fitting::getRMSE() const {
 
 Real Fitting::getMaxDeviation() const {
     std::vector<Sample> fittedSamples = getFittedSamples();
-    std::vector<Real> dev(fittedSamples.size(), 0.0);
+    VectorXd dev = VectorXd::Zero(fittedSamples.size());
+
+    VectorXcd fitted(fittedSamples.size());
+    for (size_t j = 0; j < getResponseSize(); ++j) {
+        for (size_t i = 0; i < fittedSamples.size(); ++i) {
+            fitted(i) = fittedSamples[i].second[j];
+        }
+        dev = dev.cwiseMax((getResponseColumn(j) - fitted).cwiseAbs());
+    }
+    return dev.maxCoeff();
+}
 
-    for (size_t i = 0; i < fittedSamples.size(); ++i) {
-        std::vector<Real> sampleDev(getResponseSize(), 0.0);
-        for (size_t j = 0; j < getResponseSize(); ++j) {
-            sampleDev[j] = std::abs(
-                    samples_[i].second[j] - fittedSamples[i].second[j]);
+VectorXcd Fitting::getResponseColumn(const size_t n) const {
+    const size_t Ns = samples_.size();
+    if (view_.data != nullptr) {
+        VectorXcd res(Ns);
+        for (size_t i = 0; i < Ns; ++i) {
+            res(i) = view_(i, n);
         }
-        dev[i] = *std::max_element(sampleDev.begin(), sampleDev.end());
+        return res;
     }
-    return *std::max_element(dev.begin(), dev.end());
+    if (singlePrecision_) {
+        return singleResponses_.col(n).cast<Complex>();
+    }
+    VectorXcd res(Ns);
+    for (size_t i = 0; i < Ns; ++i) {
+        res(i) = samples_[i].second(n);
+    }
+    return res;
 }
 
 size_t Fitting::getSamplesSize() const {
     return samples_.size();
 }
 
+const std::vector<Fitting::Sample>& Fitting::getSamples() const {
+    return samples_;
+}
+
 size_t Fitting::getResponseSize() const {
     if (samples_.size() == 0) {
     	throw std::runtime_error("Response size is equal to zero");
     }
+    if (view_.data != nullptr) {
+        return view_.responses;
+    }
+    if (singlePrecision_) {
+        return singleResponses_.cols();
+    }
     return samples_.front().second.size();
 }
 
@@ -653,6 +524,599 @@ size_t Fitting::getOrder() const {
     return (size_t) poles_.size();
 }
 
+/**
+ * Basis of the pole identification evaluated at the samples: partial
+ * fractions of the current poles, real for conjugated pairs, followed by the
+ * asymptotic terms.
+ */
+MatrixXcd Fitting::buildDk_() const {
+    const size_t Ns = getSamplesSize();
+    const size_t N  = getOrder();
+
+    MatrixXcd Dk;
+    switch (options_.getAsymptoticTrend()) {
+    case Options::AsymptoticTrend::zero:
+    case Options::AsymptoticTrend::constant:
+        Dk = MatrixXcd::Zero(Ns,N+1);
+        break;
+    case Options::AsymptoticTrend::linear:
+        Dk = MatrixXcd::Zero(Ns,N+2);
+        break;
+    }
+
+    Dk.leftCols(N) = buildBasis_(poles_);
+    for (size_t i = 0; i < Ns; ++i) {
+        Dk(i,N) = (Real) 1.0;
+        if (options_.getAsymptoticTrend() ==
+                Options::AsymptoticTrend::linear) {
+            Dk(i,N+1) = samples_[i].first;
+        }
+    }
+    return Dk;
+}
+
+/**
+ * Functions of the basis evaluated at the samples, Ns x N. Partial
+ * fractions are real for conjugated pairs:
+ *     1/(s-p) + 1/(s-p*),  j/(s-p) - j/(s-p*)
+ * Orthonormal functions are partial fractions of increasing order which
+ * are products of the all-pass factors of the previous poles,
+ *     B_m(s) = prod_{k<m} (s + p_k*) / (s - p_k),
+ * by sqrt(2|Re p_m|) and 1/(s-p_m) for real poles, (s -|p_m|)/((s-p_m)(s-p_m*))
+ * and (s +|p_m|)/((s-p_m)(s-p_m*)) for conjugated pairs.
+ */
+MatrixXcd Fitting::buildBasis_(const std::vector<Complex>& poles) const {
+    const size_t Ns = getSamplesSize();
+    const size_t N  = poles.size();
+    const RowVectorXi cindex = getCIndex(poles);
+    const bool orthonormal =
+            options_.getBasis() == Options::Basis::orthonormal;
+
+    MatrixXcd res(Ns, N);
+    for (size_t i = 0; i < Ns; ++i) {
+        const Complex s = samples_[i].first;
+        Complex allPass(1.0, 0.0);
+        for (size_t m = 0; m < N; ++m) {
+            const Complex p = poles[m];
+            if (!orthonormal) {
+                if (cindex(m) == 0) {
+                    res(i,m) = Complex(1,0) / (s - p);
+                } else if (cindex(m) == 1) {
+                    res(i,m)   = Complex(1,0) / (s - p)
+                               + Complex(1,0) / (s - std::conj(p));
+                    res(i,m+1) = Complex(0,1) / (s - p)
+                               - Complex(0,1) / (s - std::conj(p));
+                }
+                continue;
+            }
+            const Real norm = std::abs(p.real()) > 0.0 ?
+                    std::sqrt(2.0 * std::abs(p.real())) : 1.0;
+            if (cindex(m) == 0) {
+                res(i,m) = norm / (s - p) * allPass;
+                allPass *= (s + std::conj(p)) / (s - p);
+            } else if (cindex(m) == 1) {
+                const Complex common =
+                        norm / ((s - p) * (s - std::conj(p))) * allPass;
+                res(i,m)   = common * (s - std::abs(p));
+                res(i,m+1) = common * (s + std::abs(p));
+                allPass *= (s + std::conj(p)) / (s - p)
+                         * (s + p) / (s - std::conj(p));
+            }
+        }
+    }
+    return res;
+}
+
+/**
+ * Coefficients in the partial fractions basis of each orthonormal function,
+ * N x N. Column m holds the residues of function m at the poles, as real
+ * and imaginary parts for conjugated pairs. Poles must be distinct.
+ */
+MatrixXd Fitting::toPartialFractions_(const std::vector<Complex>& poles) {
+    const size_t N = poles.size();
+    const RowVectorXi cindex = getCIndex(poles);
+
+    MatrixXd res = MatrixXd::Zero(N, N);
+    for (size_t m = 0; m < N; ++m) {
+        if (cindex(m) == 2) {
+            continue;
+        }
+        const Complex p = poles[m];
+        const Real norm = std::abs(p.real()) > 0.0 ?
+                std::sqrt(2.0 * std::abs(p.real())) : 1.0;
+        const size_t last = (cindex(m) == 1) ? m+1 : m;
+        // Function m, or the pair m, m+1, is g(s) / prod_{k<=last} (s-p_k).
+        for (size_t f = m; f <= last; ++f) {
+            for (size_t j = 0; j <= last; ++j) {
+                if (cindex(j) == 2) {
+                    continue;
+                }
+                const Complex s = poles[j];
+                Complex g = norm;
+                if (cindex(m) == 1) {
+                    g *= (f == m) ? (s - std::abs(p)) : (s + std::abs(p));
+                }
+                for (size_t k = 0; k < m; ++k) {
+                    g *= s + std::conj(poles[k]);
+                }
+                for (size_t k = 0; k <= last; ++k) {
+                    if (k != j) {
+                        g /= s - poles[k];
+                    }
+                }
+                res(j,f) = g.real();
+                if (cindex(j) == 1) {
+                    res(j+1,f) = g.imag();
+                }
+            }
+        }
+    }
+    return res;
+}
+
+size_t Fitting::getOffset_() const {
+    switch (options_.getAsymptoticTrend()) {
+    case Options::AsymptoticTrend::zero:
+        return 0;
+    case Options::AsymptoticTrend::constant:
+        return 1;
+    case Options::AsymptoticTrend::linear:
+    default:
+        return 2;
+    }
+}
+
+/**
+ * Reduces the pole identification system of responses [first, last). The
+ * residues of each response are eliminated with a QR decomposition, only
+ * the rows involving the coefficients of sigma are kept. Systems of
+ * different responses are independent: threads reduce disjoint sets of
+ * responses, folding each block into their own R factor as it is produced,
+ * and the factors of the threads are merged pairwise. Memory is O(N^2) per
+ * thread, independently of the number of responses.
+ * @param dNew  Zero for the relaxed system, otherwise the constant term of
+ *              sigma.
+ */
+Fitting::Reduction Fitting::reduce(const size_t first,
+                                   const size_t last,
+                                   const Real dNew) const {
+    if (first > last || last > getResponseSize()) {
+        throw std::runtime_error("Invalid range of responses");
+    }
+    const MatrixXcd Dk = buildDk_();
+
+    size_t nThreads = 1;
+#ifdef _OPENMP
+    nThreads = omp_get_max_threads();
+#endif
+    nThreads = std::max((size_t) 1, std::min(nThreads, last - first));
+
+    std::vector<Reduction> partial(nThreads);
+    std::vector<std::exception_ptr> errors(nThreads);
+#pragma omp parallel num_threads(nThreads) if(nThreads > 1)
+    {
+        size_t t = 0;
+#ifdef _OPENMP
+        t = omp_get_thread_num();
+#endif
+#pragma omp for schedule(static)
+        for (long n = first; n < (long) last; ++n) {
+            if (errors[t]) {
+                continue;
+            }
+            try {
+                Reduction block = reduceResponse_(Dk, n, dNew);
+                partial[t] = (partial[t].A.size() == 0) ?
+                        block : merge({partial[t], block});
+            } catch (...) {
+                errors[t] = std::current_exception();
+            }
+        }
+    }
+    for (size_t t = 0; t < nThreads; ++t) {
+        if (errors[t]) {
+            std::rethrow_exception(errors[t]);
+        }
+    }
+    return merge(partial);
+}
+
+/**
+ * R22 block of response n and the corresponding rows of the right hand
+ * side, which is zero for the relaxed system.
+ */
+Fitting::Reduction Fitting::reduceResponse_(const MatrixXcd& Dk,
+                                            const size_t n,
+                                            const Real dNew) const {
+    checkpoint_();
+    const size_t Ns = getSamplesSize();
+    const size_t N  = getOrder();
+    const size_t offs = getOffset_();
+    const size_t cols = (dNew == 0.0) ? N+1 : N;
+
+    Reduction res;
+    // The conjugated responses enter the system with the fixed constant.
+    VectorXcd f = getResponseColumn(n);
+    if (dNew != 0.0) {
+        f = f.conjugate();
+    }
+    const VectorXd w = weights_.isUniform() ?
+            VectorXd() : weights_.column(n);
+    VectorXd mag = f.cwiseAbs();
+    Weights::scaleRows(mag, 0, w);
+    res.magnitude = mag.squaredNorm();
+
+    // Corresponding line in vectfit3.m code: 319
+    MatrixXd A(2*Ns, N+offs+cols);
+    for (size_t m = 0; m < N+offs; ++m) {
+        for (size_t i = 0; i < Ns; ++i) {
+            A(i,    m) = std::real(Dk(i,m));
+            A(i+Ns, m) = std::imag(Dk(i,m));
+        }
+    }
+    const size_t inda = N + offs;
+    VectorXd b = VectorXd::Zero(2*Ns);
+    for (size_t m = 0; m < cols; ++m) {
+        const VectorXcd entry = - Dk.col(m).cwiseProduct(f);
+        A.col(inda+m).head(Ns) = entry.real();
+        A.col(inda+m).tail(Ns) = entry.imag();
+    }
+    if (dNew != 0.0) {
+        b.head(Ns) = dNew * f.real();
+        b.tail(Ns) = dNew * f.imag();
+    }
+    Weights::scaleRows(A, 0,  w);
+    Weights::scaleRows(A, Ns, w);
+    Weights::scaleRows(b, 0,  w);
+    Weights::scaleRows(b, Ns, w);
+
+    // With enough samples, R22 comes from the QR of a sketch of [A b],
+    // provided that it still preconditions A well.
+    if (options_.isSketching() &&
+            Sketch::isWorthwhile(A.rows(), A.cols() + 1)) {
+        MatrixXd Ab(A.rows(), A.cols() + 1);
+        Ab << A, b;
+        MatrixXd SAb = Sketch(A.rows(), Sketch::sketchRows(Ab.cols()), n)
+                .apply(Ab);
+        const HouseholderQR<MatrixXd> qr(SAb.leftCols(A.cols()));
+        const MatrixXd R = qr.matrixQR().topRows(A.cols())
+                .triangularView<Upper>();
+        // Test vectors of the guard are drawn apart from the sketch, as in
+        // Sketch::solve.
+        if (Sketch::isEmbedding(A, R, n + 1)) {
+            VectorXd Sb = SAb.col(A.cols());
+            Sb.applyOnTheLeft(qr.householderQ().adjoint());
+            res.A = R.block(inda, inda, cols, cols);
+            res.b = Sb.segment(inda, cols);
+            return res;
+        }
+    }
+
+    // Performs QR decomposition. Line 350
+    HouseholderQR<MatrixXd> qr(A.rows(), A.cols());
+    qr.compute(A);
+    const MatrixXd Q = qr.householderQ() *
+            MatrixXd::Identity(A.rows(), A.cols());
+    const MatrixXd R = Q.transpose() * A;
+    res.A = R.block(inda, inda, cols, cols);
+    res.b = Q.block(0, inda, A.rows(), cols).transpose() * b;
+    return res;
+}
+
+/**
+ * Merges the reductions of disjoint sets of responses. Pairs are stacked
+ * and compressed back to a triangular factor with a QR decomposition, which
+ * keeps the least squares solution and the norms of the columns. Each
+ * level of the tree merges its pairs in parallel.
+ */
+Fitting::Reduction Fitting::merge(const std::vector<Reduction>& parts) {
+    std::vector<Reduction> level;
+    for (size_t p = 0; p < parts.size(); ++p) {
+        if (parts[p].A.size() != 0) {
+            level.push_back(parts[p]);
+        }
+    }
+    if (level.empty()) {
+        return Reduction();
+    }
+    for (size_t p = 1; p < level.size(); ++p) {
+        if (level[p].A.cols() != level[0].A.cols()) {
+            throw std::runtime_error("Reductions of different systems");
+        }
+    }
+
+    while (level.size() > 1) {
+        std::vector<Reduction> next((level.size() + 1) / 2);
+#pragma omp parallel for schedule(static) if(level.size() > 3)
+        for (long i = 0; i < (long) level.size() / 2; ++i) {
+            const Reduction& lhs = level[2*i];
+            const Reduction& rhs = level[2*i+1];
+            Reduction& res = next[i];
+            res.magnitude = lhs.magnitude + rhs.magnitude;
+            MatrixXd A(lhs.A.rows() + rhs.A.rows(), lhs.A.cols());
+            VectorXd b(A.rows());
+            A << lhs.A, rhs.A;
+            b << lhs.b, rhs.b;
+            if (A.rows() <= A.cols()) {
+                res.A.swap(A);
+                res.b.swap(b);
+                continue;
+            }
+            HouseholderQR<MatrixXd> qr(A);
+            res.A = qr.matrixQR().topRows(A.cols())
+                    .triangularView<Upper>();
+            b.applyOnTheLeft(qr.householderQ().adjoint());
+            res.b = b.head(A.cols());
+        }
+        if (level.size() % 2 == 1) {
+            next.back() = level.back();
+        }
+        level.swap(next);
+    }
+    return level.front();
+}
+
+/**
+ * Solves the reduced system for the coefficients of sigma: its N residues
+ * and its constant term. The relaxed system adds the integral criterion
+ * for sigma, which is scaled with the magnitude of all the responses.
+ * @param condition  Estimate of the condition number of the scaled system
+ *                   (optional).
+ */
+VectorXd Fitting::solveSigma(const Reduction& reduction,
+                             const Real dNew,
+                             Real* condition) const {
+    return solveSigma(reduction,
+                      (dNew == 0.0) ? basisSums() : VectorXd(),
+                      getSamplesSize(), poles_, options_, dNew, condition);
+}
+
+VectorXd Fitting::basisSums() const {
+    const MatrixXcd Dk = buildDk_();
+    VectorXd res(getOrder() + 1);
+    for (size_t mm = 0; mm < getOrder() + 1; ++mm) {
+        res(mm) = std::real(Dk.col(mm).sum());
+    }
+    return res;
+}
+
+VectorXd Fitting::solveSigma(const Reduction& reduction,
+                             const VectorXd& basisSums,
+                             const size_t Ns,
+                             const std::vector<Complex>& poles,
+                             const Options& options,
+                             const Real dNew,
+                             Real* condition) {
+    const size_t N  = poles.size();
+
+    MatrixXd AA;
+    VectorXd bb;
+    if (dNew == 0.0) {
+        if ((size_t) basisSums.size() != N+1) {
+            throw std::runtime_error("Sums of the basis must have N+1 values");
+        }
+        const Real scale = std::sqrt(reduction.magnitude) / (Real) Ns;
+        AA.resize(reduction.A.rows() + 1, N+1);
+        bb.resize(reduction.A.rows() + 1);
+        AA.topRows(reduction.A.rows()) = reduction.A;
+        bb.head(reduction.A.rows()) = reduction.b;
+        AA.row(reduction.A.rows()) = scale * basisSums.transpose();
+        bb(reduction.A.rows()) = (Real) Ns * scale;
+    } else {
+        AA = reduction.A;
+        bb = reduction.b;
+    }
+
+    // Computes scaling factor. Line 360
+    VectorXd Escale(AA.cols());
+    for (MatrixXd::Index col = 0; col < AA.cols(); ++col) {
+        Escale(col) = 1.0 / AA.col(col).norm();
+        AA.col(col) *= Escale(col);
+    }
+    const HouseholderQR<MatrixXd> qr(AA);
+    VectorXd x = qr.solve(bb);
+    x.array() *= Escale.array();
+    if (options.getBasis() == Options::Basis::orthonormal) {
+        x.head(N) = toPartialFractions_(poles) * x.head(N);
+    }
+    if (condition != nullptr) {
+        // Ratio of the extreme diagonal entries of R, a lower bound of the
+        // condition number of the scaled system.
+        const VectorXd diag = qr.matrixQR().diagonal().cwiseAbs();
+        *condition = (diag.minCoeff() > 0.0) ?
+                diag.maxCoeff() / diag.minCoeff() :
+                std::numeric_limits<Real>::infinity();
+    }
+
+    if (dNew != 0.0) {
+        x.conservativeResize(N+1);
+        x(N) = dNew;
+    }
+    return x;
+}
+
+/**
+ * Constant term of sigma to impose when the relaxed solution x is not
+ * usable or relaxation is disabled, zero otherwise. Line 372
+ */
+Real Fitting::fixedConstant(const VectorXd& x) const {
+    return fixedConstant(x, options_, getOrder());
+}
+
+Real Fitting::fixedConstant(const VectorXd& x,
+                            const Options& options,
+                            const size_t N) {
+    if (!options.isRelax()) {
+        return 1.0;
+    }
+    if (!lower(std::abs(x(N)), toleranceLow_) &&
+            !greater(std::abs(x(N)), toleranceHigh_)) {
+        return 0.0;
+    }
+    Real Dnew;
+    if (std::abs(x(N)) < toleranceLow_) {
+        Dnew = 1.0;
+    } else if (lower  (std::abs(x(N)), toleranceLow_)) {
+        std::signbit(x(N)) ?
+                Dnew = toleranceLow_ : Dnew  = - toleranceLow_;
+    } else if (greater(std::abs(x(N)), toleranceHigh_)) {
+        std::signbit(x(N)) ?
+                Dnew = toleranceHigh_ : Dnew = - toleranceHigh_;
+    } else {
+        throw std::runtime_error("Can not relax constant term");
+    }
+    return Dnew;
+}
+
+/**
+ * Largest distance from a pole in current to the closest one in previous,
+ * relative to the magnitude of the former.
+ */
+Real Fitting::poleShift(const std::vector<Complex>& previous,
+                        const std::vector<Complex>& current) {
+    if (previous.size() != current.size()) {
+        return std::numeric_limits<Real>::infinity();
+    }
+    Real res = 0.0;
+    for (size_t i = 0; i < current.size(); ++i) {
+        Real closest = std::numeric_limits<Real>::infinity();
+        for (size_t j = 0; j < previous.size(); ++j) {
+            closest = std::min(closest, std::abs(current[i] - previous[j]));
+        }
+        const Real mag = std::abs(current[i]);
+        res = std::max(res, (mag > 0.0) ? closest / mag : closest);
+    }
+    return res;
+}
+
+/**
+ * Zeros of sigma, which are the relocated poles. Unstable ones are flipped
+ * when required. Real poles come first in ascending order, then complex
+ * ones in ascending order by imaginary part.
+ * @param flipped  Incremented with each unstable pole flipped (optional).
+ */
+std::vector<Complex> Fitting::zerosOfSigma(const VectorXd& x,
+                                           size_t* flipped) const {
+    return zerosOfSigma(x, poles_, options_, flipped);
+}
+
+std::vector<Complex> Fitting::zerosOfSigma(const VectorXd& x,
+                                           const std::vector<Complex>& poles,
+                                           const Options& options,
+                                           size_t* flipped) {
+    const size_t N = poles.size();
+    const RowVectorXi cindex = getCIndex(poles);
+    MatrixXcd LAMBD = MatrixXcd::Zero(N, N);
+    for (size_t i = 0; i < N; ++i) {
+        LAMBD(i,i) = poles[i];
+    }
+    VectorXcd roetter;
+
+    VectorXcd C = x.head(N).cast<Complex>(); // Line 433
+    for (size_t m = 0; m < N; ++m) {
+        if (cindex(m) == 1) {
+            const Real r1 = std::real(C(m  ));
+            const Real r2 = std::real(C(m+1));
+            C(m)   = Complex(r1,  r2);
+            C(m+1) = Complex(r1, -r2);
+        }
+    }
+    Real D = x(N);
+
+    // Calculates the zeros for sigma. Line 481
+    // The structured solver works on the pole-residue form of sigma,
+    // the dense eigensolver on ZER is kept as a fallback.
+    SecularSolver secular(poles, toStdVector(C), D);
+    if (secular.solve()) {
+        roetter = toEigenVector(secular.getZeros());
+    } else {
+        VectorXi B = VectorXi::Ones(N);
+        size_t m = 0;
+        for (size_t n = 0; n < N; ++n) {
+            if (m < N) {
+                if (greater(std::abs(LAMBD(m,m)),
+                            std::abs(std::real(LAMBD(m,m))))) {
+                    LAMBD(m+1,m  ) = - std::imag(LAMBD(m,m));
+                    LAMBD(m  ,m+1) =   std::imag(LAMBD(m,m));
+                    LAMBD(m  ,m  ) =   std::real(LAMBD(m,m));
+                    LAMBD(m+1,m+1) =             LAMBD(m,m);
+                    B(m  ) = 2;
+                    B(m+1) = 0;
+                    const Complex aux = C(m);
+                    C(m  ) = std::real(aux);
+                    C(m+1) = std::imag(aux);
+                    m++;
+                }
+            }
+            m++;
+        }
+
+        // Checks LAMBD and C are purely real.
+        for (size_t i = 0; i < N; ++i) {
+            for (size_t j = 0; j < N; ++j) {
+                if (!equal(std::imag(LAMBD(i,j)), 0.0)) {
+                    throw std::runtime_error("LAMBD is not purely real");
+                }
+            }
+        }
+        for (size_t i = 0; i < N; ++i) {
+            if (!equal(std::imag(C(i)), 0.0)) {
+                throw std::runtime_error("LAMBD is not purely real");
+            }
+        }
+
+        MatrixXd ZER = MatrixXd::Zero(N,N);//Line 498
+        for (size_t i = 0; i < N; ++i) {
+        	for (size_t j = 0; j < N; ++j) {
+        		ZER(i,j) = std::real(LAMBD(i,j)) - (Real) B(i) * std::real(C(j)) / D;
+        	}
+        }
+
+        // Stores roetter. Lines 499-504
+        roetter = EigenSolver<MatrixXd>(ZER, false).eigenvalues();
+    }
+
+    if (options.isStable()) {
+    	for (size_t i = 0; i < N; ++i) {
+    		const Real realPart = std::real(roetter(i));
+    		if (greater(realPart, 0.0)) {
+    			roetter(i) = roetter(i) - 2.0 * realPart;
+    			if (flipped != nullptr) {
+    			    ++*flipped;
+    			}
+    		}
+    	}
+    }
+
+    // First pure real poles in ascending order.
+    // Then complex poles in ascending order by imaginary part.
+   // lines 508 - 524
+    std::vector<Real> auxReal;
+    std::vector<Complex> auxComplex;
+    for (size_t m = 0; m < N; ++m) {
+        if (equal(roetter(m).imag(), 0.0)) {
+            auxReal.push_back(roetter(m).real());
+        } else {
+            auxComplex.push_back(roetter(m));
+        }
+    }
+    std::sort(auxReal.begin(), auxReal.end());
+    std::sort(auxComplex.begin(), auxComplex.end(), ComplexOrdering());
+    for (size_t m = 0; m < auxReal.size(); ++m) {
+        roetter(m) = auxReal[m];
+    }
+    for (size_t m = 0; m < auxComplex.size(); ++m) {
+        roetter(m + auxReal.size()) = auxComplex[m];
+    }
+    return toStdVector(roetter);
+}
+
+void Fitting::checkpoint_() const {
+    if (control_ != nullptr) {
+        control_->checkpoint();
+    }
+}
+
 RowVectorXi Fitting::getCIndex(const std::vector<Complex>& poles) {
     const size_t N = poles.size();
     RowVectorXi cindex = RowVectorXi::Zero(N);
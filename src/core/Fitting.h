@@ -24,6 +24,7 @@
 #ifndef VECTOR_FITTING_FITTING_H_
 #define VECTOR_FITTING_FITTING_H_
 
+#include <cstddef>
 #include <vector>
 #include <complex>
 #include <algorithm>
@@ -31,16 +32,19 @@
 
 #include "Real.h"
 #include "Options.h"
+#include "Weights.h"
+#include "Control.h"
 
 namespace VectorFitting {
 
 using namespace Eigen;
 
-typedef std::complex<Real> Complex;
-
 
 class Fitting {
     friend class Driver;
+    friend class IncrementalFitting;
+    friend class Pruning;
+    friend class Sweep;
 public:
 	/**
 	 * Samples are formed by a pair formed by:
@@ -58,32 +62,177 @@ public:
      * @param options   Options.
      * @param poles     Starting poles (optional).
      * @param weights   Samples weights (optional).
+     *
+     * Samples given as rvalues are taken over without copying them. Weights
+     * are reordered along with the samples when these are not sorted.
      */
     Fitting(const std::vector<Sample>& samples,
             const Options& options,
             const std::vector<Complex>& poles = {},
 			const std::vector<VectorXd>& weights = {});
+    Fitting(std::vector<Sample>&& samples,
+            const Options& options,
+            const std::vector<Complex>& poles = {},
+            const std::vector<VectorXd>& weights = {});
+    Fitting(const std::vector<Sample>& samples,
+            const Options& options,
+            const std::vector<Complex>& poles,
+            const Weights& weights);
+    Fitting(std::vector<Sample>&& samples,
+            const Options& options,
+            const std::vector<Complex>& poles,
+            const Weights& weights);
+
+    /**
+     * Responses owned by the caller, which must outlive the fitting: the
+     * response n of sample i is data[i*sampleStride + n*responseStride].
+     * Strides may be negative.
+     */
+    struct ResponseView {
+        const Complex* data = nullptr;
+        size_t responses = 0;
+        std::ptrdiff_t sampleStride = 0;
+        std::ptrdiff_t responseStride = 0;
+
+        const Complex& operator()(const size_t i, const size_t n) const {
+            return data[(std::ptrdiff_t) i*sampleStride +
+                        (std::ptrdiff_t) n*responseStride];
+        }
+    };
+
+    /**
+     * Build a fitter which reads the responses from a view instead of
+     * copying them. Frequencies must be sorted, as the view cannot be.
+     * Single precision storage does not apply to views.
+     */
+    Fitting(const std::vector<Complex>& frequencies,
+            const ResponseView& responses,
+            const Options& options,
+            const std::vector<Complex>& poles,
+            const Weights& weights = Weights());
 
 
     // This could be called from the constructor, but if an iterative algorithm
     // is preferred, it's a good idea to have it as a public method
     void fit();
 
+    /**
+     * Steps of the pole identification, exposed so that the responses can
+     * be reduced apart, e.g. in other processes. fit() runs them as
+     *     x = solveSigma(reduce(0, Nc));
+     *     dNew = fixedConstant(x);
+     *     if (dNew != 0) x = solveSigma(reduce(0, Nc, dNew), dNew);
+     *     poles = zerosOfSigma(x);
+     * skipping the relaxed system when relaxation is disabled.
+     */
+    struct Reduction {
+        MatrixXd A;             // Triangular factor of the system for sigma.
+        VectorXd b;
+        Real magnitude = 0.0;   // Squared norm of the weighted responses.
+    };
+    Reduction reduce(const size_t first, const size_t last,
+                     const Real dNew = 0.0) const;
+    static Reduction merge(const std::vector<Reduction>& parts);
+    VectorXd solveSigma(const Reduction& reduction,
+                        const Real dNew = 0.0,
+                        Real* condition = nullptr) const;
+    Real fixedConstant(const VectorXd& x) const;
+    std::vector<Complex> zerosOfSigma(const VectorXd& x,
+                                      size_t* flipped = nullptr) const;
+    /**
+     * Sums over the samples of the basis functions of sigma, N+1 values.
+     * Along with the number of samples, it is all the relaxed system takes
+     * from the samples besides the reduction.
+     */
+    VectorXd basisSums() const;
+    /**
+     * Same as above for the given poles and options, which is all they
+     * depend on. basisSums is only read for the relaxed system.
+     */
+    static VectorXd solveSigma(const Reduction& reduction,
+                               const VectorXd& basisSums,
+                               const size_t Ns,
+                               const std::vector<Complex>& poles,
+                               const Options& options,
+                               const Real dNew = 0.0,
+                               Real* condition = nullptr);
+    static Real fixedConstant(const VectorXd& x,
+                              const Options& options,
+                              const size_t N);
+    static std::vector<Complex> zerosOfSigma(const VectorXd& x,
+                                             const std::vector<Complex>& poles,
+                                             const Options& options,
+                                             size_t* flipped = nullptr);
+    /**
+     * Relative displacement of the poles in current from those in
+     * previous, infinite when their numbers differ.
+     */
+    static Real poleShift(const std::vector<Complex>& previous,
+                          const std::vector<Complex>& current);
+
+    /**
+     * fit() polls the control between responses and throws
+     * Control::Interrupted when asked to stop. Results of the previous
+     * iteration are left untouched in that case. Control is not owned.
+     */
+    void setControl(const Control* control) {control_ = control;}
+
+    /**
+     * Labels the traces sent to the observer of the control, see Observer.
+     * Iteration is the one of the next fit and increases with each fit.
+     * By default fits are labeled as relocations numbered from 1.
+     */
+    void setStage(const Control::Stage stage, const size_t iteration) {
+        stage_ = stage;
+        iteration_ = iteration;
+    }
+
+    /**
+     * Evaluates the model at the sample frequencies. The result is built on
+     * each call, keep it when it is needed more than once.
+     */
     std::vector<Sample>  getFittedSamples() const;
 
-    std::vector<Complex> getPoles();
+    const std::vector<Complex>& getPoles() const;
+
+    /**
+     * Replaces the current poles, e.g. with poles relocated by a fitter
+     * working on another set of samples. Size must not change.
+     */
+    void setPoles(const std::vector<Complex>& poles);
 
     /**
-     *  Getters and setters to fitting coefficents.
+     *  Getters and setters to fitting coefficents. Getters return views
+     *  which are valid while the fitting lives and is not fitted again;
+     *  assign them to a matrix to keep a copy.
      */
-    MatrixXcd getA() const {return A_;}    // Size:  N, N.
-    MatrixXcd getC() const {return C_;}    // Size:  Nc, N.
-    VectorXi getB()  const {return B_;}    // Size:  1, N.
-    VectorXcd getD() const {return D_;}    // Size:  1, Nc.
-    VectorXcd getE() const {return E_;}    // Size:  1, Nc.
+    const MatrixXcd& getA() const {return A_;}    // Size:  N, N.
+    const MatrixXcd& getC() const {return C_;}    // Size:  Nc, N.
+    const VectorXi&  getB() const {return B_;}    // Size:  1, N.
+    const VectorXcd& getD() const {return D_;}    // Size:  1, Nc.
+    const VectorXcd& getE() const {return E_;}    // Size:  1, Nc.
     Real getRMSE() const;
     Real getMaxDeviation() const;
+    /**
+     * Samples sorted by frequency. Responses are empty when they are stored
+     * in single precision, see Options::setSinglePrecision(), or read from
+     * a view; read them with getResponse() in those cases.
+     */
 	const std::vector<Sample>& getSamples() const;
+	Complex getResponse(const size_t i, const size_t n) const {
+	    if (view_.data != nullptr) {
+	        return view_(i, n);
+	    }
+	    return singlePrecision_ ?
+	            (Complex) singleResponses_(i,n) : samples_[i].second(n);
+	}
+	/**
+	 * Response n of all samples, contiguous. Loops over the samples of a
+	 * response should gather it once with this instead of reading each
+	 * element with getResponse(), which checks where they are stored.
+	 */
+	VectorXcd getResponseColumn(const size_t n) const;
+	const Weights& getWeights() const {return weights_;}
 
 
     size_t getSamplesSize() const;
@@ -110,7 +259,45 @@ public:
         return res;
     }
 
+    /**
+     * Sorts samples by increasing frequency. Sorted input is detected in a
+     * single pass. Otherwise the frequencies are sorted as an index
+     * permutation and each sample is moved once to its place, so responses
+     * are neither compared nor copied.
+     * @return Original index of each sorted sample, empty when the samples
+     *         were already sorted.
+     */
+    template <class S>
+    static std::vector<size_t> sortSamples(std::vector<S>& samples) {
+        const size_t Ns = samples.size();
+        std::vector<Real> freq(Ns);
+        bool sorted = true;
+        for (size_t i = 0; i < Ns; ++i) {
+            freq[i] = samples[i].first.imag();
+            sorted &= (i == 0 || !lower(freq[i], freq[i-1]));
+        }
+        if (sorted) {
+            return std::vector<size_t>();
+        }
+        std::vector<size_t> perm(Ns);
+        for (size_t i = 0; i < Ns; ++i) {
+            perm[i] = i;
+        }
+        std::stable_sort(perm.begin(), perm.end(),
+                [&freq](const size_t a, const size_t b) {
+            return lower(freq[a], freq[b]);
+        });
+        std::vector<S> res;
+        res.reserve(Ns);
+        for (size_t i = 0; i < Ns; ++i) {
+            res.push_back(std::move(samples[perm[i]]));
+        }
+        samples.swap(res);
+        return perm;
+    }
+
     Options& options() {return options_;};
+    const Options& getOptions() const {return options_;}
 
 private:
     Options options_;
@@ -118,20 +305,39 @@ private:
     std::vector<Sample> samples_;
     std::vector<Complex> poles_;
 
+    // Responses in single precision, Ns x Nc, so that each response is
+    // contiguous. Samples keep only their frequencies then.
+    bool singlePrecision_ = false;
+    MatrixXcf singleResponses_;
+
+    ResponseView view_;
+
     MatrixXcd A_, C_;
     VectorXcd D_, E_;
-    MatrixXi B_;
+    VectorXi B_;
+
+    Weights weights_;
 
-    std::vector<VectorXd> weights_; // Size: Ns, Nc
+    const Control* control_ = nullptr;
+    Control::Stage stage_ = Control::Stage::relocation;
+    size_t iteration_ = 1;
 
     static constexpr Real toleranceLow_  = 1e-4;
     static constexpr Real toleranceHigh_ = 1e+4;
 
 
     static RowVectorXi getCIndex(const std::vector<Complex>& poles);
-
-    struct {
-        bool operator()(Complex a, Complex b)
+    MatrixXcd buildDk_() const;
+    MatrixXcd buildBasis_(const std::vector<Complex>& poles) const;
+    static MatrixXd toPartialFractions_(const std::vector<Complex>& poles);
+    Reduction reduceResponse_(const MatrixXcd& Dk, const size_t n,
+                              const Real dNew) const;
+    size_t getOffset_() const;
+    static void checkPoles_(const std::vector<Complex>& poles);
+    void checkpoint_() const;
+
+    struct ComplexOrdering {
+        bool operator()(Complex a, Complex b) const
         {
             if (lower(a.real(), b.real())) {
                 return true;
@@ -141,23 +347,13 @@ private:
             }
             return false;
         }
-    } complexOrdering;
+    };
 
     // Quick check to see if a Complex number is real
     static bool isReal(Complex n){
         return equal(n.imag(), 0.0);
     }
 
-    Real useWeight_(size_t i, VectorXd::Index n) {
-        if (weights_[i].size() > 1) {
-            return weights_[i](n);
-        } else if (weights_[i].size() == 1) {
-            return weights_[i](0);
-        } else {
-            throw std::runtime_error("Invalid weight operation");
-        }
-    }
-
 };
 
 } /* namespace VectorFitting */
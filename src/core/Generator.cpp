@@ -0,0 +1,211 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Alejandro García Montoro        (alejandro.garciamontoro@gmail.com)
+//					  Alejandra López de Aberasturi Gómez (aloaberasturi@ugr.es)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+#include "Generator.h"
+
+#include <algorithm>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+
+#include "SpaceGenerator.h"
+
+namespace VectorFitting {
+
+namespace {
+
+MatrixXcd randomSymmetric(std::mt19937_64& engine,
+                          const size_t Nc,
+                          const bool complex) {
+    std::normal_distribution<Real> normal;
+    MatrixXcd res(Nc, Nc);
+    for (size_t j = 0; j < Nc; ++j) {
+        for (size_t k = j; k < Nc; ++k) {
+            const Real re = normal(engine);
+            const Real im = complex ? normal(engine) : 0.0;
+            res(k,j) = Complex(re, im);
+            res(j,k) = res(k,j);
+        }
+    }
+    return res;
+}
+
+}
+
+Generator::Generator() {
+    order_   = 8;
+    ports_   = 2;
+    samples_ = 1000;
+    range_   = std::make_pair(1e3, 1e9);
+    spacing_ = Spacing::logarithmic;
+    trend_   = Options::AsymptoticTrend::constant;
+    noise_   = 0.0;
+    seed_    = 0;
+
+    generated_ = false;
+}
+
+void Generator::generate() {
+    if (order_ == 0 || ports_ == 0 || samples_ == 0) {
+        throw std::runtime_error(
+                "Order, ports and samples must be greater than zero");
+    }
+    if (!(range_.first < range_.second) ||
+            (spacing_ == Spacing::logarithmic && !(range_.first > 0.0))) {
+        throw std::runtime_error("Invalid range of frequencies");
+    }
+
+    std::mt19937_64 engine(seed_);
+    std::uniform_real_distribution<Real> uniform;
+    // Resonances are spread logarithmically when the range allows it.
+    const bool logarithmic = range_.first > 0.0;
+    auto frequency = [&]() {
+        const Real u = uniform(engine);
+        return logarithmic ?
+                range_.first * std::pow(range_.second / range_.first, u) :
+                range_.first + (range_.second - range_.first) * u;
+    };
+
+    std::vector<std::pair<Real, Real>> resonances(order_ / 2);
+    for (size_t m = 0; m < resonances.size(); ++m) {
+        resonances[m].first = frequency();
+        resonances[m].second = std::pow(10.0, -3.0 + 2.0 * uniform(engine));
+    }
+    std::sort(resonances.begin(), resonances.end());
+
+    poles_.clear();
+    residues_.clear();
+    // Residues are scaled with the bandwidth of their pole, so that all
+    // resonances peak at similar magnitudes.
+    if (order_ % 2 == 1) {
+        const Real w = frequency();
+        poles_.push_back(Complex(-w, 0.0));
+        residues_.push_back(w * randomSymmetric(engine, ports_, false));
+    }
+    for (size_t m = 0; m < resonances.size(); ++m) {
+        const Real w = resonances[m].first;
+        const Real damping = resonances[m].second * w;
+        const Complex pole(-damping, w);
+        const MatrixXcd residue =
+                damping * randomSymmetric(engine, ports_, true);
+        poles_.push_back(pole);
+        poles_.push_back(std::conj(pole));
+        residues_.push_back(residue);
+        residues_.push_back(residue.conjugate());
+    }
+
+    D_ = MatrixXcd::Zero(ports_, ports_);
+    E_ = MatrixXcd::Zero(ports_, ports_);
+    if (trend_ != Options::AsymptoticTrend::zero) {
+        D_ = randomSymmetric(engine, ports_, false);
+    }
+    if (trend_ == Options::AsymptoticTrend::linear) {
+        E_ = randomSymmetric(engine, ports_, false) / range_.second;
+    }
+    generated_ = true;
+}
+
+MatrixXcd Generator::evaluate(const Complex& s) const {
+    if (!generated_) {
+        throw std::runtime_error("Model has not been generated");
+    }
+    MatrixXcd res = D_ + s * E_;
+    for (size_t m = 0; m < poles_.size(); ++m) {
+        res += residues_[m] / (s - poles_[m]);
+    }
+    return res;
+}
+
+std::vector<Real> Generator::getFrequencies() const {
+    if (spacing_ == Spacing::linear) {
+        return linspace(range_, samples_);
+    }
+    return logspace(std::make_pair(std::log10(range_.first),
+                                   std::log10(range_.second)),
+                    samples_);
+}
+
+/**
+ * Calls f with each sample in ascending frequency. Noise is drawn in that
+ * order, so that every output gets the same samples.
+ */
+template<class F>
+void Generator::forEachSample_(F f) const {
+    if (!generated_) {
+        throw std::runtime_error("Model has not been generated");
+    }
+    std::seed_seq seq{seed_, (unsigned long) 1};
+    std::mt19937_64 engine(seq);
+    std::normal_distribution<Real> normal(0.0, noise_ / std::sqrt(2.0));
+
+    for (const Real w : getFrequencies()) {
+        const Complex s(0.0, w);
+        MatrixXcd y = evaluate(s);
+        if (noise_ > 0.0) {
+            for (size_t j = 0; j < ports_; ++j) {
+                for (size_t k = j; k < ports_; ++k) {
+                    const Real re = normal(engine);
+                    const Real im = normal(engine);
+                    y(k,j) += std::abs(y(k,j)) * Complex(re, im);
+                    y(j,k) = y(k,j);
+                }
+            }
+        }
+        f(Driver::Sample(s, y));
+    }
+}
+
+std::vector<Driver::Sample> Generator::getSamples() const {
+    std::vector<Driver::Sample> res;
+    res.reserve(samples_);
+    forEachSample_([&res](Driver::Sample&& sample) {
+        res.push_back(std::move(sample));
+    });
+    return res;
+}
+
+void Generator::write(std::ostream& out) const {
+    const std::streamsize precision =
+            out.precision(std::numeric_limits<Real>::max_digits10);
+    forEachSample_([&out](const Driver::Sample& sample) {
+        out << sample.first.real() << " " << sample.first.imag();
+        for (MatrixXcd::Index i = 0; i < sample.second.size(); ++i) {
+            out << " " << sample.second(i).real()
+                << " " << sample.second(i).imag();
+        }
+        out << "\n";
+    });
+    out.precision(precision);
+}
+
+void Generator::write(const std::string& filename) const {
+    std::ofstream file(filename.c_str());
+    if (!file) {
+        throw std::runtime_error("Could not open " + filename);
+    }
+    write(file);
+    if (!file) {
+        throw std::runtime_error("Could not write " + filename);
+    }
+}
+
+} /* namespace VectorFitting */
@@ -0,0 +1,139 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Alejandro García Montoro        (alejandro.garciamontoro@gmail.com)
+//					  Alejandra López de Aberasturi Gómez (aloaberasturi@ugr.es)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef VECTOR_FITTING_GENERATOR_H_
+#define VECTOR_FITTING_GENERATOR_H_
+
+#include <ostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Driver.h"
+
+namespace VectorFitting {
+
+/**
+ * Random stable and symmetric pole-residue models with known poles and
+ * residues, sampled on a linear or logarithmic grid of frequencies:
+ *     Y(s) = D + s E + sum_m R_m / (s - p_m)
+ * Poles come in conjugated pairs, plus a real one for odd orders, with
+ * resonances spread over the range. The same seed gives the same model and
+ * samples. Samples can be built in memory or written to a file one by one,
+ * which keeps memory independent of the number of samples.
+ */
+class Generator {
+public:
+    enum class Spacing {
+        linear,
+        logarithmic
+    };
+
+    Generator();
+
+    size_t getOrder() const {return order_;}
+    void setOrder(const size_t order) {order_ = order;}
+
+    size_t getNumberOfPorts() const {return ports_;}
+    void setNumberOfPorts(const size_t ports) {ports_ = ports;}
+
+    size_t getNumberOfSamples() const {return samples_;}
+    void setNumberOfSamples(const size_t samples) {samples_ = samples;}
+
+    /**
+     * Angular frequencies of the samples, and of the resonances.
+     */
+    const std::pair<Real, Real>& getRange() const {return range_;}
+    void setRange(const std::pair<Real, Real>& range) {range_ = range;}
+
+    Spacing getSpacing() const {return spacing_;}
+    void setSpacing(const Spacing spacing) {spacing_ = spacing;}
+
+    Options::AsymptoticTrend getAsymptoticTrend() const {return trend_;}
+    void setAsymptoticTrend(const Options::AsymptoticTrend trend) {
+        trend_ = trend;
+    }
+
+    /**
+     * Standard deviation of the noise added to each element, relative to
+     * its magnitude. Noise keeps the samples symmetric.
+     */
+    Real getNoise() const {return noise_;}
+    void setNoise(const Real noise) {noise_ = noise;}
+
+    unsigned long getSeed() const {return seed_;}
+    void setSeed(const unsigned long seed) {seed_ = seed;}
+
+    /**
+     * Draws the model. Must be called after changing the settings.
+     */
+    void generate();
+
+    /**
+     * Ground truth.
+     */
+    const std::vector<Complex>& getPoles() const {return poles_;}
+    const std::vector<MatrixXcd>& getResidues() const {return residues_;}
+    const MatrixXcd& getD() const {return D_;}
+    const MatrixXcd& getE() const {return E_;}
+
+    /**
+     * Evaluates the model, without noise.
+     */
+    MatrixXcd evaluate(const Complex& s) const;
+
+    /**
+     * Angular frequencies of the grid.
+     */
+    std::vector<Real> getFrequencies() const;
+
+    std::vector<Driver::Sample> getSamples() const;
+
+    /**
+     * Writes one line per sample with s and the elements of the matrix
+     * column by column, as real and imaginary parts, as in testData.
+     */
+    void write(std::ostream& out) const;
+    void write(const std::string& filename) const;
+
+private:
+    size_t order_;
+    size_t ports_;
+    size_t samples_;
+    std::pair<Real, Real> range_;
+    Spacing spacing_;
+    Options::AsymptoticTrend trend_;
+    Real noise_;
+    unsigned long seed_;
+
+    bool generated_;
+    std::vector<Complex> poles_;
+    std::vector<MatrixXcd> residues_;
+    MatrixXcd D_, E_;
+
+    template<class F>
+    void forEachSample_(F f) const;
+};
+
+} /* namespace VectorFitting */
+
+#endif // VECTOR_FITTING_GENERATOR_H_
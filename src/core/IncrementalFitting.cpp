@@ -0,0 +1,526 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Alejandro García Montoro        (alejandro.garciamontoro@gmail.com)
+//					  Alejandra López de Aberasturi Gómez (aloaberasturi@ugr.es)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+#include "IncrementalFitting.h"
+
+#include <algorithm>
+#include <exception>
+
+namespace VectorFitting {
+
+namespace {
+
+Options buildOptions(const Options& options) {
+    Options res = options;
+    res.setRelax(true);
+    res.setBasis(Options::Basis::partialFractions);
+    res.setSketching(false);
+    res.setSinglePrecision(false);
+    if (res.getPoleTolerance() == 0.0) {
+        res.setPoleTolerance(IncrementalFitting::defaultPoleTolerance);
+    }
+    return res;
+}
+
+std::vector<Fitting::Sample> pack(const std::vector<Driver::Sample>& samples) {
+    std::vector<Fitting::Sample> res;
+    res.reserve(samples.size());
+    for (size_t i = 0; i < samples.size(); ++i) {
+        res.push_back(Fitting::Sample(samples[i].first,
+                                      Driver::pack(samples[i].second)));
+    }
+    return res;
+}
+
+}
+
+IncrementalFitting::IncrementalFitting(
+        const std::vector<Fitting::Sample>& samples,
+        const Options& options,
+        const std::vector<Complex>& poles) :
+                options_(buildOptions(options)),
+                samples_(samples),
+                poles_(poles) {
+    if (samples_.empty()) {
+        throw std::runtime_error("Samples size cannot be zero");
+    }
+    if (poles_.empty()) {
+        throw std::runtime_error("There must be at least one pole");
+    }
+    Fitting::sortSamples(samples_);
+    factorize_();
+    identifyResidues_();
+}
+
+IncrementalFitting::IncrementalFitting(const Driver& driver,
+                                       const Options& options) :
+                IncrementalFitting(pack(driver.getSamples()),
+                                   options,
+                                   driver.getPoles()) {}
+
+size_t IncrementalFitting::getOffset_() const {
+    switch (options_.getAsymptoticTrend()) {
+    case Options::AsymptoticTrend::zero:
+        return 0;
+    case Options::AsymptoticTrend::constant:
+        return 1;
+    case Options::AsymptoticTrend::linear:
+    default:
+        return 2;
+    }
+}
+
+size_t IncrementalFitting::getResponseSize_() const {
+    return samples_.front().second.size();
+}
+
+/**
+ * Dk at s: the partial fractions, with the real encoding of conjugated
+ * pairs of Fitting, followed by 1 and s as required by the trend.
+ */
+VectorXcd IncrementalFitting::buildBasis_(const Complex& s) const {
+    const size_t N = getOrder_();
+    const RowVectorXi cindex = Fitting::getCIndex(poles_);
+    VectorXcd res(N + getOffset_());
+    for (size_t m = 0; m < N; ++m) {
+        const Complex p = poles_[m];
+        if (cindex(m) == 0) {
+            res(m) = Complex(1,0) / (s - p);
+        } else if (cindex(m) == 1) {
+            res(m)   = Complex(1,0) / (s - p) + Complex(1,0) / (s - conj(p));
+            res(m+1) = Complex(0,1) / (s - p) - Complex(0,1) / (s - conj(p));
+        }
+    }
+    if (getOffset_() > 0) {
+        res(N) = 1.0;
+    }
+    if (getOffset_() > 1) {
+        res(N+1) = s;
+    }
+    return res;
+}
+
+/**
+ * Real and imaginary rows of a sample for response n.
+ */
+MatrixXd IncrementalFitting::buildRows_(const Fitting::Sample& sample,
+                                        const size_t n,
+                                        const Real weight) const {
+    const size_t N = getOrder_();
+    const size_t inda = N + getOffset_();
+    const VectorXcd basis = buildBasis_(sample.first);
+    const Complex f = sample.second(n);
+
+    MatrixXd res(2, inda + 1 + N);
+    for (size_t m = 0; m < inda; ++m) {
+        res(0, m) = std::real(basis(m));
+        res(1, m) = std::imag(basis(m));
+    }
+    res(0, inda) = std::real(f);
+    res(1, inda) = std::imag(f);
+    for (size_t m = 0; m < N; ++m) {
+        const Complex entry = - basis(m) * f;
+        res(0, inda + 1 + m) = std::real(entry);
+        res(1, inda + 1 + m) = std::imag(entry);
+    }
+    return weight * res;
+}
+
+void IncrementalFitting::factorize_() {
+    const size_t N  = getOrder_();
+    const size_t Nc = getResponseSize_();
+
+    basisSum_ = VectorXcd::Zero(N+1);
+    for (size_t i = 0; i < samples_.size(); ++i) {
+        basisSum_.head(N) += buildBasis_(samples_[i].first).head(N);
+    }
+    basisSum_(N) = (Real) samples_.size();
+
+    const Weights weights =
+            Weights::build(samples_, options_.getWeighting());
+    R_.resize(Nc);
+    scale_.resize(Nc);
+#pragma omp parallel for schedule(static)
+    for (long n = 0; n < (long) Nc; ++n) {
+        factorize_(n, weights);
+    }
+    factorizations_++;
+}
+
+void IncrementalFitting::factorize_(const size_t n, const Weights& weights) {
+    const size_t Ns = samples_.size();
+    const size_t N  = getOrder_();
+    const Index cols = N + getOffset_() + 1 + N;
+
+    const VectorXd w = weights.isUniform() ?
+            VectorXd::Ones(Ns) : weights.column(n);
+    MatrixXd A(2*Ns, cols);
+    for (size_t i = 0; i < Ns; ++i) {
+        A.middleRows(2*i, 2) = buildRows_(samples_[i], n, w(i));
+    }
+    scale_[n].resize(cols);
+    for (Index col = 0; col < cols; ++col) {
+        const Real norm = A.col(col).norm();
+        scale_[n](col) = (norm > 0.0) ? 1.0 / norm : 1.0;
+        A.col(col) *= scale_[n](col);
+    }
+    const HouseholderQR<MatrixXd> qr(A);
+    const Index rows = std::min(A.rows(), cols);
+    R_[n] = MatrixXd::Zero(cols, cols);
+    R_[n].topRows(rows) = qr.matrixQR().topRows(rows)
+            .triangularView<Upper>();
+}
+
+/**
+ * Adds a row to the least squares matrix whose triangular factor is R,
+ * eliminating it with one Givens rotation per column.
+ */
+void IncrementalFitting::addRow_(MatrixXd& R, VectorXd row) {
+    const Index K = R.cols();
+    for (Index k = 0; k < K; ++k) {
+        if (row(k) == 0.0) {
+            continue;
+        }
+        const Real r = std::hypot(R(k,k), row(k));
+        const Real c = R(k,k) / r;
+        const Real s = row(k) / r;
+        const VectorXd Rk = R.row(k).tail(K-k).transpose();
+        R.row(k).tail(K-k) = (c * Rk + s * row.tail(K-k)).transpose();
+        row.tail(K-k) = - s * Rk + c * row.tail(K-k);
+    }
+}
+
+/**
+ * Removes a row from the least squares matrix whose triangular factor is
+ * R. With a = R^-T row, the rotations that take [a; sqrt(1 - |a|^2)] to
+ * the last unit vector take [R; 0] to [R'; row], where R' is the factor
+ * without the row.
+ * @return False, leaving R unchanged, when R is singular or the downdate
+ *         would be inaccurate.
+ */
+bool IncrementalFitting::removeRow_(MatrixXd& R, const VectorXd& row) {
+    const Index K = R.cols();
+    for (Index k = 0; k < K; ++k) {
+        if (!(std::abs(R(k,k)) > 0.0)) {
+            return false;
+        }
+    }
+    const VectorXd a = R.triangularView<Upper>().transpose().solve(row);
+    const Real rest = 1.0 - a.squaredNorm();
+    if (!(rest > minDowndate_)) {
+        return false;
+    }
+
+    Real q = std::sqrt(rest);
+    VectorXd removed = VectorXd::Zero(K);
+    for (Index k = K-1; k >= 0; --k) {
+        const Real r = std::hypot(q, a(k));
+        const Real c = q / r;
+        const Real s = a(k) / r;
+        q = r;
+        const VectorXd Rk = R.row(k).tail(K-k).transpose();
+        R.row(k).tail(K-k) = (c * Rk - s * removed.tail(K-k)).transpose();
+        removed.tail(K-k) = s * Rk + c * removed.tail(K-k);
+    }
+    return true;
+}
+
+std::vector<Fitting::Sample>::iterator IncrementalFitting::find_(
+        const Complex& s) {
+    std::vector<Fitting::Sample>::iterator it = std::lower_bound(
+            samples_.begin(), samples_.end(), s.imag(),
+            [](const Fitting::Sample& sample, const Real w) {
+        return sample.first.imag() < w;
+    });
+    while (it != samples_.end() && it->first.imag() == s.imag()) {
+        if (it->first == s) {
+            return it;
+        }
+        ++it;
+    }
+    return samples_.end();
+}
+
+/**
+ * Throws if a frequency appears more than once in a batch of edits.
+ */
+void IncrementalFitting::checkDistinct_(std::vector<Complex> frequencies) {
+    std::sort(frequencies.begin(), frequencies.end(),
+            [](const Complex& a, const Complex& b) {
+        return a.imag() < b.imag() ||
+                (a.imag() == b.imag() && a.real() < b.real());
+    });
+    if (std::adjacent_find(frequencies.begin(), frequencies.end()) !=
+            frequencies.end()) {
+        throw std::runtime_error("Samples to edit must be distinct");
+    }
+}
+
+// Edits check all their inputs before changing any sample, so that the
+// samples always match the factors.
+
+void IncrementalFitting::replace(const std::vector<Fitting::Sample>& samples) {
+    std::vector<Complex> frequencies;
+    std::vector<std::vector<Fitting::Sample>::iterator> found;
+    for (size_t i = 0; i < samples.size(); ++i) {
+        std::vector<Fitting::Sample>::iterator it = find_(samples[i].first);
+        if (it == samples_.end()) {
+            throw std::runtime_error("Sample to replace does not exist");
+        }
+        if (it->second.size() != samples[i].second.size()) {
+            throw std::runtime_error("Samples must have the same size");
+        }
+        frequencies.push_back(samples[i].first);
+        found.push_back(it);
+    }
+    checkDistinct_(frequencies);
+
+    std::vector<Fitting::Sample> removed;
+    for (size_t i = 0; i < samples.size(); ++i) {
+        removed.push_back(*found[i]);
+        found[i]->second = samples[i].second;
+    }
+    update_(samples, removed);
+}
+
+void IncrementalFitting::add(const std::vector<Fitting::Sample>& samples) {
+    std::vector<Complex> frequencies;
+    for (size_t i = 0; i < samples.size(); ++i) {
+        if (find_(samples[i].first) != samples_.end()) {
+            throw std::runtime_error("Sample to add already exists");
+        }
+        if ((size_t) samples[i].second.size() != getResponseSize_()) {
+            throw std::runtime_error("Samples must have the same size");
+        }
+        frequencies.push_back(samples[i].first);
+    }
+    checkDistinct_(frequencies);
+
+    for (size_t i = 0; i < samples.size(); ++i) {
+        std::vector<Fitting::Sample>::iterator it = std::upper_bound(
+                samples_.begin(), samples_.end(), samples[i].first.imag(),
+                [](const Real w, const Fitting::Sample& sample) {
+            return w < sample.first.imag();
+        });
+        samples_.insert(it, samples[i]);
+    }
+    update_(samples, {});
+}
+
+void IncrementalFitting::remove(const std::vector<Complex>& frequencies) {
+    for (size_t i = 0; i < frequencies.size(); ++i) {
+        if (find_(frequencies[i]) == samples_.end()) {
+            throw std::runtime_error("Sample to remove does not exist");
+        }
+    }
+    checkDistinct_(frequencies);
+    if (frequencies.size() == samples_.size()) {
+        throw std::runtime_error("Samples size cannot be zero");
+    }
+
+    std::vector<Fitting::Sample> removed;
+    for (size_t i = 0; i < frequencies.size(); ++i) {
+        std::vector<Fitting::Sample>::iterator it = find_(frequencies[i]);
+        removed.push_back(*it);
+        samples_.erase(it);
+    }
+    update_({}, removed);
+}
+
+/**
+ * Updates the factors with the rows of the added samples and downdates
+ * them with those of the removed ones, which are already applied to the
+ * samples.
+ */
+void IncrementalFitting::update_(const std::vector<Fitting::Sample>& added,
+                                 const std::vector<Fitting::Sample>& removed) {
+    const size_t N  = getOrder_();
+    const size_t Nc = getResponseSize_();
+
+    for (size_t i = 0; i < added.size(); ++i) {
+        basisSum_.head(N) += buildBasis_(added[i].first).head(N);
+    }
+    for (size_t i = 0; i < removed.size(); ++i) {
+        basisSum_.head(N) -= buildBasis_(removed[i].first).head(N);
+    }
+    basisSum_(N) = (Real) samples_.size();
+
+    const Weights addedWeights =
+            Weights::build(added, options_.getWeighting());
+    const Weights removedWeights =
+            Weights::build(removed, options_.getWeighting());
+    std::vector<char> failed(Nc, false);
+#pragma omp parallel for schedule(static)
+    for (long n = 0; n < (long) Nc; ++n) {
+        const VectorXd addedW = addedWeights.isUniform() ?
+                VectorXd::Ones(added.size()) : addedWeights.column(n);
+        const VectorXd removedW = removedWeights.isUniform() ?
+                VectorXd::Ones(removed.size()) : removedWeights.column(n);
+        for (size_t i = 0; i < added.size(); ++i) {
+            const MatrixXd rows =
+                    buildRows_(added[i], n, addedW(i)) *
+                    scale_[n].asDiagonal();
+            addRow_(R_[n], rows.row(0).transpose());
+            addRow_(R_[n], rows.row(1).transpose());
+        }
+        for (size_t i = 0; i < removed.size() && !failed[n]; ++i) {
+            const MatrixXd rows =
+                    buildRows_(removed[i], n, removedW(i)) *
+                    scale_[n].asDiagonal();
+            failed[n] = !removeRow_(R_[n], rows.row(0).transpose()) ||
+                        !removeRow_(R_[n], rows.row(1).transpose());
+        }
+    }
+
+    if (std::find(failed.begin(), failed.end(), true) != failed.end()) {
+        const Weights weights =
+                Weights::build(samples_, options_.getWeighting());
+        for (size_t n = 0; n < Nc; ++n) {
+            if (failed[n]) {
+                factorize_(n, weights);
+                factorizations_++;
+            }
+        }
+    }
+}
+
+/**
+ * Relaxed system for sigma from the trailing blocks of the factors, with
+ * the same normalization row as Fitting::solveSigma().
+ */
+VectorXd IncrementalFitting::solveSigma_() const {
+    const size_t Ns = samples_.size();
+    const size_t N  = getOrder_();
+    const size_t Nc = getResponseSize_();
+    const size_t inda = N + getOffset_();
+
+    std::vector<Fitting::Reduction> parts(Nc);
+    for (size_t n = 0; n < Nc; ++n) {
+        const MatrixXd T = R_[n].bottomRightCorner(N+1, N+1);
+        const VectorXd scale = scale_[n].tail(N+1);
+        parts[n].A.resize(N+1, N+1);
+        parts[n].A.leftCols(N) = T.rightCols(N) *
+                scale.tail(N).cwiseInverse().asDiagonal();
+        parts[n].A.col(N) = - T.col(0) / scale(0);
+        parts[n].b = VectorXd::Zero(N+1);
+        parts[n].magnitude = R_[n].col(inda).squaredNorm() /
+                (scale(0) * scale(0));
+    }
+    const Fitting::Reduction reduction = Fitting::merge(parts);
+
+    const Real scale = std::sqrt(reduction.magnitude) / (Real) Ns;
+    MatrixXd AA(reduction.A.rows() + 1, N+1);
+    VectorXd bb(reduction.A.rows() + 1);
+    AA.topRows(reduction.A.rows()) = reduction.A;
+    bb.head(reduction.A.rows()) = reduction.b;
+    AA.row(reduction.A.rows()) = scale * basisSum_.real().transpose();
+    bb(reduction.A.rows()) = (Real) Ns * scale;
+
+    VectorXd Escale(AA.cols());
+    for (Index col = 0; col < AA.cols(); ++col) {
+        Escale(col) = 1.0 / AA.col(col).norm();
+        AA.col(col) *= Escale(col);
+    }
+    VectorXd x = AA.householderQr().solve(bb);
+    x.array() *= Escale.array();
+    return x;
+}
+
+size_t IncrementalFitting::refit(const size_t iterations) {
+    const size_t Nc = getResponseSize_();
+    size_t performed = 0;
+    for (; performed < iterations; ++performed) {
+        const VectorXd x = solveSigma_();
+        const Real dNew = Fitting::fixedConstant(x, options_, getOrder_());
+        std::vector<Complex> poles;
+        if (dNew == 0.0) {
+            poles = Fitting::zerosOfSigma(x, poles_, options_);
+        } else {
+            Fitting fitting(samples_, options_, poles_,
+                    Weights::build(samples_, options_.getWeighting()));
+            poles = fitting.zerosOfSigma(
+                    fitting.solveSigma(fitting.reduce(0, Nc, dNew), dNew));
+        }
+        if (Fitting::poleShift(poles_, poles) < options_.getPoleTolerance()) {
+            break;
+        }
+        poles_ = poles;
+        factorize_();
+    }
+    identifyResidues_();
+    return performed;
+}
+
+void IncrementalFitting::identifyResidues_() {
+    const size_t N  = getOrder_();
+    const size_t Nc = getResponseSize_();
+    const size_t inda = N + getOffset_();
+
+    C_ = MatrixXcd::Zero(Nc, N);
+    D_ = VectorXcd::Zero(Nc);
+    E_ = VectorXcd::Zero(Nc);
+    for (size_t n = 0; n < Nc; ++n) {
+        VectorXd y = R_[n].topLeftCorner(inda, inda)
+                .triangularView<Upper>().solve(R_[n].col(inda).head(inda));
+        y = y.cwiseProduct(scale_[n].head(inda)) / scale_[n](inda);
+        for (size_t m = 0; m < N; ++m) {
+            C_(n, m) = y(m);
+        }
+        if (getOffset_() > 0) {
+            D_(n) = y(N);
+        }
+        if (getOffset_() > 1) {
+            E_(n) = y(N+1);
+        }
+    }
+
+    const RowVectorXi cindex = Fitting::getCIndex(poles_);
+    for (size_t m = 0; m < N; ++m) {
+        if (cindex(m) == 1) {
+            for (size_t n = 0; n < Nc; ++n) {
+                const Real r1 = std::real(C_(n, m  ));
+                const Real r2 = std::real(C_(n, m+1));
+                C_(n, m  ) = Complex(r1,  r2);
+                C_(n, m+1) = Complex(r1, -r2);
+            }
+        }
+    }
+}
+
+VectorXcd IncrementalFitting::evaluate(const Complex& s) const {
+    VectorXcd res = D_ + s * E_;
+    for (size_t k = 0; k < poles_.size(); ++k) {
+        res += C_.col(k) / (s - poles_[k]);
+    }
+    return res;
+}
+
+Real IncrementalFitting::getRMSE() const {
+    Real error = 0.0;
+    for (size_t i = 0; i < samples_.size(); ++i) {
+        error += (samples_[i].second - evaluate(samples_[i].first))
+                .squaredNorm();
+    }
+    return std::sqrt(error / (Real) (samples_.size() * samples_.size()));
+}
+
+} /* namespace VectorFitting */
@@ -0,0 +1,148 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Alejandro García Montoro        (alejandro.garciamontoro@gmail.com)
+//					  Alejandra López de Aberasturi Gómez (aloaberasturi@ugr.es)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef VECTOR_FITTING_INCREMENTAL_FITTING_H_
+#define VECTOR_FITTING_INCREMENTAL_FITTING_H_
+
+#include "Driver.h"
+
+namespace VectorFitting {
+
+/**
+ * Fitting whose samples can be replaced, added or removed after it has
+ * been fitted, e.g. when a few frequencies are measured again.
+ *
+ * For the current poles it keeps, for each response n, the triangular
+ * factor R of the weighted least squares matrix with columns
+ *      [ Dk | f_n | -Dk f_n ],
+ * two real rows per sample. The leading block identifies the residues and
+ * the trailing one is the reduction of the relaxed system for sigma, see
+ * Fitting::reduce(). Editing a sample applies Givens rotations to R: rows
+ * are added as in a QR update and removed with the downdate of Saunders,
+ * so that the cost is proportional to the number of samples changed. A
+ * response whose downdate breaks down is factorized again from all the
+ * samples.
+ *
+ * refit() relocates the poles from the current factors. Factors are only
+ * valid for the poles they were built with: when the relocation moves the
+ * poles more than the pole tolerance of the options they are built again
+ * from all the samples and the iterations go on. Otherwise the current
+ * poles are kept and only the residues are identified again. A zero pole
+ * tolerance, the default of Options, would rebuild the factors on every
+ * relocation, so defaultPoleTolerance is used instead.
+ *
+ * The system is always relaxed and built on partial fractions. When the
+ * constant of sigma has to be fixed, that iteration is run by a Fitting.
+ */
+class IncrementalFitting {
+public:
+    static constexpr Real defaultPoleTolerance = 1e-6;
+
+    IncrementalFitting(const std::vector<Fitting::Sample>& samples,
+                       const Options& options,
+                       const std::vector<Complex>& poles);
+    /**
+     * Starts from the poles of a driver, with its samples in packed form.
+     */
+    IncrementalFitting(const Driver& driver, const Options& options);
+
+    /**
+     * Edits of the samples. Samples are identified by their frequency s,
+     * which must exist to be replaced or removed and must not exist to be
+     * added. A batch with an invalid edit, a repeated frequency or which
+     * would remove all the samples throws without changing any sample.
+     */
+    void replace(const std::vector<Fitting::Sample>& samples);
+    void add(const std::vector<Fitting::Sample>& samples);
+    void remove(const std::vector<Complex>& frequencies);
+
+    /**
+     * Runs up to the given number of relocations and identifies the
+     * residues. Each relocation which moves the poles more than the pole
+     * tolerance costs a factorization over all the samples.
+     * @return Relocations performed.
+     */
+    std::size_t refit(const std::size_t iterations);
+
+    const std::vector<Fitting::Sample>& getSamples() const {return samples_;}
+    const std::vector<Complex>& getPoles() const {return poles_;}
+    const MatrixXcd& getResidues() const {return C_;}    // Size: Nc, N.
+    const VectorXcd& getD() const {return D_;}           // Size: Nc.
+    const VectorXcd& getE() const {return E_;}           // Size: Nc.
+
+    VectorXcd evaluate(const Complex& s) const;
+
+    /**
+     * Normalized as Fitting::getRMSE().
+     */
+    Real getRMSE() const;
+
+    /**
+     * Times the factors have been built from all the samples, including
+     * those of single responses after a failed downdate.
+     */
+    std::size_t getFactorizations() const {return factorizations_;}
+
+private:
+    Options options_;
+    std::vector<Fitting::Sample> samples_;
+    std::vector<Complex> poles_;
+
+    std::vector<MatrixXd> R_;   // One per response.
+    std::vector<VectorXd> scale_;
+    VectorXcd basisSum_;        // Sum of Dk over the samples, N+1.
+
+    MatrixXcd C_;
+    VectorXcd D_;
+    VectorXcd E_;
+
+    std::size_t factorizations_ = 0;
+
+    std::size_t getOrder_() const {return poles_.size();}
+    std::size_t getOffset_() const;
+    std::size_t getResponseSize_() const;
+
+    void factorize_();
+    void factorize_(const std::size_t n, const Weights& weights);
+    MatrixXd buildRows_(const Fitting::Sample& sample,
+                        const std::size_t n,
+                        const Real weight) const;
+    VectorXcd buildBasis_(const Complex& s) const;
+    void update_(const std::vector<Fitting::Sample>& added,
+                 const std::vector<Fitting::Sample>& removed);
+    std::vector<Fitting::Sample>::iterator find_(const Complex& s);
+    static void checkDistinct_(std::vector<Complex> frequencies);
+
+    VectorXd solveSigma_() const;
+    void identifyResidues_();
+
+    // Downdates which leave less than this of the norm of R^-T row are
+    // too inaccurate.
+    static constexpr Real minDowndate_ = 1e-8;
+
+    static void addRow_(MatrixXd& R, VectorXd row);
+    static bool removeRow_(MatrixXd& R, const VectorXd& row);
+};
+
+} /* namespace VectorFitting */
+
+#endif // VECTOR_FITTING_INCREMENTAL_FITTING_H_
@@ -0,0 +1,205 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Alejandro García Montoro        (alejandro.garciamontoro@gmail.com)
+//					  Alejandra López de Aberasturi Gómez (aloaberasturi@ugr.es)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+#include "Loewner.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace VectorFitting {
+
+namespace {
+
+// Takes pairs of conjugated points to real form: J^H M J is real for the
+// Loewner matrices, with J = blkdiag(1/sqrt(2) [1 i; 1 -i]).
+MatrixXcd conjugatePairs(const size_t n) {
+    const Real h = 1.0 / std::sqrt(2.0);
+    MatrixXcd res = MatrixXcd::Zero(n, n);
+    for (size_t i = 0; i+1 < n; i += 2) {
+        res(i,   i) = h;
+        res(i,   i+1) = Complex(0.0,  h);
+        res(i+1, i) = h;
+        res(i+1, i+1) = Complex(0.0, -h);
+    }
+    return res;
+}
+
+}
+
+Loewner::Loewner(const std::vector<Fitting::Sample>& samples,
+                 const size_t maxOrder,
+                 const size_t nSamples) :
+        order_(0) {
+    if (samples.empty()) {
+        throw std::runtime_error("Samples size cannot be zero");
+    }
+    if (maxOrder == 0) {
+        throw std::runtime_error("Order must be greater than zero");
+    }
+    const size_t Nc = samples.front().second.size();
+
+    // Points at zero frequency are their own conjugates and are skipped.
+    std::vector<size_t> sorted;
+    for (size_t i = 0; i < samples.size(); ++i) {
+        if (samples[i].first.imag() > 0.0) {
+            sorted.push_back(i);
+        }
+    }
+    std::sort(sorted.begin(), sorted.end(), [&samples](size_t a, size_t b) {
+        return samples[a].first.imag() < samples[b].first.imag();
+    });
+    const size_t Ns = sorted.size();
+    const size_t nSub = std::min(Ns,
+            (nSamples != 0) ? nSamples : 2*maxOrder + 16);
+    if (nSub < 2) {
+        throw std::runtime_error("Loewner poles need at least two samples");
+    }
+    const Real wMax = samples[sorted.back()].first.imag();
+
+    // Samples spread over the grid, alternately right and left points.
+    std::vector<size_t> right, left;
+    for (size_t k = 0; k < nSub; ++k) {
+        const size_t i = sorted[(size_t) std::round(
+                (Real) k * (Real) (Ns - 1) / (Real) (nSub - 1))];
+        (k % 2 == 0 ? right : left).push_back(i);
+    }
+    const size_t K = 2 * right.size();
+    const size_t M = 2 * left.size();
+
+    std::mt19937 engine(0);
+    std::normal_distribution<Real> normal;
+    MatrixXd directions(left.size(), Nc);
+    for (MatrixXd::Index j = 0; j < directions.size(); ++j) {
+        directions(j) = normal(engine);
+    }
+
+    VectorXcd lambda(K), mu(M), v(M);
+    MatrixXcd W(Nc, K);
+    for (size_t i = 0; i < right.size(); ++i) {
+        lambda(2*i)   = samples[right[i]].first;
+        lambda(2*i+1) = std::conj(lambda(2*i));
+        W.col(2*i)    = samples[right[i]].second;
+        W.col(2*i+1)  = samples[right[i]].second.conjugate();
+    }
+    for (size_t j = 0; j < left.size(); ++j) {
+        mu(2*j)   = samples[left[j]].first;
+        mu(2*j+1) = std::conj(mu(2*j));
+        v(2*j)    = directions.row(j).cast<Complex>() * samples[left[j]].second;
+        v(2*j+1)  = std::conj(v(2*j));
+    }
+
+    MatrixXcd L(M, K), Ls(M, K);
+#pragma omp parallel for schedule(static)
+    for (long j = 0; j < (long) M; ++j) {
+        const RowVectorXcd lw =
+                directions.row(j/2).cast<Complex>() * W;
+        for (size_t i = 0; i < K; ++i) {
+            const Complex den = mu(j) - lambda(i);
+            L (j,i) = (v(j) - lw(i)) / den;
+            Ls(j,i) = (mu(j) * v(j) - lambda(i) * lw(i)) / den;
+        }
+    }
+    const MatrixXcd Jl = conjugatePairs(M), Jr = conjugatePairs(K);
+    const MatrixXd LR  = (Jl.adjoint() * L  * Jr).real();
+    const MatrixXd LsR = (Jl.adjoint() * Ls * Jr).real();
+
+    // Left and right bases of the pencil.
+    const size_t k = std::min(maxOrder + oversampling_, std::min(M, K));
+    MatrixXd horizontal(M, 2*K), vertical(2*M, K);
+    horizontal << LR, LsR;
+    vertical << LR, LsR;
+
+    const MatrixXd Qh = rangeOf_(horizontal, k, engine);
+    JacobiSVD<MatrixXd> svdH(Qh.transpose() * horizontal, ComputeThinU);
+    singularValues_ = svdH.singularValues();
+    while (order_ < std::min(maxOrder, (size_t) singularValues_.size()) &&
+            singularValues_(order_) > rankTolerance_ * singularValues_(0)) {
+        order_++;
+    }
+    if (order_ == 0) {
+        return;
+    }
+    const MatrixXd Y = Qh * svdH.matrixU().leftCols(order_);
+
+    const MatrixXd Qv = rangeOf_(vertical.transpose(), k, engine);
+    JacobiSVD<MatrixXd> svdV(Qv.transpose() * vertical.transpose(),
+                             ComputeThinU);
+    const MatrixXd X = Qv * svdV.matrixU().leftCols(order_);
+
+    const MatrixXd Lr  = Y.transpose() * LR  * X;
+    const MatrixXd Lsr = Y.transpose() * LsR * X;
+    GeneralizedEigenSolver<MatrixXd> ges(Lsr, Lr, false);
+
+    // Infinite eigenvalues come from the constant term.
+    std::vector<Complex> candidates;
+    for (size_t m = 0; m < order_; ++m) {
+        if (ges.betas()(m) == 0.0) {
+            continue;
+        }
+        Complex p = ges.alphas()(m) / ges.betas()(m);
+        if (!std::isfinite(std::abs(p)) || std::abs(p) > 1e2 * wMax ||
+                p.imag() < 0.0) {
+            continue;
+        }
+        if (p.real() > 0.0) {
+            p = Complex(-p.real(), p.imag());
+        }
+        candidates.push_back(p);
+    }
+    std::sort(candidates.begin(), candidates.end(),
+            [](const Complex& a, const Complex& b) {
+                return std::abs(a) < std::abs(b);
+            });
+    for (size_t m = 0; m < candidates.size(); ++m) {
+        const Complex& p = candidates[m];
+        if (p.imag() == 0.0 && poles_.size() < maxOrder) {
+            poles_.push_back(p);
+        } else if (p.imag() != 0.0 && poles_.size() + 2 <= maxOrder) {
+            poles_.push_back(std::conj(p));
+            poles_.push_back(p);
+        }
+    }
+}
+
+/**
+ * Orthonormal basis of the range of the k leading singular vectors of A,
+ * from a Gaussian sketch with power iterations.
+ */
+MatrixXd Loewner::rangeOf_(const MatrixXd& A,
+                           const size_t k,
+                           std::mt19937& engine) {
+    std::normal_distribution<Real> normal;
+    MatrixXd omega(A.cols(), k);
+    for (MatrixXd::Index i = 0; i < omega.size(); ++i) {
+        omega(i) = normal(engine);
+    }
+    const MatrixXd I = MatrixXd::Identity(A.rows(), k);
+    MatrixXd Q = HouseholderQR<MatrixXd>(A * omega).householderQ() * I;
+    for (size_t q = 0; q < powerIterations_; ++q) {
+        const MatrixXd Z = HouseholderQR<MatrixXd>(A.transpose() * Q)
+                .householderQ() * MatrixXd::Identity(A.cols(), k);
+        Q = HouseholderQR<MatrixXd>(A * Z).householderQ() * I;
+    }
+    return Q;
+}
+
+} /* namespace VectorFitting */
@@ -0,0 +1,89 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Alejandro García Montoro        (alejandro.garciamontoro@gmail.com)
+//					  Alejandra López de Aberasturi Gómez (aloaberasturi@ugr.es)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef VECTOR_FITTING_LOEWNER_H_
+#define VECTOR_FITTING_LOEWNER_H_
+
+#include <random>
+#include <vector>
+
+#include "Fitting.h"
+
+namespace VectorFitting {
+
+/**
+ * Poles from the Loewner framework. A subset of the samples is split in
+ * right and left points, with their conjugates, and the responses are
+ * projected on random real tangential directions at the left ones:
+ *     L (j,i) = (v_j - l_j^T w_i) / (mu_j - lambda_i)
+ *     Ls(j,i) = (mu_j v_j - lambda_i l_j^T w_i) / (mu_j - lambda_i)
+ * with w_i = H(lambda_i) and v_j = l_j^T H(mu_j). The matrices are taken to
+ * real form and reduced with randomized SVDs of [L Ls] and [L; Ls], whose
+ * numerical rank is the order of the data. Poles are the finite
+ * eigenvalues of the reduced pencil (Ls, L), unstable ones are flipped.
+ * Rows are assembled in parallel.
+ */
+class Loewner {
+public:
+    /**
+     * @param samples   Samples in any order, responses of the same size.
+     * @param maxOrder  Largest order of the reduced pencil.
+     * @param nSamples  Samples used, zero selects them from maxOrder.
+     */
+    Loewner(const std::vector<Fitting::Sample>& samples,
+            const size_t maxOrder,
+            const size_t nSamples = 0);
+
+    /**
+     * Numerical rank of [L Ls], not larger than maxOrder.
+     */
+    size_t getOrder() const {return order_;}
+
+    /**
+     * Leading singular values of [L Ls] found by the randomized SVD.
+     */
+    const VectorXd& getSingularValues() const {return singularValues_;}
+
+    /**
+     * Real poles and conjugated pairs, the pole with negative imaginary
+     * part first, as Fitting expects them. At most maxOrder poles.
+     */
+    const std::vector<Complex>& getPoles() const {return poles_;}
+
+private:
+    size_t order_;
+    VectorXd singularValues_;
+    std::vector<Complex> poles_;
+
+    // Singular values below this, relative to the largest, are noise.
+    static constexpr Real rankTolerance_ = 1e-10;
+    static constexpr size_t oversampling_ = 10;
+    static constexpr size_t powerIterations_ = 2;
+
+    static MatrixXd rangeOf_(const MatrixXd& A,
+                             const size_t k,
+                             std::mt19937& engine);
+};
+
+} /* namespace VectorFitting */
+
+#endif // VECTOR_FITTING_LOEWNER_H_
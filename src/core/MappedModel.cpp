@@ -0,0 +1,425 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Alejandro García Montoro        (alejandro.garciamontoro@gmail.com)
+//					  Alejandra López de Aberasturi Gómez (aloaberasturi@ugr.es)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+#include "MappedModel.h"
+
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <type_traits>
+
+#ifdef _WIN32
+#include <memory>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace VectorFitting {
+
+struct MappedModel::Header {
+    char          magic[8];
+    std::uint32_t version;
+    std::uint32_t byteOrder;
+    std::uint32_t realSize;
+    std::uint32_t flags;
+
+    std::uint64_t nPorts;
+    std::uint64_t nPoles;
+
+    // Options.
+    std::uint32_t asymptoticTrend;
+    std::uint32_t polesType;
+    std::uint32_t weighting;
+    std::uint32_t basis;
+    std::uint64_t n;
+    std::uint64_t iterations[2];
+    std::uint64_t coarsestSamples;
+    double        nu;
+    double        poleTolerance;
+
+    // Fit summary.
+    std::uint64_t nSamples;
+    double        minFrequency;
+    double        maxFrequency;
+    double        rmse;
+    double        maxDeviation;
+    double        signature[signatureBands];
+
+    // Data, in bytes from the beginning of the file.
+    std::uint64_t polesOffset;
+    std::uint64_t residuesOffset;
+    std::uint64_t DOffset;
+    std::uint64_t EOffset;
+    std::uint64_t size;
+};
+
+namespace {
+
+const char          magic[8]  = {'V','F','M','O','D','E','L','\0'};
+const std::uint32_t byteOrder = 0x01020304;
+const std::size_t   alignment = 16;
+
+enum Flags : std::uint32_t {
+    relax                     = 1 << 0,
+    stable                    = 1 << 1,
+    skipPoleIdentification    = 1 << 2,
+    skipResidueIdentification = 1 << 3,
+    complexSpaceState         = 1 << 4,
+    multiResolution           = 1 << 5,
+    singlePrecision           = 1 << 6,
+    sketching                 = 1 << 7
+};
+
+std::uint64_t align(const std::uint64_t offset) {
+    return (offset + alignment - 1) / alignment * alignment;
+}
+
+}
+
+void MappedModel::write(const std::string& filename,
+                        const Driver& driver,
+                        const Options& options) {
+    const std::vector<Complex>& poles = driver.getPoles();
+    const std::size_t Nc = driver.getNumberOfPorts();
+    const std::size_t Np = Nc * (Nc + 1) / 2;
+    const std::size_t N = poles.size();
+
+    Header header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, magic, sizeof(magic));
+    header.version   = version;
+    header.byteOrder = byteOrder;
+    header.realSize  = sizeof(Real);
+    header.nPorts    = Nc;
+    header.nPoles    = N;
+
+    std::uint32_t flags = 0;
+    if (options.isRelax())                     flags |= relax;
+    if (options.isStable())                    flags |= stable;
+    if (options.isSkipPoleIdentification())    flags |= skipPoleIdentification;
+    if (options.isSkipResidueIdentification()) flags |= skipResidueIdentification;
+    if (options.isComplexSpaceState())         flags |= complexSpaceState;
+    if (options.isMultiResolution())           flags |= multiResolution;
+    if (options.isSinglePrecision())           flags |= singlePrecision;
+    if (options.isSketching())                 flags |= sketching;
+    header.flags           = flags;
+    header.asymptoticTrend = (std::uint32_t) options.getAsymptoticTrend();
+    header.polesType       = (std::uint32_t) options.getPolesType();
+    header.weighting       = (std::uint32_t) options.getWeighting();
+    header.basis           = (std::uint32_t) options.getBasis();
+    header.n               = options.getN();
+    header.iterations[0]   = options.getIterations().first;
+    header.iterations[1]   = options.getIterations().second;
+    header.coarsestSamples = options.getCoarsestSamples();
+    header.nu              = options.getNu();
+    header.poleTolerance   = options.getPoleTolerance();
+
+    const std::vector<Driver::Sample>& samples = driver.getSamples();
+    header.nSamples = samples.size();
+    if (!samples.empty()) {
+        header.minFrequency = samples.front().first.imag();
+        header.maxFrequency = samples.back().first.imag();
+    }
+    header.rmse = driver.getRMSE();
+    header.maxDeviation = driver.getMaxDeviation();
+    const std::vector<Real> sig = signature(samples);
+    std::copy(sig.begin(), sig.end(), header.signature);
+
+    const std::uint64_t bytes = sizeof(Complex);
+    header.polesOffset    = align(sizeof(Header));
+    header.residuesOffset = align(header.polesOffset + N * bytes);
+    header.DOffset        = align(header.residuesOffset + N * Np * bytes);
+    header.EOffset        = align(header.DOffset + Np * bytes);
+    header.size           = header.EOffset + Np * bytes;
+
+    std::vector<char> buffer(header.size, 0);
+    std::memcpy(buffer.data(), &header, sizeof(header));
+    Complex* polesOut    = (Complex*) (buffer.data() + header.polesOffset);
+    Complex* residuesOut = (Complex*) (buffer.data() + header.residuesOffset);
+    std::copy(poles.begin(), poles.end(), polesOut);
+    const MatrixXcd& R = driver.getPackedResidues();
+    std::copy(R.data(), R.data() + N * Np, residuesOut);
+    const VectorXcd& D = driver.getPackedD();
+    const VectorXcd& E = driver.getPackedE();
+    std::copy(D.data(), D.data() + Np,
+              (Complex*) (buffer.data() + header.DOffset));
+    std::copy(E.data(), E.data() + Np,
+              (Complex*) (buffer.data() + header.EOffset));
+
+    std::ofstream out(filename.c_str(), std::ios::binary | std::ios::trunc);
+    out.write(buffer.data(), buffer.size());
+    if (!out) {
+        throw std::runtime_error("Could not write model file " + filename);
+    }
+}
+
+std::vector<Real> MappedModel::signature(
+        const std::vector<Driver::Sample>& samples) {
+    std::vector<Real> res(signatureBands, 0.0);
+    const std::size_t Ns = samples.size();
+    for (std::size_t b = 0; b < signatureBands; ++b) {
+        const std::size_t first = b * Ns / signatureBands;
+        const std::size_t last = (b + 1) * Ns / signatureBands;
+        for (std::size_t i = first; i < last; ++i) {
+            res[b] += samples[i].second.squaredNorm();
+        }
+        if (last > first) {
+            res[b] = std::sqrt(res[b] / (last - first));
+        }
+    }
+    return res;
+}
+
+MappedModel::MappedModel(const std::string& filename) :
+        data_(nullptr),
+        size_(0),
+        mapped_(false),
+        header_(nullptr) {
+#ifdef _WIN32
+    std::ifstream in(filename.c_str(), std::ios::binary | std::ios::ate);
+    if (!in) {
+        throw std::runtime_error("Could not open model file " + filename);
+    }
+    size_ = (std::size_t) in.tellg();
+    std::unique_ptr<char[]> buffer(new char[size_]);
+    in.seekg(0);
+    if (!in.read(buffer.get(), size_)) {
+        throw std::runtime_error("Could not read model file " + filename);
+    }
+    data_ = buffer.release();
+#else
+    const int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Could not open model file " + filename);
+    }
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || st.st_size == 0) {
+        ::close(fd);
+        throw std::runtime_error("Invalid model file " + filename);
+    }
+    size_ = (std::size_t) st.st_size;
+    void* addr = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (addr == MAP_FAILED) {
+        throw std::runtime_error("Could not map model file " + filename);
+    }
+    data_ = (const char*) addr;
+    mapped_ = true;
+#endif
+    header_ = (const Header*) data_;
+    try {
+        validate_();
+    } catch (const std::runtime_error& e) {
+        release_();
+        throw std::runtime_error(std::string(e.what()) + " in " + filename);
+    }
+}
+
+MappedModel::MappedModel(MappedModel&& rhs) :
+        data_(rhs.data_),
+        size_(rhs.size_),
+        mapped_(rhs.mapped_),
+        header_(rhs.header_) {
+    rhs.data_ = nullptr;
+    rhs.size_ = 0;
+    rhs.header_ = nullptr;
+}
+
+MappedModel::~MappedModel() {
+    release_();
+}
+
+void MappedModel::release_() {
+    if (data_ == nullptr) {
+        return;
+    }
+#ifdef _WIN32
+    delete[] data_;
+#else
+    if (mapped_) {
+        ::munmap((void*) data_, size_);
+    }
+#endif
+    data_ = nullptr;
+}
+
+void MappedModel::validate_() const {
+    static_assert(std::is_standard_layout<Header>::value,
+                  "Model file header must have standard layout");
+    if (size_ < sizeof(Header) ||
+            std::memcmp(header_->magic, magic, sizeof(magic)) != 0) {
+        throw std::runtime_error("Not a model file");
+    }
+    if (header_->version != version) {
+        throw std::runtime_error("Unsupported model file version");
+    }
+    if (header_->byteOrder != byteOrder ||
+            header_->realSize != sizeof(Real)) {
+        throw std::runtime_error("Model file has incompatible number format");
+    }
+    // Options are stored as integers, out of range ones would reach the
+    // switch statements on them.
+    if (header_->asymptoticTrend >
+                (std::uint32_t) Options::AsymptoticTrend::linear ||
+            header_->polesType > (std::uint32_t) Options::PolesType::loewner ||
+            header_->weighting >
+                (std::uint32_t) Options::Weighting::oneOverSqrtNorm ||
+            header_->basis > (std::uint32_t) Options::Basis::orthonormal) {
+        throw std::runtime_error("Corrupted model file");
+    }
+    // Counts are bounded by the size of the file before multiplying them,
+    // so that a crafted header cannot wrap the ends of the arrays around.
+    const std::uint64_t bytes = sizeof(Complex);
+    const std::uint64_t limit = size_ / bytes;
+    const std::uint64_t Nc = header_->nPorts;
+    const std::uint64_t N = header_->nPoles;
+    if (Nc > limit || N > limit || (Nc > 0 && Nc + 1 > 2 * limit / Nc)) {
+        throw std::runtime_error("Corrupted model file");
+    }
+    const std::uint64_t Np = Nc * (Nc + 1) / 2;
+    if (Np > 0 && N > limit / Np) {
+        throw std::runtime_error("Corrupted model file");
+    }
+    const std::uint64_t lengths[4] = {
+            N * bytes, N * Np * bytes, Np * bytes, Np * bytes };
+    const std::uint64_t offsets[4] = {
+            header_->polesOffset, header_->residuesOffset,
+            header_->DOffset, header_->EOffset };
+    if (header_->size != size_) {
+        throw std::runtime_error("Truncated model file");
+    }
+    for (std::size_t i = 0; i < 4; ++i) {
+        if (offsets[i] % alignof(Complex) != 0 ||
+                offsets[i] < sizeof(Header) ||
+                offsets[i] > size_ - lengths[i]) {
+            throw std::runtime_error("Corrupted model file");
+        }
+    }
+}
+
+const Complex* MappedModel::at_(const std::uint64_t offset) const {
+    return (const Complex*) (data_ + offset);
+}
+
+std::size_t MappedModel::getNumberOfPorts() const {
+    return header_->nPorts;
+}
+
+std::size_t MappedModel::getNumberOfPoles() const {
+    return header_->nPoles;
+}
+
+Map<const VectorXcd> MappedModel::getPoles() const {
+    return Map<const VectorXcd>(at_(header_->polesOffset), header_->nPoles);
+}
+
+Map<const MatrixXcd> MappedModel::getResidues() const {
+    const std::size_t Nc = header_->nPorts;
+    return Map<const MatrixXcd>(at_(header_->residuesOffset),
+                                Nc * (Nc + 1) / 2, header_->nPoles);
+}
+
+Map<const VectorXcd> MappedModel::getD() const {
+    const std::size_t Nc = header_->nPorts;
+    return Map<const VectorXcd>(at_(header_->DOffset), Nc * (Nc + 1) / 2);
+}
+
+Map<const VectorXcd> MappedModel::getE() const {
+    const std::size_t Nc = header_->nPorts;
+    return Map<const VectorXcd>(at_(header_->EOffset), Nc * (Nc + 1) / 2);
+}
+
+Options MappedModel::getOptions() const {
+    Options opts;
+    opts.setAsymptoticTrend(
+            (Options::AsymptoticTrend) header_->asymptoticTrend);
+    opts.setPolesType((Options::PolesType) header_->polesType);
+    opts.setWeighting((Options::Weighting) header_->weighting);
+    opts.setBasis((Options::Basis) header_->basis);
+    opts.setRelax(header_->flags & relax);
+    opts.setStable(header_->flags & stable);
+    opts.setSkipPoleIdentification(header_->flags & skipPoleIdentification);
+    opts.setSkipResidueIdentification(
+            header_->flags & skipResidueIdentification);
+    opts.setComplexSpaceState(header_->flags & complexSpaceState);
+    opts.setMultiResolution(header_->flags & multiResolution);
+    opts.setSinglePrecision(header_->flags & singlePrecision);
+    opts.setSketching(header_->flags & sketching);
+    opts.setN(header_->n);
+    opts.setIterations({header_->iterations[0], header_->iterations[1]});
+    opts.setCoarsestSamples(header_->coarsestSamples);
+    opts.setNu(header_->nu);
+    opts.setPoleTolerance(header_->poleTolerance);
+    return opts;
+}
+
+std::size_t MappedModel::getNumberOfSamples() const {
+    return header_->nSamples;
+}
+
+std::pair<Real, Real> MappedModel::getFrequencyRange() const {
+    return {header_->minFrequency, header_->maxFrequency};
+}
+
+Real MappedModel::getRMSE() const {
+    return header_->rmse;
+}
+
+Real MappedModel::getMaxDeviation() const {
+    return header_->maxDeviation;
+}
+
+std::vector<Real> MappedModel::getSignature() const {
+    return std::vector<Real>(header_->signature,
+                             header_->signature + signatureBands);
+}
+
+VectorXcd MappedModel::evaluatePacked(const Complex& s) const {
+    VectorXcd res = getD() + s * getE();
+    if (header_->nPoles > 0) {
+        res += getResidues() * (s - getPoles().array()).inverse().matrix();
+    }
+    return res;
+}
+
+MatrixXcd MappedModel::evaluate(const Complex& s) const {
+    return Driver::unpack(evaluatePacked(s), header_->nPorts);
+}
+
+std::pair<std::vector<Complex>, std::vector<MatrixXcd>>
+        MappedModel::ss2pr() const {
+    const std::size_t Nc = header_->nPorts;
+    const Map<const VectorXcd> poles = getPoles();
+    const Map<const MatrixXcd> residues = getResidues();
+    std::pair<std::vector<Complex>, std::vector<MatrixXcd>> res;
+    for (std::size_t k = 0; k < header_->nPoles; ++k) {
+        res.first.push_back(poles(k));
+        res.second.push_back(Driver::unpack(residues.col(k), Nc));
+    }
+    return res;
+}
+
+} /* namespace VectorFitting */
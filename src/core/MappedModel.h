@@ -0,0 +1,114 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Alejandro García Montoro        (alejandro.garciamontoro@gmail.com)
+//					  Alejandra López de Aberasturi Gómez (aloaberasturi@ugr.es)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef VECTOR_FITTING_MAPPED_MODEL_H_
+#define VECTOR_FITTING_MAPPED_MODEL_H_
+
+#include <cstdint>
+#include <string>
+
+#include "Driver.h"
+
+namespace VectorFitting {
+
+/**
+ * Fitted model stored in a versioned binary file and loaded through mmap.
+ *
+ * The file holds a fixed size header, with the Options used, a summary of
+ * the fit quality and a signature of the fitted data, followed by the poles,
+ * the residues, D and E. Only the lower triangle of symmetric matrices is
+ * stored, column by column, in the same ordering used by Driver to squeeze
+ * them. Residues are stored as a Nc(Nc+1)/2 x N column major matrix, one
+ * column per pole.
+ *
+ * Accessors return views on the mapped memory, nothing is copied on load.
+ */
+class MappedModel {
+public:
+    static constexpr std::uint32_t version = 6;
+    static constexpr std::size_t signatureBands = 32;
+
+    /**
+     * Writes the model fitted by driver.
+     * @param options  Options which were used for fitting.
+     */
+    static void write(const std::string& filename,
+                      const Driver& driver,
+                      const Options& options);
+
+    /**
+     * Root mean square of the norm of the samples in each of signatureBands
+     * contiguous bands of the grid. Cheap to compare, it tells how much two
+     * datasets on the same grid differ.
+     */
+    static std::vector<Real> signature(
+            const std::vector<Driver::Sample>& samples);
+
+    explicit MappedModel(const std::string& filename);
+    MappedModel(MappedModel&& rhs);
+    ~MappedModel();
+
+    std::size_t getNumberOfPorts() const;
+    std::size_t getNumberOfPoles() const;
+
+    Map<const VectorXcd> getPoles() const;
+    Map<const MatrixXcd> getResidues() const;
+    Map<const VectorXcd> getD() const;
+    Map<const VectorXcd> getE() const;
+
+    Options getOptions() const;
+    std::size_t getNumberOfSamples() const;
+    std::pair<Real, Real> getFrequencyRange() const;
+    Real getRMSE() const;
+    Real getMaxDeviation() const;
+    std::vector<Real> getSignature() const;
+
+    /**
+     * Evaluates the model at s, packed as the stored matrices.
+     */
+    VectorXcd evaluatePacked(const Complex& s) const;
+    MatrixXcd evaluate(const Complex& s) const;
+
+    /**
+     * Poles and full residue matrices, as returned by Driver::ss2pr().
+     */
+    std::pair<std::vector<Complex>, std::vector<MatrixXcd>> ss2pr() const;
+
+private:
+    struct Header;
+
+    const char* data_;
+    std::size_t size_;
+    bool mapped_;
+    const Header* header_;
+
+    MappedModel(const MappedModel&);
+    MappedModel& operator=(const MappedModel&);
+
+    const Complex* at_(const std::uint64_t offset) const;
+    void validate_() const;
+    void release_();
+};
+
+} /* namespace VectorFitting */
+
+#endif // VECTOR_FITTING_MAPPED_MODEL_H_
@@ -0,0 +1,481 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Alejandro García Montoro        (alejandro.garciamontoro@gmail.com)
+//					  Alejandra López de Aberasturi Gómez (aloaberasturi@ugr.es)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+#include "MultiProcessFitting.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace VectorFitting {
+
+namespace {
+
+enum Command : std::uint64_t {
+    quit     = 0,
+    reduce   = 1,
+    identify = 2
+};
+
+enum Status : std::uint64_t {
+    ok     = 0,
+    failed = 1
+};
+
+void sendAll(const int socket, const void* data, std::size_t size) {
+    const char* bytes = (const char*) data;
+    while (size > 0) {
+        const ssize_t sent = ::send(socket, bytes, size, MSG_NOSIGNAL);
+        if (sent < 0 && errno == EINTR) {
+            continue;
+        }
+        if (sent <= 0) {
+            throw std::runtime_error(
+                    std::string("Could not send to worker: ") +
+                    std::strerror(errno));
+        }
+        bytes += sent;
+        size -= sent;
+    }
+}
+
+void recvAll(const int socket, void* data, std::size_t size) {
+    char* bytes = (char*) data;
+    while (size > 0) {
+        const ssize_t received = ::recv(socket, bytes, size, 0);
+        if (received < 0 && errno == EINTR) {
+            continue;
+        }
+        if (received == 0) {
+            throw std::runtime_error("Connection with worker closed");
+        }
+        if (received < 0) {
+            throw std::runtime_error(
+                    std::string("Could not receive from worker: ") +
+                    std::strerror(errno));
+        }
+        bytes += received;
+        size -= received;
+    }
+}
+
+template<typename T>
+void sendValue(const int socket, const T& value) {
+    sendAll(socket, &value, sizeof(T));
+}
+
+template<typename T>
+T recvValue(const int socket) {
+    T value;
+    recvAll(socket, &value, sizeof(T));
+    return value;
+}
+
+void sendError(const int socket, const std::string& what) {
+    sendValue<std::uint64_t>(socket, failed);
+    sendValue<std::uint64_t>(socket, what.size());
+    sendAll(socket, what.data(), what.size());
+}
+
+std::string recvError(const int socket) {
+    std::string what(recvValue<std::uint64_t>(socket), '\0');
+    recvAll(socket, &what[0], what.size());
+    return what;
+}
+
+// Weights of responses [first, last).
+Weights sliceWeights(const Weights& weights,
+                     const std::size_t first,
+                     const std::size_t last) {
+    if (weights.getMode() != Weights::Mode::perElement) {
+        return weights;
+    }
+    MatrixXd res(weights.getSamplesSize(), last - first);
+    for (std::size_t n = first; n < last; ++n) {
+        res.col(n - first) = weights.column(n);
+    }
+    return Weights(res);
+}
+
+}
+
+MultiProcessFitting::MultiProcessFitting(
+        const std::size_t nResponses,
+        const Loader& load,
+        const Options& options,
+        const std::vector<Complex>& poles,
+        const std::size_t nWorkers) :
+                nResponses_(nResponses),
+                options_(options),
+                poles_(poles),
+                nSamples_(0),
+                rmse_(0.0),
+                maxDeviation_(0.0) {
+    if (nResponses_ == 0) {
+        throw std::runtime_error("No responses to fit");
+    }
+    if (poles_.empty()) {
+        throw std::runtime_error("Poles size can not be zero.");
+    }
+    start_(load, nWorkers);
+}
+
+MultiProcessFitting::MultiProcessFitting(
+        const std::vector<Fitting::Sample>& samples,
+        const Options& options,
+        const std::vector<Complex>& poles,
+        const std::size_t nWorkers,
+        const Weights& weights) :
+                MultiProcessFitting(
+                        samples.empty() ? 0 : samples.front().second.size(),
+                        [&samples, &weights](const std::size_t first,
+                                             const std::size_t last) {
+                            Part part;
+                            part.samples.reserve(samples.size());
+                            for (const Fitting::Sample& sample : samples) {
+                                part.samples.push_back(Fitting::Sample(
+                                        sample.first,
+                                        sample.second.segment(
+                                                first, last - first)));
+                            }
+                            part.weights = sliceWeights(weights, first, last);
+                            return part;
+                        },
+                        options, poles, nWorkers) {}
+
+MultiProcessFitting::~MultiProcessFitting() {
+    stop_();
+}
+
+/**
+ * Forks the workers, which load their parts concurrently, and waits until
+ * all of them are ready.
+ */
+void MultiProcessFitting::start_(const Loader& load,
+                                 const std::size_t nWorkers) {
+    const std::size_t Nc = nResponses_;
+    const std::size_t n = std::max((std::size_t) 1, std::min(nWorkers, Nc));
+    for (std::size_t w = 0; w < n; ++w) {
+        int sockets[2];
+        if (::socketpair(AF_UNIX, SOCK_STREAM, 0, sockets) != 0) {
+            stop_();
+            throw std::runtime_error("Could not create worker socket");
+        }
+        Worker worker;
+        worker.first = w * Nc / n;
+        worker.last = (w+1) * Nc / n;
+        worker.socket = sockets[0];
+        worker.pid = ::fork();
+        if (worker.pid < 0) {
+            ::close(sockets[0]);
+            ::close(sockets[1]);
+            stop_();
+            throw std::runtime_error("Could not fork worker");
+        }
+        if (worker.pid == 0) {
+            ::close(sockets[0]);
+            for (std::size_t i = 0; i < workers_.size(); ++i) {
+                ::close(workers_[i].socket);
+            }
+            // The thread pools of the parent are not inherited.
+            Eigen::setNbThreads(1);
+#ifdef _OPENMP
+            omp_set_num_threads(1);
+#endif
+            serve_(load, options_, poles_, sockets[1],
+                   worker.first, worker.last);
+            ::_exit(0);
+        }
+        ::close(sockets[1]);
+        workers_.push_back(worker);
+    }
+
+    std::string error;
+    try {
+        for (std::size_t w = 0; w < workers_.size(); ++w) {
+            const int socket = workers_[w].socket;
+            if (recvValue<std::uint64_t>(socket) != ok) {
+                error = recvError(socket);
+                continue;
+            }
+            const std::uint64_t Ns = recvValue<std::uint64_t>(socket);
+            if (w > 0 && Ns != nSamples_) {
+                error = "Parts have different numbers of samples";
+            }
+            nSamples_ = Ns;
+        }
+    } catch (...) {
+        stop_();
+        throw;
+    }
+    if (!error.empty()) {
+        stop_();
+        throw std::runtime_error("Worker failed: " + error);
+    }
+}
+
+void MultiProcessFitting::stop_() {
+    for (std::size_t w = 0; w < workers_.size(); ++w) {
+        try {
+            sendValue<std::uint64_t>(workers_[w].socket, quit);
+        } catch (const std::runtime_error&) {
+            // Already gone.
+        }
+        ::close(workers_[w].socket);
+        ::waitpid(workers_[w].pid, nullptr, 0);
+    }
+    workers_.clear();
+}
+
+void MultiProcessFitting::setPoles(const std::vector<Complex>& poles) {
+    if (poles.size() != poles_.size()) {
+        throw std::runtime_error("Number of poles can not change");
+    }
+    poles_ = poles;
+}
+
+/**
+ * Worker loop. Loads the part, reports its number of samples and answers
+ * each request for the poles received, until asked to quit or
+ * disconnected. Reductions cover all the responses of the part.
+ * Identifications fit the residues and reply with the model of the part.
+ */
+void MultiProcessFitting::serve_(const Loader& load,
+                                 const Options& options,
+                                 const std::vector<Complex>& poles,
+                                 const int socket,
+                                 const std::size_t first,
+                                 const std::size_t last) {
+    try {
+        Options opts = options;
+        opts.setSkipPoleIdentification(true);
+        std::unique_ptr<Fitting> fitting;
+        try {
+            Part part = load(first, last);
+            fitting.reset(new Fitting(std::move(part.samples), opts, poles,
+                                      part.weights));
+            if (fitting->getResponseSize() != last - first) {
+                throw std::runtime_error(
+                        "Loaded responses do not match the range");
+            }
+        } catch (const std::exception& e) {
+            sendError(socket, e.what());
+            ::close(socket);
+            return;
+        }
+        sendValue<std::uint64_t>(socket, ok);
+        sendValue<std::uint64_t>(socket, fitting->getSamplesSize());
+
+        std::uint64_t command;
+        while ((command = recvValue<std::uint64_t>(socket)) != quit) {
+            const Real dNew = recvValue<Real>(socket);
+            std::vector<Complex> current(recvValue<std::uint64_t>(socket));
+            recvAll(socket, current.data(), current.size() * sizeof(Complex));
+            Fitting::Reduction reduction;
+            VectorXd sums;
+            Real squaredError = 0.0, maxDeviation = 0.0;
+            try {
+                fitting->setPoles(current);
+                if (command == reduce) {
+                    reduction = fitting->reduce(0, last - first, dNew);
+                    if (dNew == 0.0) {
+                        sums = fitting->basisSums();
+                    }
+                } else {
+                    fitting->fit();
+                    if (!options.isSkipResidueIdentification()) {
+                        squaredError = std::pow(fitting->getRMSE(), 2);
+                        maxDeviation = fitting->getMaxDeviation();
+                    }
+                }
+            } catch (const std::exception& e) {
+                sendError(socket, e.what());
+                continue;
+            }
+            sendValue<std::uint64_t>(socket, ok);
+            if (command == reduce) {
+                sendValue<std::uint64_t>(socket, reduction.A.rows());
+                sendValue<std::uint64_t>(socket, reduction.A.cols());
+                sendAll(socket, reduction.A.data(),
+                        reduction.A.size() * sizeof(Real));
+                sendAll(socket, reduction.b.data(),
+                        reduction.b.size() * sizeof(Real));
+                sendValue<Real>(socket, reduction.magnitude);
+                sendValue<std::uint64_t>(socket, sums.size());
+                sendAll(socket, sums.data(), sums.size() * sizeof(Real));
+                continue;
+            }
+            const std::size_t N = current.size();
+            sendAll(socket, fitting->getA().data(), N * N * sizeof(Complex));
+            sendAll(socket, fitting->getB().data(), N * sizeof(int));
+            sendAll(socket, fitting->getC().data(),
+                    fitting->getC().size() * sizeof(Complex));
+            sendAll(socket, fitting->getD().data(),
+                    fitting->getD().size() * sizeof(Complex));
+            sendAll(socket, fitting->getE().data(),
+                    fitting->getE().size() * sizeof(Complex));
+            sendValue<Real>(socket, squaredError);
+            sendValue<Real>(socket, maxDeviation);
+        }
+    } catch (...) {
+        // Coordinator gone.
+    }
+    ::close(socket);
+}
+
+/**
+ * Sends the command and the current poles to all the workers, which
+ * process them concurrently.
+ */
+void MultiProcessFitting::request_(const std::uint64_t command,
+                                   const Real dNew) {
+    if (workers_.empty()) {
+        throw std::runtime_error("Workers were stopped after a failure");
+    }
+    for (std::size_t w = 0; w < workers_.size(); ++w) {
+        sendValue<std::uint64_t>(workers_[w].socket, command);
+        sendValue<Real>(workers_[w].socket, dNew);
+        sendValue<std::uint64_t>(workers_[w].socket, poles_.size());
+        sendAll(workers_[w].socket, poles_.data(),
+                poles_.size() * sizeof(Complex));
+    }
+}
+
+/**
+ * Requests the reductions from all the workers and merges them.
+ * @param basisSums  Set for the relaxed system, see Fitting::basisSums().
+ */
+Fitting::Reduction MultiProcessFitting::reduce_(const Real dNew,
+                                                VectorXd& basisSums) {
+    std::vector<Fitting::Reduction> parts(workers_.size());
+    std::string error;
+    // Replies left unread would be taken as the answers to the next
+    // request, so all the workers are stopped when any connection fails.
+    try {
+        request_(reduce, dNew);
+        for (std::size_t w = 0; w < workers_.size(); ++w) {
+            const int socket = workers_[w].socket;
+            if (recvValue<std::uint64_t>(socket) != ok) {
+                error = recvError(socket);
+                continue;
+            }
+            const std::uint64_t rows = recvValue<std::uint64_t>(socket);
+            const std::uint64_t cols = recvValue<std::uint64_t>(socket);
+            parts[w].A.resize(rows, cols);
+            parts[w].b.resize(rows);
+            recvAll(socket, parts[w].A.data(), rows * cols * sizeof(Real));
+            recvAll(socket, parts[w].b.data(), rows * sizeof(Real));
+            parts[w].magnitude = recvValue<Real>(socket);
+            // All the parts share the frequencies, and so the sums.
+            basisSums.resize(recvValue<std::uint64_t>(socket));
+            recvAll(socket, basisSums.data(), basisSums.size() * sizeof(Real));
+        }
+    } catch (...) {
+        stop_();
+        throw;
+    }
+    if (!error.empty()) {
+        throw std::runtime_error("Worker failed: " + error);
+    }
+    return Fitting::merge(parts);
+}
+
+/**
+ * Requests the residues of their responses from all the workers and
+ * gathers them. The model is kept unchanged when a worker fails.
+ */
+void MultiProcessFitting::identify_() {
+    const std::size_t N = poles_.size();
+    MatrixXcd A(N, N), C(nResponses_, N);
+    VectorXi B(N);
+    VectorXcd D(nResponses_), E(nResponses_);
+    Real squaredError = 0.0, maxDeviation = 0.0;
+    std::string error;
+    try {
+        request_(identify, 0.0);
+        for (std::size_t w = 0; w < workers_.size(); ++w) {
+            const int socket = workers_[w].socket;
+            if (recvValue<std::uint64_t>(socket) != ok) {
+                error = recvError(socket);
+                continue;
+            }
+            const std::size_t first = workers_[w].first;
+            const std::size_t rows = workers_[w].last - first;
+            // State matrices only depend on the poles.
+            recvAll(socket, A.data(), N * N * sizeof(Complex));
+            recvAll(socket, B.data(), N * sizeof(int));
+            MatrixXcd part(rows, N);
+            recvAll(socket, part.data(), rows * N * sizeof(Complex));
+            C.middleRows(first, rows) = part;
+            recvAll(socket, D.data() + first, rows * sizeof(Complex));
+            recvAll(socket, E.data() + first, rows * sizeof(Complex));
+            squaredError += recvValue<Real>(socket);
+            maxDeviation = std::max(maxDeviation, recvValue<Real>(socket));
+        }
+    } catch (...) {
+        stop_();
+        throw;
+    }
+    if (!error.empty()) {
+        throw std::runtime_error("Worker failed: " + error);
+    }
+    A_.swap(A);
+    B_.swap(B);
+    C_.swap(C);
+    D_.swap(D);
+    E_.swap(E);
+    rmse_ = std::sqrt(squaredError);
+    maxDeviation_ = maxDeviation;
+}
+
+void MultiProcessFitting::fit() {
+    if (!options_.isSkipPoleIdentification()) {
+        VectorXd x, sums;
+        if (options_.isRelax()) {
+            const Fitting::Reduction reduction = reduce_(0.0, sums);
+            x = Fitting::solveSigma(reduction, sums, nSamples_,
+                                    poles_, options_);
+        }
+        const Real dNew = Fitting::fixedConstant(x, options_, poles_.size());
+        if (dNew != 0.0) {
+            const Fitting::Reduction reduction = reduce_(dNew, sums);
+            x = Fitting::solveSigma(reduction, sums, nSamples_,
+                                    poles_, options_, dNew);
+        }
+        poles_ = Fitting::zerosOfSigma(x, poles_, options_);
+    }
+    identify_();
+}
+
+} /* namespace VectorFitting */
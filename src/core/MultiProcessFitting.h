@@ -0,0 +1,153 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Alejandro García Montoro        (alejandro.garciamontoro@gmail.com)
+//					  Alejandra López de Aberasturi Gómez (aloaberasturi@ugr.es)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef VECTOR_FITTING_MULTI_PROCESS_FITTING_H_
+#define VECTOR_FITTING_MULTI_PROCESS_FITTING_H_
+
+#include <cstdint>
+#include <functional>
+
+#include <sys/types.h>
+
+#include "Fitting.h"
+
+namespace VectorFitting {
+
+/**
+ * Fitting whose responses are spread over worker processes.
+ *
+ * Each worker owns a contiguous range of responses, which it loads itself
+ * after being forked, so no process holds the whole dataset. On every fit()
+ * the coordinator sends the current poles to all the workers, which reduce
+ * their responses with Fitting::reduce() and send the blocks back through
+ * Unix domain sockets. The coordinator merges them, solves for sigma and
+ * relocates the poles. The workers then identify the residues of their
+ * responses with the new poles and send back their rows of C, D and E. The
+ * coordinator only holds the poles, the merged factor and the results.
+ * Results are the same as those of Fitting::fit(), except for sketching,
+ * whose seeds are the indices of the responses within each worker.
+ *
+ * Options are fixed at construction. Only available on POSIX systems. The
+ * control of the fitting is not polled by the workers.
+ */
+class MultiProcessFitting {
+public:
+    /**
+     * Samples of responses [first, last) and their weights, which may be
+     * uniform, per sample or per element of the range.
+     */
+    struct Part {
+        std::vector<Fitting::Sample> samples;
+        Weights weights;
+    };
+    typedef std::function<Part(std::size_t first, std::size_t last)> Loader;
+
+    /**
+     * @param nResponses  Responses of the model.
+     * @param load        Called by each worker for its range. All the parts
+     *                    must have the same frequencies.
+     * @param nWorkers    Worker processes, at most one per response.
+     */
+    MultiProcessFitting(const std::size_t nResponses,
+                        const Loader& load,
+                        const Options& options,
+                        const std::vector<Complex>& poles,
+                        const std::size_t nWorkers);
+
+    /**
+     * Samples held by the caller, each worker copies its range.
+     */
+    MultiProcessFitting(const std::vector<Fitting::Sample>& samples,
+                        const Options& options,
+                        const std::vector<Complex>& poles,
+                        const std::size_t nWorkers,
+                        const Weights& weights = Weights());
+
+    /**
+     * Stops the workers and waits for them.
+     */
+    ~MultiProcessFitting();
+
+    /**
+     * Throws std::runtime_error when a worker fails. When the connection
+     * with a worker is lost all of them are stopped, and later fits throw.
+     */
+    void fit();
+
+    std::size_t getNumberOfWorkers() const {return workers_.size();}
+    std::size_t getResponseSize() const {return nResponses_;}
+    const Options& getOptions() const {return options_;}
+
+    const std::vector<Complex>& getPoles() const {return poles_;}
+    void setPoles(const std::vector<Complex>& poles);
+
+    /**
+     * Model of the last fit, as in Fitting. C, D and E gather the rows
+     * sent by the workers. Errors are zero while the residues are not
+     * identified.
+     */
+    const MatrixXcd& getA() const {return A_;}
+    const MatrixXcd& getC() const {return C_;}
+    const VectorXi&  getB() const {return B_;}
+    const VectorXcd& getD() const {return D_;}
+    const VectorXcd& getE() const {return E_;}
+    Real getRMSE() const {return rmse_;}
+    Real getMaxDeviation() const {return maxDeviation_;}
+
+private:
+    struct Worker {
+        pid_t pid;
+        int socket;
+        std::size_t first, last;
+    };
+
+    std::size_t nResponses_;
+    Options options_;
+    std::vector<Complex> poles_;
+    std::size_t nSamples_;
+    std::vector<Worker> workers_;
+
+    MatrixXcd A_, C_;
+    VectorXcd D_, E_;
+    VectorXi B_;
+    Real rmse_, maxDeviation_;
+
+    void start_(const Loader& load, const std::size_t nWorkers);
+    Fitting::Reduction reduce_(const Real dNew, VectorXd& basisSums);
+    void identify_();
+    void request_(const std::uint64_t command, const Real dNew);
+    void stop_();
+
+    static void serve_(const Loader& load,
+                       const Options& options,
+                       const std::vector<Complex>& poles,
+                       const int socket,
+                       const std::size_t first,
+                       const std::size_t last);
+
+    MultiProcessFitting(const MultiProcessFitting&);
+    MultiProcessFitting& operator=(const MultiProcessFitting&);
+};
+
+} /* namespace VectorFitting */
+
+#endif // VECTOR_FITTING_MULTI_PROCESS_FITTING_H_
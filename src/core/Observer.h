@@ -0,0 +1,86 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Alejandro García Montoro        (alejandro.garciamontoro@gmail.com)
+//					  Alejandra López de Aberasturi Gómez (aloaberasturi@ugr.es)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef VECTOR_FITTING_OBSERVER_H_
+#define VECTOR_FITTING_OBSERVER_H_
+
+#include <limits>
+
+#include "Control.h"
+#include "Real.h"
+
+namespace VectorFitting {
+
+/**
+ * Convergence data of one Fitting::fit() call.
+ */
+struct Trace {
+    Control::Stage stage = Control::Stage::relocation;
+    std::size_t iteration = 0;      // In its stage, starting at 1.
+
+    std::size_t samples   = 0;
+    std::size_t responses = 0;
+    std::size_t order     = 0;
+
+    // Constant term of sigma in the relaxed solution, NaN when the relaxed
+    // system was not solved.
+    Real sigmaConstant = std::numeric_limits<Real>::quiet_NaN();
+    // Constant term imposed because the relaxed one was out of tolerances
+    // or relaxation is disabled, zero when none was imposed.
+    Real fixedConstant = 0.0;
+    // Estimate of the condition number of the scaled system for sigma.
+    Real condition = std::numeric_limits<Real>::quiet_NaN();
+
+    // Relative displacement of the poles, see Fitting::poleShift().
+    Real poleShift = std::numeric_limits<Real>::quiet_NaN();
+    // Unstable poles reflected to the left half plane.
+    std::size_t flippedPoles = 0;
+
+    // Error with the new poles, NaN when residues were not identified.
+    Real rmse = std::numeric_limits<Real>::quiet_NaN();
+    double seconds = 0.0;
+};
+
+/**
+ * Receives a trace after each fit() of the fittings sharing a control,
+ * including those run by Driver, labeled with their stage. Observers of
+ * controls shared by concurrent fits, e.g. in ColumnDriver, are called
+ * from several threads.
+ */
+class Observer {
+public:
+    virtual ~Observer() {}
+
+    virtual void observe(const Trace& trace) = 0;
+
+    /**
+     * When true, fits which skip residue identification, e.g. relocations
+     * run by Driver, identify them anyway to report the error. This does
+     * not change the poles but adds the cost of the identification, so it
+     * is off unless the observer asks for it.
+     */
+    virtual bool isRMSERequired() const {return false;}
+};
+
+} /* namespace VectorFitting */
+
+#endif // VECTOR_FITTING_OBSERVER_H_
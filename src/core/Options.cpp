@@ -35,10 +35,17 @@ Options::Options() {
     relax_                     = true;
     stable_                    = true;
     asymptoticTrend_           = AsymptoticTrend::constant;
+    basis_                     = Basis::partialFractions;
     weighting_                 = Weighting::one;
     skipPoleIdentification_    = false;
     skipResidueIdentification_ = false;
     complexSpaceState_         = true;
+
+    multiResolution_           = false;
+    coarsestSamples_           = 0;
+    poleTolerance_             = 0.0;
+    singlePrecision_           = false;
+    sketching_                 = false;
 }
 
 Options::~Options() {
@@ -62,6 +69,14 @@ void Options::setPolesType(
 	polesType_ = polesType;
 }
 
+Options::Basis Options::getBasis() const {
+    return basis_;
+}
+
+void Options::setBasis(Options::Basis basis) {
+    basis_ = basis;
+}
+
 bool Options::isRelax() const {
     return relax_;
 }
@@ -108,6 +123,10 @@ Options::Weighting Options::getWeighting() const {
     return weighting_;
 }
 
+void Options::setWeighting(Options::Weighting weighting) {
+    weighting_ = weighting;
+}
+
 std::pair<size_t, size_t> Options::getIterations() const {
     return iterations_;
 }
@@ -132,6 +151,46 @@ void Options::setNu(double nu) {
     nu_ = nu;
 }
 
+bool Options::isMultiResolution() const {
+    return multiResolution_;
+}
+
+void Options::setMultiResolution(bool multiResolution) {
+    multiResolution_ = multiResolution;
+}
+
+size_t Options::getCoarsestSamples() const {
+    return coarsestSamples_;
+}
+
+void Options::setCoarsestSamples(size_t coarsestSamples) {
+    coarsestSamples_ = coarsestSamples;
+}
+
+double Options::getPoleTolerance() const {
+    return poleTolerance_;
+}
+
+void Options::setPoleTolerance(double poleTolerance) {
+    poleTolerance_ = poleTolerance;
+}
+
+bool Options::isSinglePrecision() const {
+    return singlePrecision_;
+}
+
+void Options::setSinglePrecision(bool singlePrecision) {
+    singlePrecision_ = singlePrecision;
+}
+
+bool Options::isSketching() const {
+    return sketching_;
+}
+
+void Options::setSketching(bool sketching) {
+    sketching_ = sketching;
+}
+
 } /* namespace VectorFitting */
 
 
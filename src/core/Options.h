@@ -38,8 +38,18 @@ public:
     };
 
     enum class PolesType {
-    	lincmplx,
-		logcmplx
+        lincmplx,
+        logcmplx,
+        peaks,    // Data driven, see Driver::buildPoles.
+        loewner   // Data driven, see Loewner.
+    };
+
+    // Functions of the poles in the least squares problems. Orthonormal
+    // ones (Takenaka-Malmquist) keep the problems well conditioned when
+    // poles cluster. Results are given as partial fractions in both cases.
+    enum class Basis {
+        partialFractions,
+        orthonormal
     };
 
     enum class Weighting {
@@ -55,6 +65,7 @@ public:
 
     AsymptoticTrend getAsymptoticTrend() const;
     PolesType getPolesType() const;
+    Basis getBasis() const;
     Weighting getWeighting() const;
     bool isRelax() const;
 
@@ -65,7 +76,9 @@ public:
 
     void setAsymptoticTrend(AsymptoticTrend asymptoticTrend);
     void setPolesType(PolesType polesType);
+    void setBasis(Basis basis);
     void setRelax(bool relax);
+    void setWeighting(Weighting weighting);
     void setSkipPoleIdentification(bool skipPoleIdentification);
     void setSkipResidueIdentification(bool skipResidueIdentification);
     void setStable(bool stable);
@@ -79,11 +92,27 @@ public:
     double getNu() const;
     void setNu(double nu);
 
+    bool isMultiResolution() const;
+    void setMultiResolution(bool multiResolution);
+
+    size_t getCoarsestSamples() const;
+    void setCoarsestSamples(size_t coarsestSamples);
+
+    double getPoleTolerance() const;
+    void setPoleTolerance(double poleTolerance);
+
+    bool isSinglePrecision() const;
+    void setSinglePrecision(bool singlePrecision);
+
+    bool isSketching() const;
+    void setSketching(bool sketching);
+
 private:
 
     bool relax_;
     bool stable_;
     AsymptoticTrend asymptoticTrend_;
+    Basis basis_;
     Weighting weighting_;
     bool skipPoleIdentification_;
     bool skipResidueIdentification_;
@@ -93,6 +122,28 @@ private:
     PolesType polesType_;
     size_t n_;
     std::pair<size_t, size_t> iterations_;
+
+    // Relocation iterations run over progressively denser subsets of the
+    // samples. Zero coarsest samples selects its size from the order.
+    // The last iteration always uses every sample and each earlier one
+    // about half of the next, so k iterations cost at least those of two
+    // full ones: with the default four plus four iterations fits are about
+    // 4 times faster, and speedups of 5 times or more need more iterations.
+    bool multiResolution_;
+    size_t coarsestSamples_;
+
+    // A stage ends once no pole moves more than this relative distance in
+    // an iteration. Zero runs every iteration.
+    double poleTolerance_;
+
+    // Fittings store responses and weights in single precision, computations
+    // are still done in Real. Read when the fitting is built.
+    bool singlePrecision_;
+
+    // Least squares problems are compressed with random sketches, see
+    // Sketch. Each one falls back to a full QR when the sketch fails its
+    // accuracy check.
+    bool sketching_;
 };
 
 } /* namespace VectorFitting */
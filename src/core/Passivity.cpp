@@ -0,0 +1,316 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Alejandro García Montoro        (alejandro.garciamontoro@gmail.com)
+//					  Alejandra López de Aberasturi Gómez (aloaberasturi@ugr.es)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+#include "Passivity.h"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+namespace VectorFitting {
+
+Passivity::Passivity(const Driver& driver, const Method method) :
+        D_(driver.getD()),
+        E_(driver.getE()) {
+    std::pair<std::vector<Complex>, std::vector<MatrixXcd>> pR = driver.ss2pr();
+    poles_ = pR.first;
+    residues_ = pR.second;
+    assess_(method);
+}
+
+Passivity::Passivity(
+        const std::vector<Complex>& poles,
+        const std::vector<MatrixXcd>& residues,
+        const MatrixXcd& D,
+        const MatrixXcd& E,
+        const Method method) :
+                poles_(poles),
+                residues_(residues),
+                D_(D),
+                E_(E) {
+    if (poles_.size() != residues_.size()) {
+        throw std::runtime_error(
+                "Poles and residues must have the same size");
+    }
+    if (D_.rows() != D_.cols() ||
+            E_.rows() != D_.rows() || E_.cols() != D_.cols()) {
+        throw std::runtime_error("D and E must be square and of same size");
+    }
+    for (std::size_t k = 0; k < residues_.size(); ++k) {
+        if (residues_[k].rows() != D_.rows() ||
+                residues_[k].cols() != D_.cols()) {
+            throw std::runtime_error("Residues and D must have same size");
+        }
+    }
+    assess_(method);
+}
+
+Real Passivity::minEigenvalue(const Real w) const {
+    MatrixXcd Y;
+    if (std::isinf(w)) {
+        Y = D_;
+    } else {
+        const Complex s(0.0, w);
+        Y = D_ + s * E_;
+        for (std::size_t k = 0; k < poles_.size(); ++k) {
+            Y += residues_[k] / (s - poles_[k]);
+        }
+    }
+    const MatrixXcd H = 0.5 * (Y + Y.adjoint());
+    SelfAdjointEigenSolver<MatrixXcd> eig(H, EigenvaluesOnly);
+    return eig.eigenvalues().minCoeff();
+}
+
+void Passivity::assess_(const Method method) {
+    method_ = method;
+    if (method_ == Method::halfSizeMatrix && !halfSizeCrossings_()) {
+        method_ = Method::sampling;
+    }
+    if (method_ == Method::sampling) {
+        samplingCrossings_();
+    }
+    classify_();
+}
+
+/**
+ * Builds a real realization with one block per column of Y. A real pole p
+ * contributes A = p, b = 1, c = R. A conjugated pair with p = a + jb
+ * contributes A = [a b; -b a], b = [2; 0], c = [Re R, Im R]. A real and
+ * symmetric E has no hermitian part on the imaginary axis and is ignored.
+ * @return false if the test matrix cannot be applied to this model.
+ */
+bool Passivity::halfSizeCrossings_() {
+    const std::size_t Nc = D_.rows();
+    const std::size_t N = poles_.size();
+    if (Nc == 0) {
+        return false;
+    }
+    if (D_.imag().norm() > symmetryTolerance_ * D_.norm() ||
+            E_.imag().norm() > symmetryTolerance_ * E_.norm() ||
+            !isReciprocal_()) {
+        return false;
+    }
+    const MatrixXd D = D_.real();
+    PartialPivLU<MatrixXd> lu(D);
+    if (!(lu.rcond() > std::numeric_limits<Real>::epsilon() * 1e3)) {
+        return false;
+    }
+
+    MatrixXd Ap = MatrixXd::Zero(N, N);
+    VectorXd bp = VectorXd::Zero(N);
+    MatrixXd C = MatrixXd::Zero(Nc, Nc*N);
+    for (std::size_t k = 0; k < N; ++k) {
+        const Complex& p = poles_[k];
+        if (p.imag() == 0.0) {
+            Ap(k,k) = p.real();
+            bp(k) = 1.0;
+            for (std::size_t j = 0; j < Nc; ++j) {
+                C.col(j*N + k) = residues_[k].col(j).real();
+            }
+            continue;
+        }
+        if (k+1 >= N ||
+                std::abs(poles_[k+1] - std::conj(p)) >
+                    symmetryTolerance_ * std::abs(p)) {
+            return false;
+        }
+        Ap(k,  k) =  p.real();
+        Ap(k,k+1) =  p.imag();
+        Ap(k+1,k) = -p.imag();
+        Ap(k+1,k+1) = p.real();
+        bp(k) = 2.0;
+        for (std::size_t j = 0; j < Nc; ++j) {
+            C.col(j*N + k)   = residues_[k].col(j).real();
+            C.col(j*N + k+1) = residues_[k].col(j).imag();
+        }
+        k++;
+    }
+
+    // S = A B D^-1 C - A^2. Row block j of A B D^-1 C is the outer product
+    // of A_p b_p with row j of D^-1 C.
+    const MatrixXd DinvC = lu.solve(C);
+    const MatrixXd Ap2 = Ap * Ap;
+    const VectorXd Apbp = Ap * bp;
+    MatrixXd S(Nc*N, Nc*N);
+    for (std::size_t j = 0; j < Nc; ++j) {
+        S.block(j*N, 0, N, Nc*N) = Apbp * DinvC.row(j);
+        S.block(j*N, j*N, N, N) -= Ap2;
+    }
+
+    EigenSolver<MatrixXd> eig(S, false);
+    if (eig.info() != Success) {
+        return false;
+    }
+    crossings_.clear();
+    for (MatrixXd::Index i = 0; i < eig.eigenvalues().size(); ++i) {
+        const Complex lambda = eig.eigenvalues()(i);
+        if (lambda.real() > 0.0 &&
+                std::abs(lambda.imag()) <= imagTolerance_ * std::abs(lambda)) {
+            crossings_.push_back(std::sqrt(lambda.real()));
+        }
+    }
+    std::sort(crossings_.begin(), crossings_.end());
+    crossings_.erase(
+            std::unique(crossings_.begin(), crossings_.end(),
+                    [](const Real a, const Real b) {
+                        return b - a <= 1e-12 * b;
+                    }),
+            crossings_.end());
+    return true;
+}
+
+/**
+ * Samples the minimum eigenvalue on a logarithmic grid spanning two decades
+ * beyond the poles and refines each sign change by bisection.
+ */
+void Passivity::samplingCrossings_() {
+    Real wMin = std::numeric_limits<Real>::max(), wMax = 0.0;
+    for (std::size_t k = 0; k < poles_.size(); ++k) {
+        const Real mag = std::abs(poles_[k]);
+        if (mag > 0.0) {
+            wMin = std::min(wMin, mag);
+            wMax = std::max(wMax, mag);
+        }
+    }
+    if (wMax == 0.0) {
+        wMin = wMax = 1.0;
+    }
+    wMin /= 100.0;
+    wMax *= 100.0;
+
+    const std::size_t nSamples = std::max((std::size_t) 2, (std::size_t)
+            std::ceil(std::log10(wMax / wMin) * samplesPerDecade_) + 1);
+    std::vector<Real> w(nSamples + 1), eig(nSamples + 1);
+    w[0] = 0.0;
+    for (std::size_t i = 0; i < nSamples; ++i) {
+        w[i+1] = wMin *
+                std::pow(wMax / wMin, (Real) i / (Real) (nSamples - 1));
+    }
+#pragma omp parallel for schedule(static)
+    for (long i = 0; i < (long) w.size(); ++i) {
+        eig[i] = minEigenvalue(w[i]);
+    }
+
+    std::vector<std::size_t> changes;
+    for (std::size_t i = 0; i+1 < w.size(); ++i) {
+        if ((eig[i] < 0.0) != (eig[i+1] < 0.0)) {
+            changes.push_back(i);
+        }
+    }
+    crossings_.assign(changes.size(), 0.0);
+#pragma omp parallel for schedule(dynamic)
+    for (long c = 0; c < (long) changes.size(); ++c) {
+        const std::size_t i = changes[c];
+        crossings_[c] = bisect_(w[i], w[i+1], eig[i]);
+    }
+}
+
+Real Passivity::bisect_(Real lo, Real hi, Real fLo) const {
+    for (std::size_t iter = 0; iter < bisections_; ++iter) {
+        const Real mid = 0.5 * (lo + hi);
+        const Real fMid = minEigenvalue(mid);
+        if ((fMid < 0.0) == (fLo < 0.0)) {
+            lo = mid;
+            fLo = fMid;
+        } else {
+            hi = mid;
+        }
+    }
+    return 0.5 * (lo + hi);
+}
+
+/**
+ * Samples each band delimited by the crossings and keeps those with a
+ * negative eigenvalue. The last band extends to infinity, where Y tends
+ * to D.
+ */
+void Passivity::classify_() {
+    Real wMax = 0.0;
+    for (std::size_t k = 0; k < poles_.size(); ++k) {
+        wMax = std::max(wMax, std::abs(poles_[k]));
+    }
+
+    std::vector<Real> edges(1, 0.0);
+    edges.insert(edges.end(), crossings_.begin(), crossings_.end());
+    edges.push_back(std::numeric_limits<Real>::infinity());
+    const std::size_t nBands = edges.size() - 1;
+
+    std::vector<Band> bands(nBands);
+#pragma omp parallel for schedule(dynamic)
+    for (long b = 0; b < (long) nBands; ++b) {
+        const Real from = edges[b];
+        const Real to = edges[b+1];
+        std::vector<Real> w;
+        if (std::isinf(to)) {
+            const Real lo = (from > 0.0) ? from : std::max(wMax, 1.0) * 1e-3;
+            const Real hi = 100.0 * std::max(std::max(wMax, lo), 1.0);
+            for (std::size_t i = 1; i <= samplesPerBand_; ++i) {
+                w.push_back(lo * std::pow(hi / lo,
+                        (Real) i / (Real) samplesPerBand_));
+            }
+            if (from == 0.0) {
+                w.push_back(0.0);
+            }
+            w.push_back(to);
+        } else {
+            for (std::size_t i = 1; i <= samplesPerBand_; ++i) {
+                w.push_back(from + (to - from) *
+                        (Real) i / (Real) (samplesPerBand_ + 1));
+            }
+        }
+        Band& band = bands[b];
+        band.from = from;
+        band.to = to;
+        band.worst = w.front();
+        band.minEigenvalue = std::numeric_limits<Real>::max();
+        for (std::size_t i = 0; i < w.size(); ++i) {
+            const Real eig = minEigenvalue(w[i]);
+            if (eig < band.minEigenvalue) {
+                band.minEigenvalue = eig;
+                band.worst = w[i];
+            }
+        }
+    }
+
+    violations_.clear();
+    for (std::size_t b = 0; b < nBands; ++b) {
+        if (bands[b].minEigenvalue < 0.0) {
+            violations_.push_back(bands[b]);
+        }
+    }
+}
+
+bool Passivity::isReciprocal_() const {
+    if ((D_ - D_.transpose()).norm() > symmetryTolerance_ * D_.norm() ||
+            (E_ - E_.transpose()).norm() > symmetryTolerance_ * E_.norm()) {
+        return false;
+    }
+    for (std::size_t k = 0; k < residues_.size(); ++k) {
+        if ((residues_[k] - residues_[k].transpose()).norm() >
+                symmetryTolerance_ * residues_[k].norm()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} /* namespace VectorFitting */
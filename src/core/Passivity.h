@@ -0,0 +1,117 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Alejandro García Montoro        (alejandro.garciamontoro@gmail.com)
+//					  Alejandra López de Aberasturi Gómez (aloaberasturi@ugr.es)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef VECTOR_FITTING_PASSIVITY_H_
+#define VECTOR_FITTING_PASSIVITY_H_
+
+#include "Driver.h"
+
+namespace VectorFitting {
+
+/**
+ * Passivity assessment of a rational admittance model
+ *      Y(s) = sum_k R_k / (s - p_k) + D + s E.
+ * The model is passive when the eigenvalues of the hermitian part of
+ * Y(jw) are non-negative at every frequency.
+ *
+ * Frequencies where an eigenvalue crosses zero are computed from the
+ * half-size test matrix S = A (B D^-1 C - A) of a real realization of the
+ * model. The eigenvalues of S are -s^2 with s the zeros of Y(s) + Y(-s),
+ * so that each positive real eigenvalue w^2 is a crossing at w. A is block
+ * diagonal, so S is assembled as a rank Nc correction of A^2. Between two
+ * consecutive crossings the sign of the eigenvalues does not change and
+ * each band is classified by sampling it.
+ *
+ * When the test matrix cannot be used (singular D or non-reciprocal model)
+ * crossings are located by adaptive sampling of the minimum eigenvalue.
+ * In both cases bands are processed in parallel.
+ */
+class Passivity {
+public:
+    enum class Method {
+        halfSizeMatrix,
+        sampling
+    };
+
+    /**
+     * A frequency band in which the model is not passive.
+     * @param from, to      Band limits, in rad/s. to may be infinity.
+     * @param worst         Frequency with the most negative eigenvalue.
+     * @param minEigenvalue Eigenvalue at worst.
+     */
+    struct Band {
+        Real from;
+        Real to;
+        Real worst;
+        Real minEigenvalue;
+    };
+
+    Passivity(const Driver& driver,
+              const Method method = Method::halfSizeMatrix);
+    Passivity(const std::vector<Complex>& poles,
+              const std::vector<MatrixXcd>& residues,
+              const MatrixXcd& D,
+              const MatrixXcd& E,
+              const Method method = Method::halfSizeMatrix);
+
+    bool isPassive() const {return violations_.empty();}
+
+    /**
+     * Method actually used, sampling if the half-size matrix was requested
+     * but could not be applied.
+     */
+    Method getMethod() const {return method_;}
+    const std::vector<Real>& getCrossings() const {return crossings_;}
+    const std::vector<Band>& getViolations() const {return violations_;}
+
+    /**
+     * Minimum eigenvalue of (Y(jw) + Y(jw)^H) / 2.
+     */
+    Real minEigenvalue(const Real w) const;
+
+private:
+    std::vector<Complex> poles_;
+    std::vector<MatrixXcd> residues_;
+    MatrixXcd D_;
+    MatrixXcd E_;
+
+    Method method_;
+    std::vector<Real> crossings_;
+    std::vector<Band> violations_;
+
+    static constexpr Real imagTolerance_     = 1e-6;
+    static constexpr Real symmetryTolerance_ = 1e-10;
+    static constexpr std::size_t samplesPerBand_   = 32;
+    static constexpr std::size_t samplesPerDecade_ = 200;
+    static constexpr std::size_t bisections_       = 60;
+
+    void assess_(const Method method);
+    bool halfSizeCrossings_();
+    void samplingCrossings_();
+    void classify_();
+    Real bisect_(Real lo, Real hi, Real fLo) const;
+    bool isReciprocal_() const;
+};
+
+} /* namespace VectorFitting */
+
+#endif // VECTOR_FITTING_PASSIVITY_H_
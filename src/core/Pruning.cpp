@@ -0,0 +1,178 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Alejandro García Montoro        (alejandro.garciamontoro@gmail.com)
+//					  Alejandra López de Aberasturi Gómez (aloaberasturi@ugr.es)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+#include "Pruning.h"
+
+namespace VectorFitting {
+
+Pruning::Pruning(const std::vector<Fitting::Sample>& samples,
+                 const Options& options,
+                 const std::vector<Complex>& poles,
+                 const MatrixXcd& residues,
+                 const VectorXcd& D,
+                 const VectorXcd& E,
+                 const Real tolerance) :
+                poles_(poles),
+                residues_(residues),
+                D_(D),
+                E_(E) {
+    prune_(samples, options, tolerance);
+}
+
+Pruning::Pruning(const Driver& driver,
+                 const Options& options,
+                 const Real tolerance) :
+                poles_(driver.getPoles()),
+                residues_(driver.getPackedResidues()),
+                D_(driver.getPackedD()),
+                E_(driver.getPackedE()) {
+    prune_(pack_(driver.getSamples()), options, tolerance);
+}
+
+void Pruning::prune_(const std::vector<Fitting::Sample>& samples,
+                     const Options& options,
+                     const Real tolerance) {
+    if (samples.empty()) {
+        throw std::runtime_error("Samples size cannot be zero");
+    }
+    const Index Nc = samples.front().second.size();
+    if ((size_t) residues_.cols() != poles_.size() || residues_.rows() != Nc ||
+            D_.size() != Nc || E_.size() != Nc) {
+        throw std::runtime_error("Model and samples have inconsistent sizes");
+    }
+    if (tolerance < 0.0) {
+        throw std::runtime_error("Tolerance cannot be negative");
+    }
+
+    originalRMSE_ = calcRMSE_(samples, poles_, residues_, D_, E_);
+    rmse_ = originalRMSE_;
+    Real norm = 0.0;
+    for (size_t i = 0; i < samples.size(); ++i) {
+        norm += samples[i].second.squaredNorm();
+    }
+    const Real maxRMSE = std::max((1.0 + tolerance) * originalRMSE_,
+            rmseFloor_ * std::sqrt(norm / (Real) (samples.size() *
+                                                  samples.size())));
+
+    // Residues are identified again in complex form, with the same trend.
+    Options opts = options;
+    opts.setComplexSpaceState(true);
+    opts.setSkipPoleIdentification(true);
+    opts.setSkipResidueIdentification(false);
+    const Weights weights = Weights::build(samples, opts.getWeighting());
+
+    const std::vector<Complex> poles = poles_;
+    const RowVectorXi cindex = Fitting::getCIndex(poles);
+    const std::vector<std::pair<Real, size_t>> ranking =
+            rank(samples, poles, residues_);
+    std::vector<bool> kept(poles.size(), true);
+    size_t remaining = poles.size();
+    for (size_t g = 0; g < ranking.size(); ++g) {
+        const size_t first = ranking[g].second;
+        const size_t size = (cindex(first) == 1) ? 2 : 1;
+        if (remaining <= size) {
+            break;
+        }
+        std::vector<Complex> candidate;
+        for (size_t k = 0; k < poles.size(); ++k) {
+            if (kept[k] && (k < first || k >= first + size)) {
+                candidate.push_back(poles[k]);
+            }
+        }
+
+        Fitting fitting(samples, opts, candidate, weights);
+        fitting.fit();
+        const Real rmse = fitting.getRMSE();
+        if (!(rmse <= maxRMSE)) {
+            break;
+        }
+        for (size_t k = first; k < first + size; ++k) {
+            kept[k] = false;
+            removed_.push_back(poles[k]);
+        }
+        remaining -= size;
+        poles_ = fitting.getPoles();
+        residues_ = fitting.getC();
+        D_ = fitting.getD();
+        E_ = fitting.getE();
+        rmse_ = rmse;
+    }
+}
+
+std::vector<std::pair<Real, size_t>> Pruning::rank(
+        const std::vector<Fitting::Sample>& samples,
+        const std::vector<Complex>& poles,
+        const MatrixXcd& residues) {
+    const RowVectorXi cindex = Fitting::getCIndex(poles);
+    std::vector<std::pair<Real, size_t>> res;
+    for (size_t k = 0; k < poles.size(); ++k) {
+        Real contribution = 0.0;
+        for (size_t i = 0; i < samples.size(); ++i) {
+            contribution += residues.col(k).squaredNorm() /
+                    std::norm(samples[i].first - poles[k]);
+        }
+        if (cindex(k) == 2) {
+            res.back().first += contribution;
+        } else {
+            res.push_back(std::make_pair(contribution, k));
+        }
+    }
+    for (size_t g = 0; g < res.size(); ++g) {
+        res[g].first = std::sqrt(res[g].first / (Real) samples.size());
+    }
+    std::stable_sort(res.begin(), res.end(),
+            [](const std::pair<Real, size_t>& lhs,
+               const std::pair<Real, size_t>& rhs) {
+        return lhs.first < rhs.first;
+    });
+    return res;
+}
+
+Real Pruning::calcRMSE_(const std::vector<Fitting::Sample>& samples,
+                        const std::vector<Complex>& poles,
+                        const MatrixXcd& residues,
+                        const VectorXcd& D,
+                        const VectorXcd& E) {
+    Real error = 0.0;
+    for (size_t i = 0; i < samples.size(); ++i) {
+        const Complex s = samples[i].first;
+        VectorXcd fitted = D + s * E;
+        for (size_t k = 0; k < poles.size(); ++k) {
+            fitted += residues.col(k) / (s - poles[k]);
+        }
+        error += (samples[i].second - fitted).squaredNorm();
+    }
+    return std::sqrt(error / (Real) (samples.size() * samples.size()));
+}
+
+std::vector<Fitting::Sample> Pruning::pack_(
+        const std::vector<Driver::Sample>& samples) {
+    std::vector<Fitting::Sample> res;
+    res.reserve(samples.size());
+    for (size_t i = 0; i < samples.size(); ++i) {
+        res.push_back(Fitting::Sample(samples[i].first,
+                                      Driver::pack(samples[i].second)));
+    }
+    return res;
+}
+
+} /* namespace VectorFitting */
@@ -0,0 +1,124 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Alejandro García Montoro        (alejandro.garciamontoro@gmail.com)
+//					  Alejandra López de Aberasturi Gómez (aloaberasturi@ugr.es)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef VECTOR_FITTING_PRUNING_H_
+#define VECTOR_FITTING_PRUNING_H_
+
+#include "Driver.h"
+
+namespace VectorFitting {
+
+/**
+ * Order reduction of a fitted model by removing poles whose residues are
+ * negligible in every response. Poles are ranked by the RMS over the
+ * samples of their contribution
+ *      ||r_k|| / |s_i - p_k|,
+ * with conjugated pairs ranked and removed together. Starting with the
+ * least significant, poles are removed one group at a time and residues,
+ * D and E identified again with the remaining ones, as long as the RMSE
+ * stays below (1 + tolerance) times the one of the original model. The
+ * first group which cannot be removed ends the reduction.
+ *
+ * Residues are given and returned in complex form, one column per pole.
+ */
+class Pruning {
+public:
+    /**
+     * @param samples    Data that was fitted.
+     * @param options    Options of the fitting, for the asymptotic trend
+     *                   and the weighting of the identification.
+     * @param poles      Poles of the model.
+     * @param residues   Residues of the model, size Nc x N.
+     * @param D, E       Constant and linear terms, size Nc.
+     * @param tolerance  Allowed relative increase of the RMSE.
+     */
+    Pruning(const std::vector<Fitting::Sample>& samples,
+            const Options& options,
+            const std::vector<Complex>& poles,
+            const MatrixXcd& residues,
+            const VectorXcd& D,
+            const VectorXcd& E,
+            const Real tolerance = 0.1);
+    /**
+     * Reduces the packed model of a driver, which is rebuilt with
+     *      Driver(driver.getSamples(), getPoles(), getResidues(),
+     *             getD(), getE())
+     */
+    Pruning(const Driver& driver,
+            const Options& options,
+            const Real tolerance = 0.1);
+
+    const std::vector<Complex>& getPoles() const {return poles_;}
+    const MatrixXcd& getResidues() const {return residues_;}
+    const VectorXcd& getD() const {return D_;}
+    const VectorXcd& getE() const {return E_;}
+
+    /**
+     * Removed poles, in the order they were removed.
+     */
+    const std::vector<Complex>& getRemovedPoles() const {return removed_;}
+
+    /**
+     * RMSE of the original and the reduced models, normalized as in
+     * Fitting::getRMSE().
+     */
+    Real getOriginalRMSE() const {return originalRMSE_;}
+    Real getRMSE() const {return rmse_;}
+
+    /**
+     * RMS over the samples of the contribution of each group of poles,
+     * a real pole or a conjugated pair. Groups are given as the index of
+     * their first pole.
+     */
+    static std::vector<std::pair<Real, size_t>> rank(
+            const std::vector<Fitting::Sample>& samples,
+            const std::vector<Complex>& poles,
+            const MatrixXcd& residues);
+
+private:
+    std::vector<Complex> poles_;
+    MatrixXcd residues_;
+    VectorXcd D_;
+    VectorXcd E_;
+    std::vector<Complex> removed_;
+    Real originalRMSE_;
+    Real rmse_;
+
+    // Errors below this, relative to the RMS of the samples, are taken as
+    // exact so that exact models can still be reduced.
+    static constexpr Real rmseFloor_ = 1e-12;
+
+    void prune_(const std::vector<Fitting::Sample>& samples,
+                const Options& options,
+                const Real tolerance);
+    static Real calcRMSE_(const std::vector<Fitting::Sample>& samples,
+                         const std::vector<Complex>& poles,
+                         const MatrixXcd& residues,
+                         const VectorXcd& D,
+                         const VectorXcd& E);
+    static std::vector<Fitting::Sample> pack_(
+            const std::vector<Driver::Sample>& samples);
+};
+
+} /* namespace VectorFitting */
+
+#endif // VECTOR_FITTING_PRUNING_H_
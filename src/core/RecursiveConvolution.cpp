@@ -0,0 +1,226 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Alejandro García Montoro        (alejandro.garciamontoro@gmail.com)
+//					  Alejandra López de Aberasturi Gómez (aloaberasturi@ugr.es)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+#include "RecursiveConvolution.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace VectorFitting {
+
+RecursiveConvolution::RecursiveConvolution(
+        const Driver& driver,
+        const Real dt,
+        const std::size_t nCells) :
+                Nc_(driver.getNumberOfPorts()),
+                nCells_(nCells),
+                dt_(dt) {
+    std::pair<std::vector<Complex>, std::vector<MatrixXcd>> pR = driver.ss2pr();
+    init_(pR.first, pR.second, driver.getD(), driver.getE());
+}
+
+RecursiveConvolution::RecursiveConvolution(
+        const std::vector<Complex>& poles,
+        const std::vector<MatrixXcd>& residues,
+        const MatrixXcd& D,
+        const MatrixXcd& E,
+        const Real dt,
+        const std::size_t nCells) :
+                Nc_(D.rows()),
+                nCells_(nCells),
+                dt_(dt) {
+    init_(poles, residues, D, E);
+}
+
+void RecursiveConvolution::init_(
+        const std::vector<Complex>& poles,
+        const std::vector<MatrixXcd>& residues,
+        const MatrixXcd& D,
+        const MatrixXcd& E) {
+    if (!(dt_ > 0.0)) {
+        throw std::runtime_error("Time step must be positive");
+    }
+    if (poles.size() != residues.size()) {
+        throw std::runtime_error(
+                "Poles and residues must have the same size");
+    }
+    if (D.rows() != D.cols() ||
+            E.rows() != D.rows() || E.cols() != D.cols()) {
+        throw std::runtime_error("D and E must be square and of same size");
+    }
+
+    D_ = D.real();
+    E_ = E.real();
+    G_ = D_ + E_ / dt_;
+
+    for (std::size_t k = 0; k < poles.size(); ++k) {
+        const Complex& p = poles[k];
+        if (residues[k].rows() != D.rows() || residues[k].cols() != D.cols()) {
+            throw std::runtime_error("Residues and D must have same size");
+        }
+        Real factor = 1.0;
+        if (p.imag() != 0.0) {
+            if (k+1 >= poles.size() ||
+                    std::abs(poles[k+1] - std::conj(p)) > 1e-10*std::abs(p)) {
+                throw std::runtime_error(
+                        "Complex poles must come in adjacent conjugated pairs");
+            }
+            factor = 2.0;
+        }
+
+        // Series expansion of the weights avoids cancellation for poles
+        // which are slow compared to the time step.
+        const Complex x = p * dt_;
+        const Complex alpha = std::exp(x);
+        Complex w0, w1;
+        if (std::abs(x) < 1e-2) {
+            w1 = dt_ * (1.0/2.0 + x*(1.0/6.0 + x*(1.0/24.0 +
+                    x*(1.0/120.0 + x*(1.0/720.0)))));
+            w0 = dt_ * (1.0/2.0 + x*(1.0/3.0 + x*(1.0/8.0 +
+                    x*(1.0/30.0 + x*(1.0/144.0)))));
+        } else {
+            w1 = -1.0/p + (alpha - 1.0) / (p*p*dt_);
+            w0 = (alpha - 1.0) / p - w1;
+        }
+        alphaRe_.push_back(alpha.real());
+        alphaIm_.push_back(alpha.imag());
+        w0Re_.push_back(w0.real());
+        w0Im_.push_back(w0.imag());
+        w1Re_.push_back(w1.real());
+        w1Im_.push_back(w1.imag());
+
+        const MatrixXcd R = factor * residues[k];
+        for (std::size_t j = 0; j < Nc_; ++j) {
+            for (std::size_t m = 0; m < Nc_; ++m) {
+                resRe_.push_back(R(m,j).real());
+                resIm_.push_back(R(m,j).imag());
+            }
+        }
+        G_ += (R * w1).real();
+
+        if (factor == 2.0) {
+            k++;
+        }
+    }
+    reset();
+}
+
+void RecursiveConvolution::reset() {
+    psiRe_.assign(alphaRe_.size() * Nc_ * nCells_, 0.0);
+    psiIm_.assign(alphaRe_.size() * Nc_ * nCells_, 0.0);
+    vPrev_.assign(Nc_ * nCells_, 0.0);
+}
+
+void RecursiveConvolution::history(Real* h) const {
+    const std::size_t nC = nCells_;
+    const Real* vp = vPrev_.data();
+    for (std::size_t m = 0; m < Nc_; ++m) {
+        Real* hm = h + m*nC;
+        for (std::size_t c = 0; c < nC; ++c) {
+            hm[c] = 0.0;
+        }
+        for (std::size_t j = 0; j < Nc_; ++j) {
+            const Real e = -E_(m,j) / dt_;
+            const Real* vpj = vp + j*nC;
+#pragma omp simd
+            for (std::size_t c = 0; c < nC; ++c) {
+                hm[c] += e * vpj[c];
+            }
+        }
+    }
+    for (std::size_t k = 0; k < alphaRe_.size(); ++k) {
+        const Real aRe = alphaRe_[k], aIm = alphaIm_[k];
+        const Real w0Re = w0Re_[k], w0Im = w0Im_[k];
+        for (std::size_t j = 0; j < Nc_; ++j) {
+            const Real* pRe = psiRe_.data() + (k*Nc_ + j)*nC;
+            const Real* pIm = psiIm_.data() + (k*Nc_ + j)*nC;
+            const Real* vpj = vp + j*nC;
+            for (std::size_t m = 0; m < Nc_; ++m) {
+                const Real rRe = resRe_[(k*Nc_ + j)*Nc_ + m];
+                const Real rIm = resIm_[(k*Nc_ + j)*Nc_ + m];
+                Real* hm = h + m*nC;
+#pragma omp simd
+                for (std::size_t c = 0; c < nC; ++c) {
+                    const Real qRe = aRe*pRe[c] - aIm*pIm[c] + w0Re*vpj[c];
+                    const Real qIm = aRe*pIm[c] + aIm*pRe[c] + w0Im*vpj[c];
+                    hm[c] += rRe*qRe - rIm*qIm;
+                }
+            }
+        }
+    }
+}
+
+void RecursiveConvolution::step(const Real* v, Real* i) {
+    const std::size_t nC = nCells_;
+    Real* vp = vPrev_.data();
+
+    for (std::size_t m = 0; m < Nc_; ++m) {
+        Real* im = i + m*nC;
+        for (std::size_t c = 0; c < nC; ++c) {
+            im[c] = 0.0;
+        }
+        for (std::size_t j = 0; j < Nc_; ++j) {
+            const Real d = D_(m,j) + E_(m,j) / dt_;
+            const Real e = -E_(m,j) / dt_;
+            const Real* vj = v + j*nC;
+            const Real* vpj = vp + j*nC;
+#pragma omp simd
+            for (std::size_t c = 0; c < nC; ++c) {
+                im[c] += d * vj[c] + e * vpj[c];
+            }
+        }
+    }
+
+    for (std::size_t k = 0; k < alphaRe_.size(); ++k) {
+        const Real aRe = alphaRe_[k], aIm = alphaIm_[k];
+        const Real w0Re = w0Re_[k], w0Im = w0Im_[k];
+        const Real w1Re = w1Re_[k], w1Im = w1Im_[k];
+        for (std::size_t j = 0; j < Nc_; ++j) {
+            Real* pRe = psiRe_.data() + (k*Nc_ + j)*nC;
+            Real* pIm = psiIm_.data() + (k*Nc_ + j)*nC;
+            const Real* vj = v + j*nC;
+            const Real* vpj = vp + j*nC;
+#pragma omp simd
+            for (std::size_t c = 0; c < nC; ++c) {
+                const Real re = aRe*pRe[c] - aIm*pIm[c] +
+                                w0Re*vpj[c] + w1Re*vj[c];
+                const Real im = aRe*pIm[c] + aIm*pRe[c] +
+                                w0Im*vpj[c] + w1Im*vj[c];
+                pRe[c] = re;
+                pIm[c] = im;
+            }
+            for (std::size_t m = 0; m < Nc_; ++m) {
+                const Real rRe = resRe_[(k*Nc_ + j)*Nc_ + m];
+                const Real rIm = resIm_[(k*Nc_ + j)*Nc_ + m];
+                Real* im = i + m*nC;
+#pragma omp simd
+                for (std::size_t c = 0; c < nC; ++c) {
+                    im[c] += rRe*pRe[c] - rIm*pIm[c];
+                }
+            }
+        }
+    }
+
+    std::copy(v, v + Nc_*nC, vp);
+}
+
+} /* namespace VectorFitting */
@@ -0,0 +1,112 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Alejandro García Montoro        (alejandro.garciamontoro@gmail.com)
+//					  Alejandra López de Aberasturi Gómez (aloaberasturi@ugr.es)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef VECTOR_FITTING_RECURSIVE_CONVOLUTION_H_
+#define VECTOR_FITTING_RECURSIVE_CONVOLUTION_H_
+
+#include "Driver.h"
+
+namespace VectorFitting {
+
+/**
+ * Time domain counterpart of a rational admittance model
+ *      Y(s) = sum_k R_k / (s - p_k) + D + s E,
+ * advanced with piecewise linear recursive convolution. For a time step dt
+ * each pole has a state psi_k = int e^{p_k (t - tau)} v(tau) dtau, updated
+ * as
+ *      psi_k^{n+1} = alpha_k psi_k^n + w0_k v^n + w1_k v^{n+1},
+ *      alpha_k = exp(p_k dt),
+ *      w1_k = -1/p_k + (alpha_k - 1) / (p_k^2 dt),
+ *      w0_k = (alpha_k - 1) / p_k - w1_k,
+ * and the current is
+ *      i^{n+1} = D v^{n+1} + E (v^{n+1} - v^n) / dt + sum_k R_k psi_k^{n+1}.
+ *
+ * Only one pole of each conjugated pair is kept, its contribution is twice
+ * the real part. States are stored as separate real and imaginary arrays,
+ * contiguous along cells, so that each update vectorizes over cells.
+ *
+ * Voltages and currents are passed as arrays of size Nc * nCells with the
+ * value of port j at cell c in position j * nCells + c.
+ */
+class RecursiveConvolution {
+public:
+    RecursiveConvolution(const Driver& driver,
+                         const Real dt,
+                         const std::size_t nCells = 1);
+    RecursiveConvolution(const std::vector<Complex>& poles,
+                         const std::vector<MatrixXcd>& residues,
+                         const MatrixXcd& D,
+                         const MatrixXcd& E,
+                         const Real dt,
+                         const std::size_t nCells = 1);
+
+    std::size_t getNumberOfPorts() const {return Nc_;}
+    std::size_t getNumberOfCells() const {return nCells_;}
+    Real getTimeStep() const {return dt_;}
+
+    /**
+     * Instantaneous conductance G such that i^{n+1} = G v^{n+1} + h^n.
+     */
+    const MatrixXd& getConductance() const {return G_;}
+
+    /**
+     * History current h^n, which depends on past voltages only. Intended
+     * for solvers that find v^{n+1} implicitly.
+     */
+    void history(Real* h) const;
+
+    /**
+     * Advances one time step with the voltages v^{n+1} and writes the
+     * currents i^{n+1}.
+     */
+    void step(const Real* v, Real* i);
+
+    void reset();
+
+private:
+    std::size_t Nc_;
+    std::size_t nCells_;
+    Real dt_;
+
+    // Coefficients of the kept poles.
+    std::vector<Real> alphaRe_, alphaIm_;
+    std::vector<Real> w0Re_, w0Im_;
+    std::vector<Real> w1Re_, w1Im_;
+    // Residues scaled by 1 or 2, Nc x Nc per pole, column major.
+    std::vector<Real> resRe_, resIm_;
+    MatrixXd D_;
+    MatrixXd E_;
+    MatrixXd G_;
+
+    // States of pole k, port j at cell c: (k * Nc + j) * nCells + c.
+    std::vector<Real> psiRe_, psiIm_;
+    std::vector<Real> vPrev_;
+
+    void init_(const std::vector<Complex>& poles,
+               const std::vector<MatrixXcd>& residues,
+               const MatrixXcd& D,
+               const MatrixXcd& E);
+};
+
+} /* namespace VectorFitting */
+
+#endif // VECTOR_FITTING_RECURSIVE_CONVOLUTION_H_
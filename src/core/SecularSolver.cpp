@@ -0,0 +1,241 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Alejandro García Montoro        (alejandro.garciamontoro@gmail.com)
+//					  Alejandra López de Aberasturi Gómez (aloaberasturi@ugr.es)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+#include "SecularSolver.h"
+
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace VectorFitting {
+
+SecularSolver::SecularSolver(
+        const std::vector<Complex>& poles,
+        const std::vector<Complex>& residues,
+        const Real d) :
+                poles_(poles),
+                residues_(residues),
+                d_(d) {
+    if (poles_.size() != residues_.size()) {
+        throw std::runtime_error(
+                "Poles and residues of sigma must have same size");
+    }
+}
+
+bool SecularSolver::solve() {
+    const Real eps = std::numeric_limits<Real>::epsilon();
+    zeros_.clear();
+
+    if (poles_.empty()) {
+        return true;
+    }
+    if (d_ == 0.0 || !std::isfinite(d_)) {
+        return false;
+    }
+
+    Real residuesNorm = 0.0;
+    for (std::size_t k = 0; k < residues_.size(); ++k) {
+        residuesNorm += std::abs(residues_[k]);
+    }
+
+    // Deflation. A pole with a negligible residue cancels with a zero of
+    // sigma. Repeated poles are merged, leaving one zero in their place.
+    std::vector<Complex> found;
+    std::vector<Complex> p, r;
+    for (std::size_t k = 0; k < poles_.size(); ++k) {
+        const Real tol = 16.0 * eps *
+                (residuesNorm + std::abs(d_) * std::abs(poles_[k]));
+        if (std::abs(residues_[k]) <= tol) {
+            found.push_back(poles_[k]);
+            continue;
+        }
+        bool merged = false;
+        for (std::size_t j = 0; j < p.size(); ++j) {
+            if (std::abs(p[j] - poles_[k]) <= 16.0*eps*std::abs(poles_[k])) {
+                r[j] += residues_[k];
+                found.push_back(poles_[k]);
+                merged = true;
+                break;
+            }
+        }
+        if (!merged) {
+            p.push_back(poles_[k]);
+            r.push_back(residues_[k]);
+        }
+    }
+    const std::size_t M = p.size();
+
+    // Starting points: first order estimate of the zero close to each pole,
+    // z = p_k - r_k / g(p_k), being g the rest of sigma. A small rotation
+    // breaks the conjugate symmetry, otherwise real starting points could
+    // never reach a complex pair.
+    std::vector<Complex> z(M);
+    for (std::size_t k = 0; k < M; ++k) {
+        Complex g = d_;
+        for (std::size_t j = 0; j < M; ++j) {
+            if (j != k) {
+                g += r[j] / (p[k] - p[j]);
+            }
+        }
+        z[k] = (std::abs(g) > 0.0) ? p[k] - r[k] / g : p[k];
+        const Real theta = 2.0 * M_PI * (Real) k / (Real) M + 0.5;
+        z[k] += (1e-6 * std::abs(z[k]) + eps) *
+                Complex(std::cos(theta), std::sin(theta));
+    }
+
+    // Aberth-Ehrlich iterations on P(s) = sigma(s) prod_k (s - p_k). The
+    // term of the pole closest to z is taken out of sigma, sigma = r_m/h + g
+    // with h = z - p_m, so that its logarithmic derivative,
+    //      P'/P = (g + g' h) / (r_m + g h) + sum_{k != m} 1/(z - p_k),
+    // does not suffer from cancellation when zeros get close to poles.
+    // Iterations stop when corrections reach machine precision or stagnate
+    // at the rounding level of the evaluation.
+    std::vector<bool> converged(M, false);
+    std::vector<Real> previous(M, std::numeric_limits<Real>::max());
+    std::size_t active = M;
+    for (std::size_t iter = 0; iter < maxIterations_ && active > 0; ++iter) {
+        active = 0;
+        for (std::size_t i = 0; i < M; ++i) {
+            if (converged[i]) {
+                continue;
+            }
+            std::size_t m = 0;
+            for (std::size_t k = 1; k < M; ++k) {
+                if (std::abs(z[i] - p[k]) < std::abs(z[i] - p[m])) {
+                    m = k;
+                }
+            }
+            const Complex h = z[i] - p[m];
+            Complex g = d_, gp = 0.0, q = 0.0;
+            for (std::size_t k = 0; k < M; ++k) {
+                if (k == m) {
+                    continue;
+                }
+                const Complex inv = Complex(1.0, 0.0) / (z[i] - p[k]);
+                const Complex term = r[k] * inv;
+                g  += term;
+                gp -= term * inv;
+                q  += inv;
+            }
+            const Complex num = r[m] + g * h;
+            if (num == Complex(0.0, 0.0)) {
+                converged[i] = true;
+                continue;
+            }
+            const Complex logDer = (g + gp * h) / num + q;
+            Complex s = 0.0;
+            for (std::size_t j = 0; j < M; ++j) {
+                if (j != i) {
+                    s += Complex(1.0, 0.0) / (z[i] - z[j]);
+                }
+            }
+            const Complex correction = Complex(1.0, 0.0) / (logDer - s);
+            if (!std::isfinite(correction.real()) ||
+                    !std::isfinite(correction.imag())) {
+                return false;
+            }
+            z[i] -= correction;
+            const Real step = std::abs(correction);
+            if (step <= 4.0 * eps * std::abs(z[i]) ||
+                    (step <= std::sqrt(eps) * std::abs(z[i]) &&
+                     step >= 0.5 * previous[i])) {
+                converged[i] = true;
+            } else {
+                active++;
+            }
+            previous[i] = step;
+        }
+    }
+    if (active > 0) {
+        return false;
+    }
+
+    // Backward error check on the secular equation. The bound accounts for
+    // the rounding of the terms and of the zero itself.
+    for (std::size_t i = 0; i < M; ++i) {
+        Complex f = d_;
+        Real scale = std::abs(d_);
+        Real slope = 0.0;
+        for (std::size_t k = 0; k < M; ++k) {
+            const Complex term = r[k] / (z[i] - p[k]);
+            f += term;
+            scale += std::abs(term);
+            slope += std::abs(term / (z[i] - p[k]));
+        }
+        scale += std::abs(z[i]) * slope;
+        if (!(std::abs(f) <= backwardTolerance_ * scale)) {
+            return false;
+        }
+        found.push_back(z[i]);
+    }
+
+    if (found.size() != poles_.size() || !symmetrize_(found)) {
+        return false;
+    }
+    zeros_ = found;
+    return true;
+}
+
+bool SecularSolver::symmetrize_(std::vector<Complex>& zeros) const {
+    std::vector<std::size_t> upper, lower;
+    for (std::size_t i = 0; i < zeros.size(); ++i) {
+        const Real mag = std::abs(zeros[i]);
+        if (std::abs(zeros[i].imag()) <= realTolerance_ * mag) {
+            zeros[i] = Complex(zeros[i].real(), 0.0);
+        } else if (zeros[i].imag() > 0.0) {
+            upper.push_back(i);
+        } else {
+            lower.push_back(i);
+        }
+    }
+    if (upper.size() != lower.size()) {
+        return false;
+    }
+
+    std::vector<bool> used(lower.size(), false);
+    for (std::size_t u = 0; u < upper.size(); ++u) {
+        const Complex zu = zeros[upper[u]];
+        std::size_t best = lower.size();
+        Real bestDist = std::numeric_limits<Real>::max();
+        for (std::size_t l = 0; l < lower.size(); ++l) {
+            if (used[l]) {
+                continue;
+            }
+            const Real dist = std::abs(zu - std::conj(zeros[lower[l]]));
+            if (dist < bestDist) {
+                bestDist = dist;
+                best = l;
+            }
+        }
+        if (best == lower.size() ||
+                bestDist > conjugateTolerance_ * std::abs(zu)) {
+            return false;
+        }
+        used[best] = true;
+        const Complex avg = 0.5 * (zu + std::conj(zeros[lower[best]]));
+        zeros[upper[u]]     = avg;
+        zeros[lower[best]] = std::conj(avg);
+    }
+    return true;
+}
+
+} /* namespace VectorFitting */
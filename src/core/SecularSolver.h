@@ -0,0 +1,79 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Alejandro García Montoro        (alejandro.garciamontoro@gmail.com)
+//					  Alejandra López de Aberasturi Gómez (aloaberasturi@ugr.es)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef VECTOR_FITTING_SECULAR_SOLVER_H_
+#define VECTOR_FITTING_SECULAR_SOLVER_H_
+
+#include <vector>
+
+#include "Types.h"
+
+namespace VectorFitting {
+
+/**
+ * Computes the zeros of sigma(s) = d + sum_k r_k / (s - p_k) without forming
+ * the dense matrix ZER = LAMBD - B C^T / d.
+ *
+ * The zeros are the roots of the secular equation sigma(s) = 0. They are
+ * found with simultaneous Aberth-Ehrlich iterations, which cost O(N^2) per
+ * sweep. Poles with negligible residues and repeated poles are deflated
+ * beforehand, as they are zeros themselves.
+ */
+class SecularSolver {
+public:
+    /**
+     * @param poles     Poles of sigma, conjugated pairs must be adjacent.
+     * @param residues  Residues of sigma, same ordering as poles.
+     * @param d         Constant term of sigma, must be non-zero.
+     */
+    SecularSolver(const std::vector<Complex>& poles,
+                  const std::vector<Complex>& residues,
+                  const Real d);
+
+    /**
+     * Runs the iterations and checks the accuracy of the zeros found.
+     * @return false if the iterations did not converge or the zeros fail
+     *         the backward error or conjugate symmetry checks. In that
+     *         case the caller should fall back to a dense eigensolver.
+     */
+    bool solve();
+
+    const std::vector<Complex>& getZeros() const {return zeros_;}
+
+private:
+    std::vector<Complex> poles_;
+    std::vector<Complex> residues_;
+    Real d_;
+
+    std::vector<Complex> zeros_;
+
+    static constexpr std::size_t maxIterations_ = 200;
+    static constexpr Real backwardTolerance_  = 1e-12;
+    static constexpr Real realTolerance_      = 1e-10;
+    static constexpr Real conjugateTolerance_ = 1e-6;
+
+    bool symmetrize_(std::vector<Complex>& zeros) const;
+};
+
+} /* namespace VectorFitting */
+
+#endif // VECTOR_FITTING_SECULAR_SOLVER_H_
@@ -0,0 +1,180 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Alejandro García Montoro        (alejandro.garciamontoro@gmail.com)
+//					  Alejandra López de Aberasturi Gómez (aloaberasturi@ugr.es)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+#include "Sketch.h"
+
+#include <random>
+#include <stdexcept>
+
+namespace VectorFitting {
+
+Sketch::Sketch(const Index rows,
+               const Index sketchRows,
+               const unsigned long seed) :
+        rows_(rows),
+        sketchRows_(sketchRows),
+        seed_(seed) {
+    if (sketchRows_ <= 0) {
+        throw std::runtime_error("Sketch must have rows");
+    }
+}
+
+MatrixXd Sketch::apply(const MatrixXd& A) const {
+    if (A.rows() != rows_) {
+        throw std::runtime_error("Sketch and matrix sizes differ");
+    }
+    const Index zeta = std::min((Index) zeta_, sketchRows_);
+    const Real scale = 1.0 / std::sqrt((Real) zeta);
+    std::mt19937_64 engine(seed_);
+    std::uniform_int_distribution<Index> target(0, sketchRows_ - 1);
+
+    MatrixXd res = MatrixXd::Zero(sketchRows_, A.cols());
+    for (Index i = 0; i < rows_; ++i) {
+        for (Index k = 0; k < zeta; ++k) {
+            const Index r = target(engine);
+            const Real sign = (engine() & 1) ? scale : -scale;
+            res.row(r) += sign * A.row(i);
+        }
+    }
+    return res;
+}
+
+Index Sketch::sketchRows(const Index cols) {
+    return rowsPerColumn_ * cols;
+}
+
+bool Sketch::isWorthwhile(const Index rows, const Index cols) {
+    return rows > 2 * sketchRows(cols);
+}
+
+bool Sketch::isEmbedding(const MatrixXd& A,
+                         const MatrixXd& R,
+                         const unsigned long seed) {
+    const Index n = R.cols();
+    for (Index j = 0; j < n; ++j) {
+        if (!(std::abs(R(j,j)) > 0.0)) {
+            return false;
+        }
+    }
+    std::mt19937_64 engine(seed);
+    std::normal_distribution<Real> normal;
+    MatrixXd z(n, 4);
+    for (Index i = 0; i < z.size(); ++i) {
+        z(i) = normal(engine);
+    }
+    const MatrixXd y = R.triangularView<Upper>().solve(z);
+    const MatrixXd Ay = A * y;
+    for (Index j = 0; j < z.cols(); ++j) {
+        const Real ratio = Ay.col(j).norm() / z.col(j).norm();
+        if (!(ratio > 1.0 / (1.0 + maxDistortion_) &&
+              ratio < 1.0 / (1.0 - maxDistortion_))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+VectorXd Sketch::solve(const MatrixXd& A,
+                       const VectorXd& b,
+                       const unsigned long seed,
+                       bool* fallback) {
+    if (fallback != nullptr) {
+        *fallback = true;
+    }
+    if (!isWorthwhile(A.rows(), A.cols())) {
+        return A.householderQr().solve(b);
+    }
+
+    MatrixXd Ab(A.rows(), A.cols() + 1);
+    Ab << A, b;
+    const MatrixXd SAb =
+            Sketch(A.rows(), sketchRows(A.cols()), seed).apply(Ab);
+    const HouseholderQR<MatrixXd> qr(SAb.leftCols(A.cols()));
+    const MatrixXd R = qr.matrixQR().topRows(A.cols())
+            .triangularView<Upper>();
+    if (!isEmbedding(A, R, seed + 1)) {
+        return A.householderQr().solve(b);
+    }
+    const auto Rt = R.triangularView<Upper>();
+
+    // Solution of the sketched problem.
+    VectorXd Sb = SAb.col(A.cols());
+    Sb.applyOnTheLeft(qr.householderQ().adjoint());
+    VectorXd x = Rt.solve(Sb.head(A.cols()));
+
+    // LSQR on A R^-1, whose condition number is close to one, for the
+    // correction of x.
+    VectorXd u = b - A * x;
+    Real beta = u.norm();
+    if (beta == 0.0) {
+        if (fallback != nullptr) {
+            *fallback = false;
+        }
+        return x;
+    }
+    u /= beta;
+    VectorXd v = Rt.transpose().solve(A.transpose() * u);
+    Real alpha = v.norm();
+    if (alpha == 0.0) {
+        if (fallback != nullptr) {
+            *fallback = false;
+        }
+        return x;
+    }
+    v /= alpha;
+    VectorXd w = v;
+    VectorXd dy = VectorXd::Zero(A.cols());
+    Real phiBar = beta, rhoBar = alpha;
+    bool converged = false;
+    for (size_t it = 0; it < lsqrIterations_ && !converged; ++it) {
+        u = A * Rt.solve(v) - alpha * u;
+        beta = u.norm();
+        if (beta > 0.0) {
+            u /= beta;
+        }
+        v = Rt.transpose().solve(A.transpose() * u) - beta * v;
+        alpha = v.norm();
+        if (alpha > 0.0) {
+            v /= alpha;
+        }
+        const Real rho = std::hypot(rhoBar, beta);
+        const Real c = rhoBar / rho;
+        const Real s = beta / rho;
+        const Real theta = s * alpha;
+        rhoBar = - c * alpha;
+        const Real phi = c * phiBar;
+        phiBar = s * phiBar;
+        dy += (phi / rho) * w;
+        w = v - (theta / rho) * w;
+        // Normal equations residual, relative to the residual.
+        converged = alpha * std::abs(c) <= lsqrTolerance_ || phiBar == 0.0;
+    }
+    if (!converged) {
+        return A.householderQr().solve(b);
+    }
+    if (fallback != nullptr) {
+        *fallback = false;
+    }
+    return x + Rt.solve(dy);
+}
+
+} /* namespace VectorFitting */
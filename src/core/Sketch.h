@@ -0,0 +1,95 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Alejandro García Montoro        (alejandro.garciamontoro@gmail.com)
+//					  Alejandra López de Aberasturi Gómez (aloaberasturi@ugr.es)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef VECTOR_FITTING_SKETCH_H_
+#define VECTOR_FITTING_SKETCH_H_
+
+#include <eigen3/Eigen/Dense>
+
+#include "Real.h"
+
+namespace VectorFitting {
+
+using namespace Eigen;
+
+/**
+ * Sparse sign embedding: each of the m rows of a matrix is added to zeta
+ * random rows out of d, with random signs and scaled by 1/sqrt(zeta). With
+ * d a few times the number of columns it preserves the norms of the
+ * column space up to a small distortion with high probability, so that
+ * tall least squares problems can be solved on d rows. Applying it costs
+ * O(zeta nnz), the signs are drawn again from the seed on each use.
+ */
+class Sketch {
+public:
+    Sketch(const Index rows, const Index sketchRows, const unsigned long seed);
+
+    Index getRows() const {return rows_;}
+    Index getSketchRows() const {return sketchRows_;}
+
+    MatrixXd apply(const MatrixXd& A) const;
+
+    /**
+     * Rows of the sketch of a matrix with cols columns.
+     */
+    static Index sketchRows(const Index cols);
+
+    /**
+     * True when sketching a matrix of this size pays off.
+     */
+    static bool isWorthwhile(const Index rows, const Index cols);
+
+    /**
+     * Accuracy check: ||A R^-1 z|| must stay close to ||z|| for random z,
+     * where R is the triangular factor of the sketch of A.
+     */
+    static bool isEmbedding(const MatrixXd& A,
+                            const MatrixXd& R,
+                            const unsigned long seed);
+
+    /**
+     * Least squares solution of A x = b. The triangular factor of the
+     * sketch of A preconditions LSQR, started from the solution of the
+     * sketched problem. Falls back to a Householder QR of A when the
+     * problem is small, the factor is singular or LSQR does not converge.
+     * @param fallback  Set to whether the QR was used (optional).
+     */
+    static VectorXd solve(const MatrixXd& A,
+                          const VectorXd& b,
+                          const unsigned long seed,
+                          bool* fallback = nullptr);
+
+private:
+    Index rows_;
+    Index sketchRows_;
+    unsigned long seed_;
+
+    static constexpr Index zeta_ = 8;
+    static constexpr Index rowsPerColumn_ = 8;
+    static constexpr Real maxDistortion_ = 0.5;
+    static constexpr Real lsqrTolerance_ = 1e-13;
+    static constexpr size_t lsqrIterations_ = 100;
+};
+
+} /* namespace VectorFitting */
+
+#endif // VECTOR_FITTING_SKETCH_H_
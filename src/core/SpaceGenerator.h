@@ -31,9 +31,8 @@
 
 namespace VectorFitting {
 
-template<class T>
 std::vector<Real> logspace(const std::pair<Real, Real>& rangeExponents,
-                           const T nPoints);
+                           const std::size_t nPoints);
 
 template<class T>
 std::vector<T> linspace(const std::pair<T,T>& range,
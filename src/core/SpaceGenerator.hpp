@@ -28,9 +28,8 @@
 
 namespace VectorFitting {
 
-template<class T>
-std::vector<Real> logspace(const std::pair<Real,Real>& rangeExponents,
-                           const T nPoints) {
+inline std::vector<Real> logspace(const std::pair<Real,Real>& rangeExponents,
+                                  const std::size_t nPoints) {
     std::vector<Real> res;
     const Real base = (Real) 10;
     res.reserve(nPoints);
@@ -0,0 +1,181 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Alejandro García Montoro        (alejandro.garciamontoro@gmail.com)
+//					  Alejandra López de Aberasturi Gómez (aloaberasturi@ugr.es)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+#include "Sweep.h"
+
+#include <algorithm>
+#include <exception>
+#include <limits>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace VectorFitting {
+
+Sweep::Sweep(const std::vector<std::vector<Driver::Sample>>& datasets,
+             const Options& options,
+             const std::size_t nChains) :
+                nChains_(nChains),
+                models_(datasets.size()) {
+    if (nChains_ == 0) {
+#ifdef _OPENMP
+        nChains_ = omp_get_max_threads();
+#else
+        nChains_ = 1;
+#endif
+        nChains_ = std::min(nChains_, datasets.size() / minChainLength);
+    }
+    nChains_ = std::max((std::size_t) 1, std::min(nChains_, datasets.size()));
+
+    // Warm started fits relocate at least once, so that their poles are
+    // fitted to their own data.
+    Options warm = options;
+    warm.setIterations({0, std::max((std::size_t) 1,
+                                    options.getIterations().second)});
+    if (warm.getPoleTolerance() == 0.0) {
+        warm.setPoleTolerance(defaultTolerance);
+    }
+
+    // Chain heads are fitted in order before the chains, each one starting
+    // from the poles of the previous head. Every dataset but the first one
+    // is thus warm started and each chain runs from its final head.
+    for (std::size_t c = 0; c < nChains_; ++c) {
+        const std::size_t begin = c * datasets.size() / nChains_;
+        if (c == 0) {
+            models_[begin].reset(new Driver(datasets[begin], options));
+        } else {
+            const std::size_t previous = (c-1) * datasets.size() / nChains_;
+            models_[begin].reset(new Driver(datasets[begin], warm,
+                    models_[previous]->ss2pr().first));
+        }
+    }
+
+    std::vector<std::exception_ptr> errors(nChains_);
+#pragma omp parallel for schedule(dynamic) num_threads(nChains_)
+    for (long c = 0; c < (long) nChains_; ++c) {
+        const std::size_t begin = c * datasets.size() / nChains_;
+        const std::size_t end = (c+1) * datasets.size() / nChains_;
+        try {
+            for (std::size_t i = begin+1; i < end; ++i) {
+                models_[i].reset(new Driver(datasets[i], warm,
+                        models_[i-1]->ss2pr().first));
+            }
+        } catch (...) {
+            errors[c] = std::current_exception();
+        }
+    }
+    for (std::size_t c = 0; c < errors.size(); ++c) {
+        if (errors[c]) {
+            std::rethrow_exception(errors[c]);
+        }
+    }
+
+    for (std::size_t i = 0; i < models_.size(); ++i) {
+        std::vector<Complex> poles = models_[i]->ss2pr().first;
+        if (i > 0) {
+            poles = match(poles_.back(), poles);
+        }
+        poles_.push_back(poles);
+    }
+}
+
+/**
+ * Reorders poles so that each one takes the position of the closest pole in
+ * reference. Real poles and conjugate pairs are matched with their own kind,
+ * a pair through its member with positive imaginary part, and assigned
+ * greedily from the closest one. Both members of a pair move together and
+ * take the order of the pair they replace, so the result keeps the
+ * conjugate pairs of reference adjacent. Poles are returned unchanged when
+ * their structure differs from the one of reference.
+ */
+std::vector<Complex> Sweep::match(const std::vector<Complex>& reference,
+                                  const std::vector<Complex>& poles) {
+    if (reference.size() != poles.size()) {
+        return poles;
+    }
+    const RowVectorXi refIndex = Fitting::getCIndex(reference);
+    const RowVectorXi poleIndex = Fitting::getCIndex(poles);
+    std::vector<std::size_t> refs, cands;
+    for (std::size_t i = 0; i < reference.size(); ++i) {
+        if (refIndex(i) != 2) {
+            refs.push_back(i);
+        }
+        if (poleIndex(i) != 2) {
+            cands.push_back(i);
+        }
+    }
+    if (refs.size() != cands.size()) {
+        return poles;
+    }
+    // Representative of the real pole or pair starting at i.
+    auto upper = [](const std::vector<Complex>& p, const std::size_t i,
+                    const int cindex) {
+        return (cindex == 1) ? Complex(p[i].real(), std::abs(p[i].imag())) :
+                               p[i];
+    };
+
+    const std::size_t M = refs.size();
+    std::vector<bool> usedRef(M, false), usedPole(M, false);
+    std::vector<Complex> res(poles.size());
+    for (std::size_t n = 0; n < M; ++n) {
+        bool found = false;
+        std::size_t bestRef = 0, bestPole = 0;
+        Real bestDist = std::numeric_limits<Real>::infinity();
+        for (std::size_t i = 0; i < M; ++i) {
+            if (usedRef[i]) {
+                continue;
+            }
+            const int kind = refIndex(refs[i]);
+            const Complex r = upper(reference, refs[i], kind);
+            for (std::size_t j = 0; j < M; ++j) {
+                if (usedPole[j] || poleIndex(cands[j]) != kind) {
+                    continue;
+                }
+                const Real dist = std::abs(r - upper(poles, cands[j], kind));
+                if (!found || dist < bestDist) {
+                    found = true;
+                    bestDist = dist;
+                    bestRef = i;
+                    bestPole = j;
+                }
+            }
+        }
+        if (!found) {
+            return poles;
+        }
+        usedRef[bestRef] = true;
+        usedPole[bestPole] = true;
+        const std::size_t r = refs[bestRef], p = cands[bestPole];
+        if (refIndex(r) == 1) {
+            const bool same = (reference[r].imag() < 0.0) ==
+                              (poles[p].imag() < 0.0);
+            res[r]   = same ? poles[p]   : poles[p+1];
+            res[r+1] = same ? poles[p+1] : poles[p];
+        } else {
+            res[r] = poles[p];
+        }
+    }
+    return res;
+}
+
+} /* namespace VectorFitting */
@@ -0,0 +1,83 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Alejandro García Montoro        (alejandro.garciamontoro@gmail.com)
+//					  Alejandra López de Aberasturi Gómez (aloaberasturi@ugr.es)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef VECTOR_FITTING_SWEEP_H_
+#define VECTOR_FITTING_SWEEP_H_
+
+#include <memory>
+
+#include "Driver.h"
+
+namespace VectorFitting {
+
+/**
+ * Fits an ordered sequence of related datasets, e.g. a geometry sweep.
+ *
+ * The sequence is split in contiguous chains. The first dataset of each
+ * chain, its head, is fitted first and in order: the first head with the
+ * given options, the rest starting from the poles of the previous head.
+ * Then chains run in parallel, each dataset starting from the poles of its
+ * predecessor. Warm started fits skip the relocation of the summed response
+ * and stop relocating once the poles converge, so only the first dataset of
+ * the sweep is cold started. Pole trajectories are matched along the whole
+ * sweep so that pole k of each dataset follows pole k of the previous one.
+ */
+class Sweep {
+public:
+    /**
+     * @param datasets  Samples of each point of the sweep, in order.
+     * @param options   Options for the fit of the first dataset. When no
+     *                  pole tolerance is set, warm started fits use
+     *                  defaultTolerance.
+     * @param nChains   Independent chains, zero to use one per thread
+     *                  while chains have at least minChainLength datasets.
+     */
+    Sweep(const std::vector<std::vector<Driver::Sample>>& datasets,
+          const Options& options,
+          const std::size_t nChains = 0);
+
+    static constexpr double defaultTolerance = 1e-4;
+    static constexpr std::size_t minChainLength = 4;
+
+    std::size_t size() const {return models_.size();}
+    std::size_t getNumberOfChains() const {return nChains_;}
+
+    const Driver& getModel(const std::size_t i) const {return *models_[i];}
+
+    /**
+     * Poles of each dataset, ordered so that they vary smoothly along the
+     * sweep.
+     */
+    const std::vector<std::vector<Complex>>& getPoles() const {return poles_;}
+
+    static std::vector<Complex> match(const std::vector<Complex>& reference,
+                                      const std::vector<Complex>& poles);
+
+private:
+    std::size_t nChains_;
+    std::vector<std::unique_ptr<Driver>> models_;
+    std::vector<std::vector<Complex>> poles_;
+};
+
+} /* namespace VectorFitting */
+
+#endif // VECTOR_FITTING_SWEEP_H_
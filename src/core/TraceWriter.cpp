@@ -0,0 +1,102 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Alejandro García Montoro        (alejandro.garciamontoro@gmail.com)
+//					  Alejandra López de Aberasturi Gómez (aloaberasturi@ugr.es)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+#include "TraceWriter.h"
+
+#include <cmath>
+#include <sstream>
+#include <stdexcept>
+
+namespace VectorFitting {
+
+namespace {
+
+const char* toString(const Control::Stage stage) {
+    switch (stage) {
+    case Control::Stage::relocationOfSum:
+        return "relocationOfSum";
+    case Control::Stage::relocation:
+        return "relocation";
+    case Control::Stage::identification:
+        return "identification";
+    case Control::Stage::finished:
+    default:
+        return "finished";
+    }
+}
+
+void writeReal(std::ostream& out, const Real value) {
+    if (std::isfinite(value)) {
+        out << value;
+    } else {
+        out << "null";
+    }
+}
+
+}
+
+TraceWriter::TraceWriter(std::ostream& out, const bool rmse) :
+        out_(out),
+        rmse_(rmse) {}
+
+TraceWriter::TraceWriter(const std::string& filename, const bool rmse) :
+        file_(filename.c_str(), std::ios::app),
+        out_(file_),
+        rmse_(rmse) {
+    if (!file_) {
+        throw std::runtime_error("Could not open trace file " + filename);
+    }
+}
+
+void TraceWriter::observe(const Trace& trace) {
+    const std::string line = toJSON(trace);
+    std::lock_guard<std::mutex> lock(mutex_);
+    out_ << line << '\n';
+    out_.flush();
+}
+
+std::string TraceWriter::toJSON(const Trace& trace) {
+    std::ostringstream out;
+    out.precision(10);
+    out << "{\"stage\":\"" << toString(trace.stage) << "\""
+        << ",\"iteration\":" << trace.iteration
+        << ",\"samples\":" << trace.samples
+        << ",\"responses\":" << trace.responses
+        << ",\"order\":" << trace.order
+        << ",\"sigmaConstant\":";
+    writeReal(out, trace.sigmaConstant);
+    out << ",\"fixedConstant\":";
+    writeReal(out, trace.fixedConstant);
+    out << ",\"condition\":";
+    writeReal(out, trace.condition);
+    out << ",\"poleShift\":";
+    writeReal(out, trace.poleShift);
+    out << ",\"flippedPoles\":" << trace.flippedPoles
+        << ",\"rmse\":";
+    writeReal(out, trace.rmse);
+    out << ",\"seconds\":";
+    writeReal(out, trace.seconds);
+    out << "}";
+    return out.str();
+}
+
+} /* namespace VectorFitting */
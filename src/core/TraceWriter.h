@@ -0,0 +1,70 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Alejandro García Montoro        (alejandro.garciamontoro@gmail.com)
+//					  Alejandra López de Aberasturi Gómez (aloaberasturi@ugr.es)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef VECTOR_FITTING_TRACE_WRITER_H_
+#define VECTOR_FITTING_TRACE_WRITER_H_
+
+#include <fstream>
+#include <mutex>
+#include <ostream>
+#include <string>
+
+#include "Observer.h"
+
+namespace VectorFitting {
+
+/**
+ * Writes each trace as a line of JSON, e.g.
+ *   {"stage":"relocation","iteration":2,"samples":100,"responses":3,
+ *    "order":8,"sigmaConstant":0.98,"fixedConstant":0,"condition":1.2e3,
+ *    "poleShift":1.5e-3,"flippedPoles":0,"rmse":2.1e-6,"seconds":0.004}
+ * Values which are not available are written as null, as is the error of
+ * the relocations run by Driver unless rmse is set. Safe to use from
+ * concurrent fits.
+ */
+class TraceWriter : public Observer {
+public:
+    /**
+     * Writes to a stream, which must outlive the writer.
+     */
+    explicit TraceWriter(std::ostream& out, const bool rmse = false);
+
+    /**
+     * Appends to a file.
+     */
+    explicit TraceWriter(const std::string& filename, const bool rmse = false);
+
+    void observe(const Trace& trace);
+    bool isRMSERequired() const {return rmse_;}
+
+    static std::string toJSON(const Trace& trace);
+
+private:
+    std::ofstream file_;
+    std::ostream& out_;
+    std::mutex mutex_;
+    bool rmse_;
+};
+
+} /* namespace VectorFitting */
+
+#endif // VECTOR_FITTING_TRACE_WRITER_H_
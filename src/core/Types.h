@@ -28,6 +28,7 @@
 #pragma warning(disable:4267)
 #endif
 
+#include <complex>
 #include <cstdint>
 #include <cstddef>
 #include <cstdlib>
@@ -61,6 +62,8 @@ typedef long double Real;
 typedef double      Real;
 #endif
 
+typedef std::complex<Real> Complex;
+
 } /* namespace VectorFitting */
 
 #endif /* SEMBA_MATH_TYPES_H_ */
@@ -0,0 +1,261 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Alejandro García Montoro        (alejandro.garciamontoro@gmail.com)
+//					  Alejandra López de Aberasturi Gómez (aloaberasturi@ugr.es)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+#include "Weights.h"
+
+#include <limits>
+#include <stdexcept>
+
+namespace VectorFitting {
+
+Weights::Weights() :
+        mode_(Mode::uniform),
+        single_(false) {}
+
+Weights::Weights(const VectorXd& perSample) :
+        mode_(Mode::perSample),
+        single_(false),
+        values_(perSample) {}
+
+Weights::Weights(const MatrixXd& perElement) :
+        mode_(Mode::perElement),
+        single_(false),
+        values_(perElement) {}
+
+Weights::Weights(const std::vector<VectorXd>& weights, const std::size_t Nc) :
+        mode_(Mode::uniform),
+        single_(false) {
+    if (weights.empty()) {
+        return;
+    }
+    bool perSample = true;
+    for (std::size_t i = 0; i < weights.size(); ++i) {
+        if (weights[i].size() != 1 && (std::size_t) weights[i].size() != Nc) {
+            throw std::runtime_error("Invalid weight size");
+        }
+        perSample &= (weights[i].size() == 1);
+    }
+    if (perSample) {
+        mode_ = Mode::perSample;
+        values_.resize(weights.size(), 1);
+        for (std::size_t i = 0; i < weights.size(); ++i) {
+            values_(i,0) = weights[i](0);
+        }
+    } else {
+        mode_ = Mode::perElement;
+        values_.resize(weights.size(), Nc);
+        for (std::size_t i = 0; i < weights.size(); ++i) {
+            if (weights[i].size() == 1) {
+                values_.row(i).setConstant(weights[i](0));
+            } else {
+                values_.row(i) = weights[i].transpose();
+            }
+        }
+    }
+}
+
+Weights Weights::build(
+        const std::vector<std::pair<Complex, VectorXcd>>& samples,
+        const Options::Weighting weighting) {
+    if (weighting == Options::Weighting::one || samples.empty()) {
+        return Weights();
+    }
+    const std::size_t Ns = samples.size();
+    const std::size_t Nc = samples.front().second.size();
+    MatrixXd mag(Ns, Nc);
+    for (std::size_t i = 0; i < Ns; ++i) {
+        mag.row(i) = samples[i].second.cwiseAbs().transpose();
+    }
+    return build(mag, weighting);
+}
+
+Weights Weights::build(const MatrixXd& mag,
+                       const Options::Weighting weighting) {
+    if (weighting == Options::Weighting::one || mag.size() == 0) {
+        return Weights();
+    }
+    // Null data would give infinite weights.
+    const Real tiny = std::numeric_limits<Real>::min();
+    switch (weighting) {
+    case Options::Weighting::oneOverAbs:
+        return Weights(MatrixXd(mag.array().max(tiny).inverse()));
+    case Options::Weighting::oneOverSqrtAbs:
+        return Weights(MatrixXd(mag.array().max(tiny).sqrt().inverse()));
+    case Options::Weighting::oneOverNorm:
+        return Weights(VectorXd(
+                mag.rowwise().norm().array().max(tiny).inverse()));
+    case Options::Weighting::oneOverSqrtNorm:
+        return Weights(VectorXd(
+                mag.rowwise().norm().array().max(tiny).sqrt().inverse()));
+    default:
+        throw std::runtime_error("Weighting parameter not implemented");
+    }
+}
+
+Weights::Weights(const Real* data,
+                 const std::size_t Ns,
+                 const std::size_t Nc,
+                 const std::ptrdiff_t sampleStride,
+                 const std::ptrdiff_t responseStride) :
+        mode_(Mode::perElement),
+        single_(false),
+        view_(data),
+        viewSamples_(Ns),
+        viewResponses_(Nc),
+        sampleStride_(sampleStride),
+        responseStride_(responseStride) {
+    if (data == nullptr) {
+        throw std::runtime_error("Weights view has no data");
+    }
+}
+
+Weights Weights::build(const Complex* responses,
+                       const std::size_t Ns,
+                       const std::size_t Nc,
+                       const std::ptrdiff_t sampleStride,
+                       const std::ptrdiff_t responseStride,
+                       const Options::Weighting weighting) {
+    if (weighting == Options::Weighting::one || Ns == 0) {
+        return Weights();
+    }
+    const Real tiny = std::numeric_limits<Real>::min();
+    switch (weighting) {
+    case Options::Weighting::oneOverAbs:
+    case Options::Weighting::oneOverSqrtAbs: {
+        Weights res;
+        res.mode_ = Mode::perElement;
+        res.responses_ = responses;
+        res.sqrt_ = (weighting == Options::Weighting::oneOverSqrtAbs);
+        res.viewSamples_ = Ns;
+        res.viewResponses_ = Nc;
+        res.sampleStride_ = sampleStride;
+        res.responseStride_ = responseStride;
+        return res;
+    }
+    case Options::Weighting::oneOverNorm:
+    case Options::Weighting::oneOverSqrtNorm: {
+        VectorXd norm(Ns);
+        for (std::size_t i = 0; i < Ns; ++i) {
+            Real sum = 0.0;
+            for (std::size_t n = 0; n < Nc; ++n) {
+                sum += std::norm(responses[(std::ptrdiff_t) i*sampleStride +
+                                           (std::ptrdiff_t) n*responseStride]);
+            }
+            norm(i) = std::max(std::sqrt(sum), tiny);
+        }
+        if (weighting == Options::Weighting::oneOverSqrtNorm) {
+            norm = norm.array().sqrt();
+        }
+        return Weights(VectorXd(norm.array().inverse()));
+    }
+    default:
+        throw std::runtime_error("Weighting parameter not implemented");
+    }
+}
+
+std::ptrdiff_t Weights::offset_(const std::size_t i,
+                                const std::size_t n) const {
+    return (std::ptrdiff_t) i*sampleStride_ +
+           (std::ptrdiff_t) n*responseStride_;
+}
+
+Real Weights::viewAt_(const std::size_t i, const std::size_t n) const {
+    if (view_ != nullptr) {
+        return view_[offset_(i, n)];
+    }
+    const Real mag = std::max(
+            std::abs(responses_[offset_(i, n)]),
+            std::numeric_limits<Real>::min());
+    return 1.0 / (sqrt_ ? std::sqrt(mag) : mag);
+}
+
+VectorXd Weights::viewColumn_(const std::size_t n) const {
+    VectorXd res(viewSamples_);
+    if (view_ != nullptr) {
+        for (std::size_t i = 0; i < viewSamples_; ++i) {
+            res(i) = view_[offset_(i, n)];
+        }
+        return res;
+    }
+    for (std::size_t i = 0; i < viewSamples_; ++i) {
+        res(i) = std::abs(responses_[offset_(i, n)]);
+    }
+    res = res.array().max(std::numeric_limits<Real>::min());
+    if (sqrt_) {
+        res = res.array().sqrt();
+    }
+    return res.array().inverse();
+}
+
+Real Weights::operator()(const std::size_t i, const std::size_t n) const {
+    if (isView_()) {
+        return viewAt_(i, n);
+    }
+    switch (mode_) {
+    case Mode::uniform:
+        return 1.0;
+    case Mode::perSample:
+        return single_ ? (Real) singleValues_(i,0) : values_(i,0);
+    default:
+        return single_ ? (Real) singleValues_(i,n) : values_(i,n);
+    }
+}
+
+Weights Weights::subset(const std::vector<std::size_t>& indices) const {
+    if (mode_ == Mode::uniform) {
+        return *this;
+    }
+    if (isView_()) {
+        MatrixXd values(indices.size(), viewResponses_);
+        for (std::size_t i = 0; i < indices.size(); ++i) {
+            for (std::size_t n = 0; n < viewResponses_; ++n) {
+                values(i,n) = viewAt_(indices[i], n);
+            }
+        }
+        return Weights(values);
+    }
+    Weights res(*this);
+    if (single_) {
+        res.singleValues_.resize(indices.size(), singleValues_.cols());
+        for (std::size_t i = 0; i < indices.size(); ++i) {
+            res.singleValues_.row(i) = singleValues_.row(indices[i]);
+        }
+    } else {
+        res.values_.resize(indices.size(), values_.cols());
+        for (std::size_t i = 0; i < indices.size(); ++i) {
+            res.values_.row(i) = values_.row(indices[i]);
+        }
+    }
+    return res;
+}
+
+Weights Weights::toSinglePrecision() const {
+    Weights res(*this);
+    if (!single_ && !isView_()) {
+        res.single_ = true;
+        res.singleValues_ = values_.cast<float>();
+        res.values_.resize(0, 0);
+    }
+    return res;
+}
+
+} /* namespace VectorFitting */
@@ -0,0 +1,218 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Alejandro García Montoro        (alejandro.garciamontoro@gmail.com)
+//					  Alejandra López de Aberasturi Gómez (aloaberasturi@ugr.es)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef VECTOR_FITTING_WEIGHTS_H_
+#define VECTOR_FITTING_WEIGHTS_H_
+
+#include <complex>
+#include <cstddef>
+#include <vector>
+#include <eigen3/Eigen/Dense>
+
+#include "Real.h"
+#include "Options.h"
+
+namespace VectorFitting {
+
+using namespace Eigen;
+
+/**
+ * Weights of the least squares problems, with explicit broadcasting.
+ *  - uniform: all entries have weight one, nothing is stored or applied.
+ *  - perSample: one weight per sample, shared by all responses.
+ *  - perElement: one weight per sample and response.
+ * Values are stored as a Ns x Nc column major matrix (Ns x 1 for per sample
+ * weights), so that the weights of a response are contiguous. They can be
+ * stored in single precision, and are converted to Real when applied.
+ * Per element weights can also be read in place from memory owned by the
+ * caller, or computed from responses read in place when applied, so that
+ * no Ns x Nc matrix is stored.
+ */
+class Weights {
+public:
+    enum class Mode {
+        uniform,
+        perSample,
+        perElement
+    };
+
+    Weights();
+    explicit Weights(const VectorXd& perSample);
+    explicit Weights(const MatrixXd& perElement);
+
+    /**
+     * Weights given per sample as vectors of size one (per sample) or Nc
+     * (per element). An empty vector means uniform weights.
+     */
+    Weights(const std::vector<VectorXd>& weights, const std::size_t Nc);
+
+    /**
+     * Weights of the given weighting mode for samples with responses of
+     * a sample in each element.
+     */
+    static Weights build(
+            const std::vector<std::pair<Complex, VectorXcd>>& samples,
+            const Options::Weighting weighting);
+    /**
+     * Same as above from the magnitudes of the responses, Ns x Nc.
+     */
+    static Weights build(const MatrixXd& magnitudes,
+                         const Options::Weighting weighting);
+
+    /**
+     * Per element weights read in place: the weight of response n at
+     * sample i is data[i*sampleStride + n*responseStride], strides may be
+     * negative. Data must outlive the weights.
+     */
+    Weights(const Real* data,
+            const std::size_t Ns,
+            const std::size_t Nc,
+            const std::ptrdiff_t sampleStride,
+            const std::ptrdiff_t responseStride);
+    /**
+     * Weights of the given weighting mode for responses read in place as
+     * above. Per element weights are computed from the responses when
+     * applied, per sample ones are stored.
+     */
+    static Weights build(const Complex* responses,
+                         const std::size_t Ns,
+                         const std::size_t Nc,
+                         const std::ptrdiff_t sampleStride,
+                         const std::ptrdiff_t responseStride,
+                         const Options::Weighting weighting);
+
+    Mode getMode() const {return mode_;}
+    bool isUniform() const {return mode_ == Mode::uniform;}
+
+    /**
+     * Number of samples, zero for uniform weights.
+     */
+    std::size_t getSamplesSize() const {
+        if (isView_()) {
+            return viewSamples_;
+        }
+        return single_ ? singleValues_.rows() : values_.rows();
+    }
+
+    /**
+     * Number of responses, zero unless weights are per element.
+     */
+    std::size_t getResponseSize() const {
+        if (mode_ != Mode::perElement) {
+            return 0;
+        }
+        if (isView_()) {
+            return viewResponses_;
+        }
+        return single_ ? singleValues_.cols() : values_.cols();
+    }
+
+    Real operator()(const std::size_t i, const std::size_t n) const;
+
+    /**
+     * Weights of response n for all samples. Not valid for uniform weights.
+     * Weights computed from responses read in place are computed on each
+     * call, callers applying them several times should keep the column.
+     */
+    VectorXd column(const std::size_t n) const {
+        if (isView_()) {
+            return viewColumn_(n);
+        }
+        const Index j = (mode_ == Mode::perElement) ? n : 0;
+        if (single_) {
+            return singleValues_.col(j).cast<Real>();
+        }
+        return values_.col(j);
+    }
+
+    /**
+     * Multiplies rows [first, first + Ns) of A by the weights of response n.
+     */
+    template<class T>
+    void scaleRows(T& A, const Index first, const std::size_t n) const {
+        if (mode_ == Mode::uniform) {
+            return;
+        }
+        if (isView_()) {
+            scaleRows(A, first, column(n));
+            return;
+        }
+        const Index j = (mode_ == Mode::perElement) ? n : 0;
+        if (single_) {
+            A.middleRows(first, singleValues_.rows()).array().colwise() *=
+                    singleValues_.col(j).array()
+                    .template cast<Real>()
+                    .template cast<typename T::Scalar>();
+        } else {
+            A.middleRows(first, values_.rows()).array().colwise() *=
+                    values_.col(j).array()
+                    .template cast<typename T::Scalar>();
+        }
+    }
+
+    /**
+     * Multiplies rows [first, first + w.size()) of A by w, a column of the
+     * weights gathered once to be applied several times. Does nothing if w
+     * is empty, as the column of uniform weights.
+     */
+    template<class T>
+    static void scaleRows(T& A, const Index first, const VectorXd& w) {
+        if (w.size() != 0) {
+            A.middleRows(first, w.size()).array().colwise() *=
+                    w.array().template cast<typename T::Scalar>();
+        }
+    }
+
+    Weights subset(const std::vector<std::size_t>& indices) const;
+
+    /**
+     * Same weights stored in single precision. Weights read in place are
+     * left as they are.
+     */
+    Weights toSinglePrecision() const;
+    bool isSinglePrecision() const {return single_;}
+
+private:
+    Mode mode_;
+    bool single_;
+    MatrixXd values_;
+    MatrixXf singleValues_;
+
+    // Weights read in place, from data or as the inverse magnitude (or its
+    // square root) of the responses.
+    const Real* view_ = nullptr;
+    const Complex* responses_ = nullptr;
+    bool sqrt_ = false;
+    std::size_t viewSamples_ = 0;
+    std::size_t viewResponses_ = 0;
+    std::ptrdiff_t sampleStride_ = 0;
+    std::ptrdiff_t responseStride_ = 0;
+
+    bool isView_() const {return view_ != nullptr || responses_ != nullptr;}
+    std::ptrdiff_t offset_(const std::size_t i, const std::size_t n) const;
+    Real viewAt_(const std::size_t i, const std::size_t n) const;
+    VectorXd viewColumn_(const std::size_t n) const;
+};
+
+} /* namespace VectorFitting */
+
+#endif // VECTOR_FITTING_WEIGHTS_H_